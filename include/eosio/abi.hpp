@@ -4,7 +4,12 @@
 #include "types.hpp"
 #include <functional>
 #include <map>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
 #include <string>
+#include <unordered_map>
+#include <unordered_set>
 #include <variant>
 #include <vector>
 #include "fixed_bytes.hpp"
@@ -173,6 +178,112 @@ struct abi_def {
 EOSIO_REFLECT(abi_def, version, types, structs, actions, tables, ricardian_clauses, error_messages, abi_extensions,
               variants, action_results);
 
+// The parts of an abi_def which convert uses, with the strings pointing into whatever the view was read from. Reading
+// one from binary skips the ricardian contracts and clauses, error messages and extensions without copying them.
+struct type_def_view {
+   std::string_view new_type_name{};
+   std::string_view type{};
+};
+
+EOSIO_REFLECT(type_def_view, new_type_name, type);
+
+struct field_def_view {
+   std::string_view name{};
+   std::string_view type{};
+};
+
+EOSIO_REFLECT(field_def_view, name, type);
+
+struct struct_def_view {
+   std::string_view            name{};
+   std::string_view            base{};
+   std::vector<field_def_view> fields{};
+};
+
+EOSIO_REFLECT(struct_def_view, name, base, fields);
+
+struct action_def_view {
+   eosio::name      name{};
+   std::string_view type{};
+};
+
+template <typename S>
+void from_bin(action_def_view& obj, S& stream) {
+   from_bin(obj.name, stream);
+   from_bin(obj.type, stream);
+   std::string_view ricardian_contract;
+   from_bin(ricardian_contract, stream);
+}
+
+struct table_def_view {
+   eosio::name                   name{};
+   std::string_view              index_type{};
+   std::vector<std::string_view> key_names{};
+   std::vector<std::string_view> key_types{};
+   std::string_view              type{};
+};
+
+EOSIO_REFLECT(table_def_view, name, index_type, key_names, key_types, type);
+
+struct variant_def_view {
+   std::string_view              name{};
+   std::vector<std::string_view> types{};
+};
+
+EOSIO_REFLECT(variant_def_view, name, types);
+
+struct action_result_def_view {
+   eosio::name      name{};
+   std::string_view result_type{};
+};
+
+EOSIO_REFLECT(action_result_def_view, name, result_type);
+
+struct abi_def_view {
+   std::string_view                    version{};
+   std::vector<type_def_view>          types{};
+   std::vector<struct_def_view>        structs{};
+   std::vector<action_def_view>        actions{};
+   std::vector<table_def_view>         tables{};
+   std::vector<variant_def_view>       variants{};
+   std::vector<action_result_def_view> action_results{};
+};
+
+// Reads an abi_def_view from a binary abi. The view refers to the stream's data.
+template <typename S>
+void from_bin(abi_def_view& obj, S& stream) {
+   from_bin(obj.version, stream);
+   from_bin(obj.types, stream);
+   from_bin(obj.structs, stream);
+   from_bin(obj.actions, stream);
+   from_bin(obj.tables, stream);
+   std::string_view skipped;
+   uint32_t         size;
+   varuint32_from_bin(size, stream); // ricardian_clauses
+   for (uint32_t i = 0; i < size; ++i) {
+      from_bin(skipped, stream);
+      from_bin(skipped, stream);
+   }
+   varuint32_from_bin(size, stream); // error_messages
+   for (uint32_t i = 0; i < size; ++i) {
+      uint64_t error_code;
+      from_bin(error_code, stream);
+      from_bin(skipped, stream);
+   }
+   varuint32_from_bin(size, stream); // abi_extensions
+   for (uint32_t i = 0; i < size; ++i) {
+      uint16_t type;
+      uint64_t data_size;
+      from_bin(type, stream);
+      varuint64_from_bin(data_size, stream);
+      stream.skip(data_size);
+   }
+   if (stream.remaining())
+      from_bin(obj.variants, stream);
+   if (stream.remaining())
+      from_bin(obj.action_results, stream);
+}
+
 struct abi_type;
 
 struct abi_field {
@@ -184,7 +295,7 @@ struct abi_type {
    std::string name;
 
    struct builtin {};
-   using alias_def = std::string;
+   using alias_def = std::string_view;
    struct alias {
       abi_type* type;
    };
@@ -202,8 +313,8 @@ struct abi_type {
       std::vector<abi_field> fields;
    };
    using variant = std::vector<abi_field>;
-   std::variant<builtin, const alias_def*, const struct_def*, const variant_def*, alias, optional, extension, array,
-                struct_, variant>
+   std::variant<builtin, const alias_def*, const struct_def_view*, const variant_def_view*, alias, optional, extension,
+                array, struct_, variant>
                          _data;
    const abi_serializer* ser = nullptr;
 
@@ -243,12 +354,66 @@ struct abi_type {
          std::string_view json, std::function<void()> f = [] {}) const;
 };
 
+// A contiguous form of the types reachable from some abi_types, for serializers which walk the types of every value
+// they convert. The types are in one array and refer to each other by 32-bit index, the fields of all the structs and
+// variants are in one array, and the names are interned in one pool in the form the json writer needs.
+//
+// index_of compiles under an exclusive lock of mutex, so it may be called from several threads at once, like
+// abi::get_type. Compiling appends to the tables, so anything reading them holds a shared lock of mutex meanwhile.
+struct compiled_abi {
+   enum kind_t : uint8_t { builtin, optional, extension, array, object, variant };
+
+   struct type {
+      const abi_type* source; // builtins convert with the serializer of their abi_type
+      uint32_t        first;  // the type of an optional, extension or array, or the first field of an object or variant
+      uint32_t        count;  // the number of fields of an object or variant
+      kind_t          kind;
+   };
+
+   struct field {
+      uint32_t name;      // offset in names of the json key ("name":), or for a variant alternative, "name",
+      uint32_t name_size;
+      uint32_t type;
+   };
+
+   std::vector<type>                  types;
+   std::vector<field>                 fields;
+   std::string                        names;
+   std::unique_ptr<std::shared_mutex> mutex = std::make_unique<std::shared_mutex>();
+
+   // The index of the compiled form of t. It and the types it refers to are compiled the first time.
+   uint32_t index_of(const abi_type* t);
+
+   std::string_view name(const field& f) const { return { names.data() + f.name, f.name_size }; }
+
+ private:
+   uint32_t intern(const std::string& name);
+
+   std::unordered_map<const abi_type*, uint32_t> indexes;
+   std::unordered_map<std::string, uint32_t>     interned;
+};
+
+// The definitions an abi converted by convert_lazy resolves its types from
+struct lazy_abi_def {
+   abi_def                             def; // view refers to either def
+   std::vector<char>                   bin; // or bin
+   abi_def_view                        view;
+   std::mutex                          mutex;
+   std::unordered_set<const abi_type*> resolved; // types which only refer to resolved types
+};
+
 struct abi {
-   std::map<eosio::name, std::string> action_types;
-   std::map<eosio::name, std::string> table_types;
-   std::map<std::string, abi_type>    abi_types;
-   std::map<eosio::name, std::string> action_result_types;
-   const abi_type*                    get_type(const std::string& name);
+   std::map<eosio::name, std::string>           action_types;
+   std::map<eosio::name, std::string>           table_types;
+   std::map<std::string, abi_type, std::less<>> abi_types;
+   std::map<eosio::name, std::string>           action_result_types;
+   compiled_abi                                 compiled;
+   std::unique_ptr<lazy_abi_def>                lazy;
+
+   // Finds a type, adding optional (?), array ([]) and extension ($) types as needed. If the abi was converted by
+   // convert_lazy, the type and the types it refers to are resolved the first time; this may be called from several
+   // threads at once.
+   const abi_type* get_type(const std::string& name);
 
    // Adds a type to the abi.  Has no effect if the type is already present.
    // If the type is a struct, all members will be added recursively.
@@ -258,9 +423,20 @@ struct abi {
    abi_type* add_type();
 };
 
+void convert(const abi_def_view& def, abi&);
 void convert(const abi_def& def, abi&);
 void convert(const abi& def, abi_def&);
 
+// Makes a view of def, which refers to def's strings
+void convert(const abi_def& def, abi_def_view& view);
+
+// Like convert, but only registers the definitions; get_type resolves them the first time they are used, and adds
+// builtin types the same way. Errors in types which are never used aren't reported.
+void convert_lazy(abi_def&& def, abi&);
+
+// The same for a view read from bin, which the abi keeps
+void convert_lazy(std::vector<char>&& bin, abi_def_view&& def, abi&);
+
 extern const abi_serializer* const object_abi_serializer;
 extern const abi_serializer* const variant_abi_serializer;
 extern const abi_serializer* const array_abi_serializer;
@@ -8,6 +8,7 @@
 #include "from_json.hpp"
 #include "to_bin.hpp"
 #include "to_json.hpp"
+#include "validate_bin.hpp"
 
 namespace eosio {
 
@@ -204,6 +205,13 @@ void from_bin(bitset& obj, S& stream) {
    }
 }
 
+inline stream_error validate_bin(bitset*, input_stream& stream) {
+   uint32_t num_bits = 0;
+   if (auto e = try_varuint32_from_bin(num_bits, stream); e != stream_error::no_error)
+      return e;
+   return try_skip(stream, bitset::calc_num_blocks(num_bits));
+}
+
 template <typename S>
 void to_bin(const bitset& obj, S& stream) {
    varuint32_to_bin(obj.size(), stream);
@@ -246,4 +254,6 @@ void to_key(const bitset& obj, S& stream) {
    to_key_optional((const uint8_t*)nullptr, stream);
 }
 
+constexpr size_t fixed_key_size(bitset*) { return 0; }
+
 }
\ No newline at end of file
@@ -0,0 +1,145 @@
+#pragma once
+
+#include "mapped_file.hpp"
+#include "parallel.hpp"
+#include "ship_ids.hpp"
+
+namespace eosio { namespace ship_protocol {
+
+   // A serialized signed_block in a mapped blocks.log. The header fields at fixed offsets are read on their own
+   // without touching the rest of the block.
+   struct block_view {
+      uint32_t     block_num = 0;
+      input_stream bin       = {}; // the signed_block
+
+      eosio::block_timestamp timestamp() const { return eosio::block_timestamp{ read<uint32_t>(0) }; }
+      eosio::name            producer() const { return eosio::name{ read<uint64_t>(4) }; }
+      uint16_t               confirmed() const { return read<uint16_t>(12); }
+      eosio::checksum256     previous() const { return read_checksum(14); }
+      eosio::checksum256     transaction_mroot() const { return read_checksum(46); }
+      eosio::checksum256     action_mroot() const { return read_checksum(78); }
+
+      eosio::checksum256 id() const { return compute_signed_block_id(bin); }
+
+      // Decodes the header, stopping before the producer signature
+      block_header header() const {
+         block_header result;
+         auto         s = bin;
+         from_bin(result, s);
+         return result;
+      }
+
+      signed_block decode() const {
+         signed_block result;
+         auto         s = bin;
+         from_bin(result, s);
+         return result;
+      }
+
+    private:
+      template <typename T>
+      T read(size_t offset) const {
+         check(offset + sizeof(T) <= bin.remaining(), convert_stream_error(stream_error::overrun));
+         T result;
+         memcpy(&result, bin.pos + offset, sizeof(T));
+         return result;
+      }
+
+      eosio::checksum256 read_checksum(size_t offset) const {
+         check(offset + 32 <= bin.remaining(), convert_stream_error(stream_error::overrun));
+         input_stream       s{ bin.pos + offset, 32 };
+         eosio::checksum256 result;
+         from_bin(result, s);
+         return result;
+      }
+   };
+
+   // Reads a nodeos blocks.log and its blocks.index through memory mappings, returning each block as a block_view
+   // into the log without copying.
+   //
+   // The log starts with a uint32 version and, from version 2 on, the number of its first block. Each block is followed
+   // by its own file position. From version 4 on, a block entry starts with its size (the distance to the next entry,
+   // so including the size itself, a compression byte and the trailing position) and that compression byte; only
+   // uncompressed entries are supported. The index holds the position of every block's entry, starting with the first block.
+   //
+   // The log must not be written to while it is mapped.
+   class block_log {
+    public:
+      explicit block_log(const std::string& path, const std::string& index_path)
+          : log{ path }, index{ index_path } {
+         check(index.length() % 8 == 0, "blocks.index has a partial entry");
+         auto bin = log.slice(0, 4);
+         bin.read_raw(version_);
+         check(version_ >= 1 && version_ <= 4, "unsupported blocks.log version " + std::to_string(version_));
+         if (version_ >= 2) {
+            bin = log.slice(4, 4);
+            bin.read_raw(first_block);
+         }
+         end_block_ = first_block + index.length() / 8;
+      }
+
+      // dir is the directory holding blocks.log and blocks.index
+      explicit block_log(const std::string& dir) : block_log{ dir + "/blocks.log", dir + "/blocks.index" } {}
+
+      uint32_t version() const { return version_; }
+      uint32_t begin_block() const { return first_block; }
+      uint32_t end_block() const { return end_block_; }
+      bool     contains(uint32_t block_num) const { return block_num >= first_block && block_num < end_block_; }
+
+      block_view get(uint32_t block_num) const {
+         check(contains(block_num), "block " + std::to_string(block_num) + " is not in blocks.log");
+         uint64_t i   = block_num - first_block;
+         uint64_t pos = position(i);
+         if (version_ >= 4) {
+            auto     bin = log.slice(pos, 5);
+            uint32_t size;
+            uint8_t  compression;
+            bin.read_raw(size);
+            bin.read_raw(compression);
+            check(compression == 0, "compressed blocks.log entries are not supported");
+            check(size >= 5 + 8, "blocks.log entry is too small");
+            check_suffix(pos, pos + size - 8);
+            return { block_num, log.slice(pos + 5, size - 5 - 8) };
+         }
+         // before version 4 the block's end is found from where the next entry starts
+         uint64_t next = i + 1 < index.length() / 8 ? position(i + 1) : log.length();
+         check(next >= pos + 8, "blocks.index is out of order");
+         check_suffix(pos, next - 8);
+         return { block_num, log.slice(pos, next - 8 - pos) };
+      }
+
+      // Calls f(const block_view&) for each block in [first, last) in order
+      template <typename F>
+      void for_each(uint32_t first, uint32_t last, F f) const {
+         for (uint32_t b = first; b < last; ++b) f(static_cast<const block_view&>(get(b)));
+      }
+
+      // Splits [first, last) into num_threads consecutive ranges and calls f(const block_view&) for the blocks of
+      // each range on its own thread. f must be safe to call concurrently.
+      template <typename F>
+      void parallel_for_each(uint32_t first, uint32_t last, uint32_t num_threads, F f) const {
+         parallel_for_ranges(first, last, num_threads, [&](uint32_t begin, uint32_t end) { for_each(begin, end, f); });
+      }
+
+    private:
+      mapped_file log;
+      mapped_file index;
+      uint32_t    version_    = 0;
+      uint32_t    first_block = 1;
+      uint32_t    end_block_  = 1;
+
+      uint64_t position(uint64_t i) const {
+         uint64_t pos;
+         memcpy(&pos, index.data() + i * 8, 8);
+         return pos;
+      }
+
+      void check_suffix(uint64_t pos, uint64_t suffix_pos) const {
+         auto     bin = log.slice(suffix_pos, 8);
+         uint64_t suffix;
+         bin.read_raw(suffix);
+         check(suffix == pos, "blocks.log entry position does not match its index");
+      }
+   };
+
+}} // namespace eosio::ship_protocol
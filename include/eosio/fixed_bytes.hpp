@@ -231,6 +231,11 @@ void to_key(const fixed_bytes<Size, T>& obj, S& stream) {
    to_bin(obj.extract_as_byte_array(), stream);
 }
 
+template <typename T, std::size_t Size>
+constexpr size_t fixed_key_size(fixed_bytes<Size, T>*) {
+   return Size;
+}
+
 template <typename T, std::size_t Size, typename S>
 void from_json(fixed_bytes<Size, T>& obj, S& stream) {
    std::vector<char> v;
@@ -191,6 +191,13 @@ class json_token_stream : public rapidjson::BaseReaderHandler<rapidjson::UTF8<>,
    // This modifies json
    json_token_stream(char* json) : ss{ json } { reader.IterativeParseInit(); }
 
+   // Starts over on new json, keeping the memory the reader has allocated
+   void reset(char* json) {
+      ss = rapidjson::InsituStringStream{ json };
+      reader.IterativeParseInit();
+      current_token = {};
+   }
+
    bool complete() { return reader.IterativeParseComplete(); }
 
    std::reference_wrapper<const json_token> peek_token() {
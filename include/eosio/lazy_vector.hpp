@@ -0,0 +1,254 @@
+#pragma once
+
+#include "convert.hpp"
+#include "for_each_field.hpp"
+#include "from_bin.hpp"
+#include "to_bin.hpp"
+#include "to_json.hpp"
+#include "types.hpp"
+#include "varint.hpp"
+
+#include <algorithm>
+#include <array>
+#include <optional>
+#include <string>
+#include <tuple>
+#include <variant>
+#include <vector>
+
+namespace eosio {
+
+   // skip_bin((T*)nullptr, bin) steps over a serialized T without decoding it. Fixed-size values, lengths and
+   // reflected structs are stepped over in place; anything else is decoded into a temporary. Types that need a faster
+   // skip provide an overload found by argument-dependent lookup.
+   template <typename T>
+   void skip_bin(T*, input_stream& bin);
+   inline void skip_bin(varuint32*, input_stream& bin);
+   inline void skip_bin(varint32*, input_stream& bin);
+   inline void skip_bin(std::string*, input_stream& bin);
+   inline void skip_bin(input_stream*, input_stream& bin);
+   template <typename T>
+   void skip_bin(std::vector<T>*, input_stream& bin);
+   template <typename T>
+   void skip_bin(std::optional<T>*, input_stream& bin);
+   template <typename... Ts>
+   void skip_bin(std::variant<Ts...>*, input_stream& bin);
+   template <typename T, std::size_t N>
+   void skip_bin(std::array<T, N>*, input_stream& bin);
+   template <typename First, typename Second>
+   void skip_bin(std::pair<First, Second>*, input_stream& bin);
+   template <typename... Ts>
+   void skip_bin(std::tuple<Ts...>*, input_stream& bin);
+   template <typename T>
+   class lazy_vector;
+   template <typename T>
+   void skip_bin(lazy_vector<T>*, input_stream& bin);
+
+   template <typename T>
+   void skip_bin(T*, input_stream& bin) {
+      if constexpr (has_bitwise_serialization<T>()) {
+         bin.skip(sizeof(T));
+      } else if constexpr (reflection::has_for_each_field_v<T> && std::is_same_v<serialization_type<T>, void>) {
+         for_each_field<T>([&](const char*, auto member) {
+            skip_bin((std::decay_t<decltype(member((T*)nullptr))>*)nullptr, bin);
+         });
+      } else {
+         T temp;
+         from_bin(temp, bin);
+      }
+   }
+
+   inline void skip_bin(varuint32*, input_stream& bin) {
+      uint32_t v;
+      varuint32_from_bin(v, bin);
+   }
+
+   inline void skip_bin(varint32*, input_stream& bin) {
+      int32_t v;
+      varint32_from_bin(v, bin);
+   }
+
+   inline void skip_bin(std::string*, input_stream& bin) {
+      uint32_t size;
+      varuint32_from_bin(size, bin);
+      bin.skip(size);
+   }
+
+   inline void skip_bin(input_stream*, input_stream& bin) { skip_bin((std::string*)nullptr, bin); }
+
+   template <typename T>
+   void skip_bin(std::vector<T>*, input_stream& bin) {
+      uint32_t size;
+      varuint32_from_bin(size, bin);
+      if constexpr (has_bitwise_serialization<T>()) {
+         bin.skip(uint64_t(size) * sizeof(T));
+      } else {
+         for (uint32_t i = 0; i < size; ++i) skip_bin((T*)nullptr, bin);
+      }
+   }
+
+   template <typename T>
+   void skip_bin(std::optional<T>*, input_stream& bin) {
+      bool present;
+      from_bin(present, bin);
+      if (present)
+         skip_bin((T*)nullptr, bin);
+   }
+
+   template <typename... Ts>
+   void skip_bin(std::variant<Ts...>*, input_stream& bin) {
+      using skipper                          = void (*)(input_stream&);
+      static constexpr skipper alternatives[] = { [](input_stream& bin) { skip_bin((Ts*)nullptr, bin); }... };
+      uint32_t                 index;
+      varuint32_from_bin(index, bin);
+      check(index < sizeof...(Ts), convert_stream_error(stream_error::bad_variant_index));
+      alternatives[index](bin);
+   }
+
+   template <typename T, std::size_t N>
+   void skip_bin(std::array<T, N>*, input_stream& bin) {
+      for (std::size_t i = 0; i < N; ++i) skip_bin((T*)nullptr, bin);
+   }
+
+   template <typename First, typename Second>
+   void skip_bin(std::pair<First, Second>*, input_stream& bin) {
+      skip_bin((First*)nullptr, bin);
+      skip_bin((Second*)nullptr, bin);
+   }
+
+   template <typename... Ts>
+   void skip_bin(std::tuple<Ts...>*, input_stream& bin) {
+      (skip_bin((Ts*)nullptr, bin), ...);
+   }
+
+   // A serialized std::vector<T> that decodes its elements on access. Deserializing it steps over the elements once
+   // with skip_bin to record where each one starts, so finding an element costs one allocation for the whole vector
+   // instead of one or more per element. Elements refer into the serialized data, which must outlive the vector.
+   template <typename T>
+   class lazy_vector {
+    public:
+      class const_iterator {
+       public:
+         using iterator_category = std::random_access_iterator_tag;
+         using value_type        = T;
+         using difference_type   = std::ptrdiff_t;
+         using pointer           = void;
+         using reference         = T;
+
+         const_iterator() = default;
+         const_iterator(const lazy_vector* v, size_t i) : v{ v }, i{ i } {}
+
+         T               operator*() const { return (*v)[i]; }
+         T               operator[](difference_type n) const { return (*v)[i + n]; }
+         const_iterator& operator++() { return ++i, *this; }
+         const_iterator  operator++(int) { return { v, i++ }; }
+         const_iterator& operator--() { return --i, *this; }
+         const_iterator  operator--(int) { return { v, i-- }; }
+         const_iterator& operator+=(difference_type n) { return i += n, *this; }
+         const_iterator& operator-=(difference_type n) { return i -= n, *this; }
+         const_iterator  operator+(difference_type n) const { return { v, i + n }; }
+         const_iterator  operator-(difference_type n) const { return { v, i - n }; }
+         difference_type operator-(const const_iterator& rhs) const { return difference_type(i - rhs.i); }
+         bool            operator==(const const_iterator& rhs) const { return i == rhs.i; }
+         bool            operator!=(const const_iterator& rhs) const { return i != rhs.i; }
+         bool            operator<(const const_iterator& rhs) const { return i < rhs.i; }
+
+       private:
+         const lazy_vector* v = nullptr;
+         size_t             i = 0;
+      };
+
+      size_t size() const { return offsets.empty() ? 0 : offsets.size() - 1; }
+      bool   empty() const { return size() == 0; }
+
+      // The serialized element i
+      input_stream element_bin(size_t i) const { return { bin.pos + offsets[i], bin.pos + offsets[i + 1] }; }
+
+      // Decodes element i into obj, reusing what obj has already allocated
+      void get(size_t i, T& obj) const {
+         auto s = element_bin(i);
+         from_bin(obj, s);
+      }
+
+      T operator[](size_t i) const {
+         T obj;
+         get(i, obj);
+         return obj;
+      }
+
+      T at(size_t i) const {
+         check(i < size(), "lazy_vector index out of range");
+         return (*this)[i];
+      }
+
+      const_iterator begin() const { return { this, 0 }; }
+      const_iterator end() const { return { this, size() }; }
+
+      std::vector<T> materialize() const { return { begin(), end() }; }
+
+      // The serialized elements without the leading size
+      input_stream get_bin() const { return bin; }
+
+      void from(input_stream& stream) {
+         uint32_t size;
+         varuint32_from_bin(size, stream);
+         offsets.clear();
+         offsets.reserve(std::min<size_t>(size, stream.remaining()) + 1);
+         offsets.push_back(0);
+         auto begin = stream.pos;
+         for (uint32_t i = 0; i < size; ++i) {
+            skip_bin((T*)nullptr, stream);
+            check(stream.pos - begin <= UINT32_MAX, "lazy_vector is too large");
+            offsets.push_back(uint32_t(stream.pos - begin));
+         }
+         bin = { begin, stream.pos };
+      }
+
+    private:
+      input_stream          bin;
+      std::vector<uint32_t> offsets;
+   };
+
+   template <typename T>
+   constexpr const char* get_type_name(lazy_vector<T>*) {
+      return vector_type_name<T>.data();
+   }
+
+   template <typename T>
+   void skip_bin(lazy_vector<T>*, input_stream& bin) {
+      skip_bin((std::vector<T>*)nullptr, bin);
+   }
+
+   template <typename T>
+   void from_bin(lazy_vector<T>& obj, input_stream& stream) {
+      obj.from(stream);
+   }
+
+   template <typename T, typename S>
+   void to_bin(const lazy_vector<T>& obj, S& stream) {
+      varuint32_to_bin(obj.size(), stream);
+      auto bin = obj.get_bin();
+      stream.write(bin.pos, bin.remaining());
+   }
+
+   template <typename T, typename S>
+   void to_json(const lazy_vector<T>& obj, S& stream) {
+      stream.write('[');
+      T element;
+      for (size_t i = 0; i < obj.size(); ++i) {
+         if (i)
+            stream.write(',');
+         else
+            increase_indent(stream);
+         write_newline(stream);
+         obj.get(i, element);
+         to_json(element, stream);
+      }
+      if (obj.size()) {
+         decrease_indent(stream);
+         write_newline(stream);
+      }
+      stream.write(']');
+   }
+
+} // namespace eosio
@@ -0,0 +1,67 @@
+#pragma once
+
+#include "check.hpp"
+#include "stream.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+
+namespace eosio {
+
+   // A read-only memory mapping of a whole file
+   class mapped_file {
+    public:
+      mapped_file() = default;
+
+      explicit mapped_file(const std::string& path) {
+         int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+         check(fd >= 0, "unable to open " + path + ": " + std::strerror(errno));
+         struct stat st;
+         if (::fstat(fd, &st) == 0 && st.st_size > 0) {
+            size = st.st_size;
+            void* p = ::mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+            int err = errno;
+            ::close(fd);
+            check(p != MAP_FAILED, "unable to map " + path + ": " + std::strerror(err));
+            addr = static_cast<const char*>(p);
+         } else {
+            ::close(fd);
+         }
+      }
+
+      mapped_file(mapped_file&& other) noexcept : addr{ other.addr }, size{ other.size } {
+         other.addr = nullptr;
+         other.size = 0;
+      }
+
+      mapped_file& operator=(mapped_file&& other) noexcept {
+         std::swap(addr, other.addr);
+         std::swap(size, other.size);
+         return *this;
+      }
+
+      ~mapped_file() {
+         if (addr)
+            ::munmap(const_cast<char*>(addr), size);
+      }
+
+      const char* data() const { return addr; }
+      size_t      length() const { return size; }
+
+      // The bytes [offset, offset + n), checked against the end of the file
+      input_stream slice(uint64_t offset, uint64_t n) const {
+         check(offset <= size && n <= size - offset, convert_stream_error(stream_error::overrun));
+         return { addr + offset, addr + offset + n };
+      }
+
+    private:
+      const char* addr = nullptr;
+      size_t      size = 0;
+   };
+
+} // namespace eosio
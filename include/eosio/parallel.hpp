@@ -0,0 +1,38 @@
+#pragma once
+
+#include <algorithm>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace eosio {
+
+   // Splits [first, last) into up to num_threads consecutive ranges and calls f(begin, end) for each range on its own
+   // thread. The first exception thrown by f is rethrown once every thread has stopped.
+   template <typename F>
+   void parallel_for_ranges(uint32_t first, uint32_t last, uint32_t num_threads, F f) {
+      uint64_t n  = last > first ? last - first : 0;
+      num_threads = uint32_t(std::max<uint64_t>(1, std::min<uint64_t>(num_threads, n)));
+      std::vector<std::thread> threads;
+      std::exception_ptr       error;
+      std::mutex               error_mutex;
+      for (uint32_t i = 0; i < num_threads; ++i) {
+         uint32_t begin = first + n * i / num_threads;
+         uint32_t end   = first + n * (i + 1) / num_threads;
+         threads.emplace_back([&, begin, end] {
+            try {
+               f(begin, end);
+            } catch (...) {
+               std::lock_guard<std::mutex> lock{ error_mutex };
+               if (!error)
+                  error = std::current_exception();
+            }
+         });
+      }
+      for (auto& t : threads) t.join();
+      if (error)
+         std::rethrow_exception(error);
+   }
+
+} // namespace eosio
@@ -0,0 +1,310 @@
+#pragma once
+
+#include "fixed_bytes.hpp"
+#include "stream.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#   define EOSIO_SHA256_X86 1
+#   include <cpuid.h>
+#   include <immintrin.h>
+#endif
+
+namespace eosio {
+
+   // SHA-256 (FIPS 180-4). Blocks are compressed with the SHA extensions when the cpu has them and with portable code
+   // otherwise. sha256_many hashes independent messages 8 at a time in AVX2 lanes.
+   namespace sha256_detail {
+
+      inline constexpr uint32_t k[64] = {
+         0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+         0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+         0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+         0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+         0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+         0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+         0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+         0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2,
+      };
+
+      inline constexpr uint32_t initial_state[8] = { 0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+                                                     0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19 };
+
+      inline uint32_t load_be32(const unsigned char* p) {
+         return uint32_t(p[0]) << 24 | uint32_t(p[1]) << 16 | uint32_t(p[2]) << 8 | p[3];
+      }
+
+      inline void store_be32(unsigned char* p, uint32_t v) {
+         p[0] = v >> 24;
+         p[1] = v >> 16;
+         p[2] = v >> 8;
+         p[3] = v;
+      }
+
+      inline uint32_t rotr(uint32_t x, int n) { return (x >> n) | (x << (32 - n)); }
+
+      inline void compress_portable(uint32_t* state, const unsigned char* blocks, size_t num_blocks) {
+         for (; num_blocks; --num_blocks, blocks += 64) {
+            uint32_t w[64];
+            for (int t = 0; t < 16; ++t) w[t] = load_be32(blocks + 4 * t);
+            for (int t = 16; t < 64; ++t) {
+               uint32_t s0 = rotr(w[t - 15], 7) ^ rotr(w[t - 15], 18) ^ (w[t - 15] >> 3);
+               uint32_t s1 = rotr(w[t - 2], 17) ^ rotr(w[t - 2], 19) ^ (w[t - 2] >> 10);
+               w[t]        = w[t - 16] + s0 + w[t - 7] + s1;
+            }
+            uint32_t a = state[0], b = state[1], c = state[2], d = state[3];
+            uint32_t e = state[4], f = state[5], g = state[6], h = state[7];
+            for (int t = 0; t < 64; ++t) {
+               uint32_t t1 = h + (rotr(e, 6) ^ rotr(e, 11) ^ rotr(e, 25)) + ((e & f) ^ (~e & g)) + k[t] + w[t];
+               uint32_t t2 = (rotr(a, 2) ^ rotr(a, 13) ^ rotr(a, 22)) + ((a & b) ^ (a & c) ^ (b & c));
+               h           = g;
+               g           = f;
+               f           = e;
+               e           = d + t1;
+               d           = c;
+               c           = b;
+               b           = a;
+               a           = t1 + t2;
+            }
+            state[0] += a;
+            state[1] += b;
+            state[2] += c;
+            state[3] += d;
+            state[4] += e;
+            state[5] += f;
+            state[6] += g;
+            state[7] += h;
+         }
+      }
+
+      // The padded final blocks of a message whose length is size, holding its last size % 64 bytes
+      inline size_t pad(unsigned char* tail, const unsigned char* rest, size_t size) {
+         size_t n = size % 64;
+         if (n)
+            memcpy(tail, rest, n);
+         tail[n] = 0x80;
+         size_t tail_size = n + 9 <= 64 ? 64 : 128;
+         memset(tail + n + 1, 0, tail_size - n - 1);
+         uint64_t bits = uint64_t(size) * 8;
+         for (int i = 0; i < 8; ++i) tail[tail_size - 1 - i] = bits >> (8 * i);
+         return tail_size / 64;
+      }
+
+#ifdef EOSIO_SHA256_X86
+      inline bool cpu_has(unsigned leaf, unsigned subleaf, unsigned ebx_bit) {
+         unsigned eax, ebx, ecx, edx;
+         return __get_cpuid_count(leaf, subleaf, &eax, &ebx, &ecx, &edx) && (ebx >> ebx_bit & 1);
+      }
+
+      inline bool cpu_has_sha() {
+         static const bool result = cpu_has(7, 0, 29) && __builtin_cpu_supports("sse4.1");
+         return result;
+      }
+
+      inline bool cpu_has_avx2() {
+         static const bool result = __builtin_cpu_supports("avx2");
+         return result;
+      }
+
+      __attribute__((target("sha,sse4.1"))) inline void compress_sha(uint32_t* state, const unsigned char* blocks,
+                                                                     size_t num_blocks) {
+         const __m128i byteswap = _mm_set_epi64x(0x0c0d0e0f08090a0bull, 0x0405060700010203ull);
+         __m128i       tmp      = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i*)&state[0]), 0xb1); // cdab
+         __m128i       state1   = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i*)&state[4]), 0x1b); // efgh
+         __m128i       state0   = _mm_alignr_epi8(tmp, state1, 8);                                     // abef
+         state1                 = _mm_blend_epi16(state1, tmp, 0xf0);                                  // cdgh
+         for (; num_blocks; --num_blocks, blocks += 64) {
+            __m128i abef = state0, cdgh = state1;
+            __m128i w[4];
+            for (int i = 0; i < 16; ++i) {
+               auto& wi = w[i % 4];
+               if (i < 4) {
+                  wi = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(blocks + 16 * i)), byteswap);
+               } else {
+                  auto& w1 = w[(i + 3) % 4];
+                  wi       = _mm_add_epi32(_mm_sha256msg1_epu32(wi, w[(i + 1) % 4]),
+                                           _mm_alignr_epi8(w1, w[(i + 2) % 4], 4));
+                  wi       = _mm_sha256msg2_epu32(wi, w1);
+               }
+               __m128i msg = _mm_add_epi32(wi, _mm_loadu_si128((const __m128i*)&k[4 * i]));
+               state1      = _mm_sha256rnds2_epu32(state1, state0, msg);
+               state0      = _mm_sha256rnds2_epu32(state0, state1, _mm_shuffle_epi32(msg, 0x0e));
+            }
+            state0 = _mm_add_epi32(state0, abef);
+            state1 = _mm_add_epi32(state1, cdgh);
+         }
+         tmp    = _mm_shuffle_epi32(state0, 0x1b);   // feba
+         state1 = _mm_shuffle_epi32(state1, 0xb1);   // dchg
+         state0 = _mm_blend_epi16(tmp, state1, 0xf0); // dcba
+         state1 = _mm_alignr_epi8(state1, tmp, 8);    // hgfe
+         _mm_storeu_si128((__m128i*)&state[0], state0);
+         _mm_storeu_si128((__m128i*)&state[4], state1);
+      }
+
+      template <int n>
+      __attribute__((target("avx2"))) inline __m256i rotr8(__m256i x) {
+         return _mm256_or_si256(_mm256_srli_epi32(x, n), _mm256_slli_epi32(x, 32 - n));
+      }
+
+      // One block for each of 8 independent messages. state[i] holds word i of all 8 lanes; lanes whose bit in
+      // active is clear are left unchanged.
+      __attribute__((target("avx2"))) inline void compress_x8(__m256i* state, const unsigned char* const* blocks,
+                                                              unsigned active) {
+         __m256i w[64];
+         for (int t = 0; t < 16; ++t)
+            w[t] = _mm256_setr_epi32(load_be32(blocks[0] + 4 * t), load_be32(blocks[1] + 4 * t),
+                                     load_be32(blocks[2] + 4 * t), load_be32(blocks[3] + 4 * t),
+                                     load_be32(blocks[4] + 4 * t), load_be32(blocks[5] + 4 * t),
+                                     load_be32(blocks[6] + 4 * t), load_be32(blocks[7] + 4 * t));
+         for (int t = 16; t < 64; ++t) {
+            __m256i s0 = _mm256_xor_si256(_mm256_xor_si256(rotr8<7>(w[t - 15]), rotr8<18>(w[t - 15])),
+                                          _mm256_srli_epi32(w[t - 15], 3));
+            __m256i s1 = _mm256_xor_si256(_mm256_xor_si256(rotr8<17>(w[t - 2]), rotr8<19>(w[t - 2])),
+                                          _mm256_srli_epi32(w[t - 2], 10));
+            w[t] = _mm256_add_epi32(_mm256_add_epi32(w[t - 16], s0), _mm256_add_epi32(w[t - 7], s1));
+         }
+         __m256i a = state[0], b = state[1], c = state[2], d = state[3];
+         __m256i e = state[4], f = state[5], g = state[6], h = state[7];
+         for (int t = 0; t < 64; ++t) {
+            __m256i s1 = _mm256_xor_si256(_mm256_xor_si256(rotr8<6>(e), rotr8<11>(e)), rotr8<25>(e));
+            __m256i ch = _mm256_xor_si256(_mm256_and_si256(e, f), _mm256_andnot_si256(e, g));
+            __m256i t1 = _mm256_add_epi32(_mm256_add_epi32(h, s1),
+                                          _mm256_add_epi32(ch, _mm256_add_epi32(_mm256_set1_epi32(k[t]), w[t])));
+            __m256i s0  = _mm256_xor_si256(_mm256_xor_si256(rotr8<2>(a), rotr8<13>(a)), rotr8<22>(a));
+            __m256i maj = _mm256_xor_si256(_mm256_xor_si256(_mm256_and_si256(a, b), _mm256_and_si256(a, c)),
+                                           _mm256_and_si256(b, c));
+            h = g;
+            g = f;
+            f = e;
+            e = _mm256_add_epi32(d, t1);
+            d = c;
+            c = b;
+            b = a;
+            a = _mm256_add_epi32(t1, _mm256_add_epi32(s0, maj));
+         }
+         __m256i mask = _mm256_setr_epi32(-(active & 1), -(active >> 1 & 1), -(active >> 2 & 1), -(active >> 3 & 1),
+                                          -(active >> 4 & 1), -(active >> 5 & 1), -(active >> 6 & 1),
+                                          -(active >> 7 & 1));
+         __m256i out[8] = { a, b, c, d, e, f, g, h };
+         for (int i = 0; i < 8; ++i)
+            state[i] = _mm256_add_epi32(state[i], _mm256_and_si256(out[i], mask));
+      }
+
+      __attribute__((target("avx2"))) inline void sha256_many_x8(const input_stream* messages, size_t num_messages,
+                                                                 checksum256* out) {
+         static const unsigned char zero_block[64] = {};
+         for (size_t first = 0; first < num_messages; first += 8) {
+            size_t        lanes = std::min<size_t>(8, num_messages - first);
+            unsigned char tails[8][128];
+            size_t        full[8] = {}, total[8] = {}, max_blocks = 0;
+            for (size_t j = 0; j < lanes; ++j) {
+               auto   pos  = reinterpret_cast<const unsigned char*>(messages[first + j].pos);
+               size_t size = messages[first + j].remaining();
+               full[j]     = size / 64;
+               total[j]    = full[j] + pad(tails[j], pos + full[j] * 64, size);
+               max_blocks  = std::max(max_blocks, total[j]);
+            }
+            __m256i state[8];
+            for (int i = 0; i < 8; ++i) state[i] = _mm256_set1_epi32(initial_state[i]);
+            for (size_t b = 0; b < max_blocks; ++b) {
+               const unsigned char* blocks[8];
+               unsigned             active = 0;
+               for (size_t j = 0; j < 8; ++j) {
+                  if (j < lanes && b < total[j]) {
+                     auto pos  = reinterpret_cast<const unsigned char*>(messages[first + j].pos);
+                     blocks[j] = b < full[j] ? pos + 64 * b : tails[j] + 64 * (b - full[j]);
+                     active |= 1 << j;
+                  } else {
+                     blocks[j] = zero_block;
+                  }
+               }
+               compress_x8(state, blocks, active);
+            }
+            alignas(32) uint32_t words[8][8];
+            for (int i = 0; i < 8; ++i) _mm256_store_si256((__m256i*)words[i], state[i]);
+            for (size_t j = 0; j < lanes; ++j) {
+               std::array<uint8_t, 32> digest;
+               for (int i = 0; i < 8; ++i) store_be32(digest.data() + 4 * i, words[i][j]);
+               out[first + j] = checksum256{ digest };
+            }
+         }
+      }
+#endif
+
+      using compress_fn = void (*)(uint32_t*, const unsigned char*, size_t);
+
+      inline compress_fn best_compress() {
+#ifdef EOSIO_SHA256_X86
+         if (cpu_has_sha())
+            return compress_sha;
+#endif
+         return compress_portable;
+      }
+
+   } // namespace sha256_detail
+
+   class sha256 {
+    public:
+      explicit sha256(sha256_detail::compress_fn compress = sha256_detail::best_compress()) : compress{ compress } {
+         memcpy(state, sha256_detail::initial_state, sizeof(state));
+      }
+
+      sha256& update(const void* data, size_t size) {
+         auto p = static_cast<const unsigned char*>(data);
+         total += size;
+         if (buffered) {
+            size_t n = std::min(size, 64 - buffered);
+            memcpy(buffer + buffered, p, n);
+            buffered += n;
+            p += n;
+            size -= n;
+            if (buffered < 64)
+               return *this;
+            compress(state, buffer, 1);
+            buffered = 0;
+         }
+         compress(state, p, size / 64);
+         p += size / 64 * 64;
+         buffered = size % 64;
+         memcpy(buffer, p, buffered);
+         return *this;
+      }
+
+      sha256& update(input_stream data) { return update(data.pos, data.remaining()); }
+
+      checksum256 finish() {
+         unsigned char tail[128];
+         compress(state, tail, sha256_detail::pad(tail, buffer, total));
+         std::array<uint8_t, 32> digest;
+         for (int i = 0; i < 8; ++i) sha256_detail::store_be32(digest.data() + 4 * i, state[i]);
+         return checksum256{ digest };
+      }
+
+      static checksum256 hash(const void* data, size_t size) { return sha256{}.update(data, size).finish(); }
+      static checksum256 hash(input_stream data) { return hash(data.pos, data.remaining()); }
+
+    private:
+      sha256_detail::compress_fn compress;
+      uint32_t                   state[8];
+      unsigned char              buffer[64];
+      size_t                     buffered = 0;
+      uint64_t                   total    = 0;
+   };
+
+   // Hashes num_messages independent messages into out. Without the SHA extensions but with AVX2, messages are hashed
+   // 8 at a time, one per lane; a group takes as long as its longest message. The SHA extensions hash one message at a
+   // time about as fast as the 8 AVX2 lanes together and do not depend on lengths matching, so they are used whenever
+   // the cpu has them.
+   inline void sha256_many(const input_stream* messages, size_t num_messages, checksum256* out) {
+#ifdef EOSIO_SHA256_X86
+      if (sha256_detail::cpu_has_avx2() && !sha256_detail::cpu_has_sha()) {
+         sha256_detail::sha256_many_x8(messages, num_messages, out);
+         return;
+      }
+#endif
+      for (size_t i = 0; i < num_messages; ++i) out[i] = sha256::hash(messages[i]);
+   }
+
+} // namespace eosio
@@ -0,0 +1,89 @@
+#pragma once
+
+#include "ship_protocol.hpp"
+
+#include <set>
+
+namespace eosio { namespace ship_protocol {
+
+   // Selects the table delta rows a consumer cares about, judging each row by its table name and, for contract tables,
+   // by the code and table at the front of the row's data.
+   struct delta_filter {
+      // Every row of these tables, e.g. "account" or "contract_row"
+      std::set<std::string, std::less<>> tables = {};
+
+      // Rows of the contract_* tables (contract_table, contract_row and the contract_index* tables) with this code and
+      // table. A table of name{} selects all of code's tables.
+      std::set<std::pair<eosio::name, eosio::name>> contract_tables = {};
+
+      // Whether the rows of table_name need to be looked at row by row
+      bool match_by_row(std::string_view table_name) const {
+         return !contract_tables.empty() && table_name.substr(0, 9) == "contract_";
+      }
+
+      // Whether a row of a contract_* table matches contract_tables. Only the row's variant index, code, scope and
+      // table are read.
+      bool match_row(input_stream data) const {
+         uint32_t index;
+         varuint32_from_bin(index, data);
+         uint64_t code, scope, table;
+         from_bin(code, data);
+         from_bin(scope, data);
+         from_bin(table, data);
+         return contract_tables.count({ eosio::name{ code }, eosio::name{ table } }) ||
+                contract_tables.count({ eosio::name{ code }, eosio::name{} });
+      }
+   };
+
+   // Decodes a serialized std::vector<table_delta>, keeping only the rows selected by filter. A row is a bool and a
+   // length-prefixed byte string, so rows that aren't selected are stepped over without decoding their data. Deltas
+   // left without rows are dropped.
+   inline void filter_deltas(input_stream bin, const delta_filter& filter, std::vector<table_delta>& result) {
+      result.clear();
+      uint32_t num_deltas;
+      varuint32_from_bin(num_deltas, bin);
+      for (uint32_t i = 0; i < num_deltas; ++i) {
+         uint32_t index;
+         varuint32_from_bin(index, bin);
+         check(index == 0, convert_stream_error(stream_error::bad_variant_index));
+         input_stream name;
+         from_bin(name, bin);
+         std::string_view table_name{ name.pos, size_t(name.end - name.pos) };
+         bool all_rows = filter.tables.count(table_name);
+         bool by_row   = !all_rows && filter.match_by_row(table_name);
+         uint32_t num_rows;
+         varuint32_from_bin(num_rows, bin);
+         table_delta_v0 delta;
+         for (uint32_t j = 0; j < num_rows; ++j) {
+            row_v0 row;
+            from_bin(row, bin);
+            if (all_rows || (by_row && filter.match_row(row.data)))
+               delta.rows.push_back(row);
+         }
+         if (!delta.rows.empty()) {
+            delta.name = table_name;
+            result.push_back(std::move(delta));
+         }
+      }
+   }
+
+   // Calls f(row, contract_row) for every row of the selected contract_row deltas, decoding only those rows. The
+   // row's value may then be decoded with the contract's abi.
+   template <typename F>
+   void for_each_contract_row(input_stream bin, const delta_filter& filter, F f) {
+      std::vector<table_delta> deltas;
+      filter_deltas(bin, filter, deltas);
+      for (auto& delta : deltas) {
+         auto& d = std::get<table_delta_v0>(delta);
+         if (d.name != "contract_row")
+            continue;
+         for (auto& row : d.rows) {
+            auto         data = row.data;
+            contract_row r;
+            from_bin(r, data);
+            f(row, std::get<contract_row_v0>(r));
+         }
+      }
+   }
+
+}} // namespace eosio::ship_protocol
@@ -0,0 +1,68 @@
+#pragma once
+
+#include "sha256.hpp"
+#include "ship_protocol.hpp"
+
+namespace eosio { namespace ship_protocol {
+
+   // The id of a transaction is the sha256 of its serialized transaction. Only uncompressed packed transactions are
+   // supported here; ship_transaction.hpp has an overload that inflates compressed ones.
+   inline eosio::checksum256 compute_transaction_id(const packed_transaction& trx) {
+      check(trx.compression == 0, "transaction ids of compressed packed transactions are not supported");
+      return sha256::hash(trx.packed_trx);
+   }
+
+   // The number of a block is stored big-endian in the first 4 bytes of its id
+   inline uint32_t block_num_from_id(const eosio::checksum256& id) {
+      auto bytes = id.extract_as_byte_array();
+      return uint32_t(bytes[0]) << 24 | uint32_t(bytes[1]) << 16 | uint32_t(bytes[2]) << 8 | bytes[3];
+   }
+
+   // The id of a block is the sha256 of its serialized block_header (without the producer signature) with the first 4
+   // bytes replaced by the block number
+   inline eosio::checksum256 compute_block_id(input_stream header_bin, uint32_t block_num) {
+      auto bytes = sha256::hash(header_bin).extract_as_byte_array();
+      bytes[0]   = block_num >> 24;
+      bytes[1]   = block_num >> 16;
+      bytes[2]   = block_num >> 8;
+      bytes[3]   = block_num;
+      return eosio::checksum256{ bytes };
+   }
+
+   inline eosio::checksum256 compute_block_id(const block_header& header) {
+      std::vector<char> bin;
+      vector_stream     stream{ bin };
+      to_bin(header, stream);
+      return compute_block_id(input_stream{ bin }, block_num_from_id(header.previous) + 1);
+   }
+
+   // The id of a serialized signed_block, hashing its header in place
+   inline eosio::checksum256 compute_signed_block_id(input_stream block_bin) {
+      auto         s = block_bin;
+      block_header header;
+      from_bin(header, s);
+      return compute_block_id(input_stream{ block_bin.pos, s.pos }, block_num_from_id(header.previous) + 1);
+   }
+
+   // The ids of the transactions in a block, in order. Receipts holding only an id return it; packed transactions are
+   // hashed together through sha256_many.
+   inline void compute_transaction_ids(const signed_block& block, std::vector<eosio::checksum256>& ids) {
+      ids.resize(block.transactions.size());
+      std::vector<input_stream> packed;
+      std::vector<size_t>       packed_index;
+      for (size_t i = 0; i < block.transactions.size(); ++i) {
+         if (auto* id = std::get_if<eosio::checksum256>(&block.transactions[i].trx)) {
+            ids[i] = *id;
+         } else {
+            auto& trx = std::get<packed_transaction>(block.transactions[i].trx);
+            check(trx.compression == 0, "transaction ids of compressed packed transactions are not supported");
+            packed.push_back(trx.packed_trx);
+            packed_index.push_back(i);
+         }
+      }
+      std::vector<eosio::checksum256> hashes(packed.size());
+      sha256_many(packed.data(), packed.size(), hashes.data());
+      for (size_t i = 0; i < packed.size(); ++i) ids[packed_index[i]] = hashes[i];
+   }
+
+}} // namespace eosio::ship_protocol
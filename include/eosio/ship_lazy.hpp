@@ -0,0 +1,51 @@
+#pragma once
+
+#include "lazy_vector.hpp"
+#include "ship_protocol.hpp"
+
+namespace eosio { namespace ship_protocol {
+
+   // Variants of the ship_protocol types whose large vectors are lazy_vectors. They serialize the same way as the
+   // types they mirror, so e.g. the traces of a get_blocks_result can be decoded either as
+   // std::vector<transaction_trace> or as lazy_vector<transaction_trace_lazy>.
+
+   inline void skip_bin(recurse_transaction_trace*, input_stream& bin) { skip_bin((transaction_trace*)nullptr, bin); }
+
+   struct signed_block_lazy : signed_block_header {
+      lazy_vector<transaction_receipt_v0> transactions     = {};
+      std::vector<extension>              block_extensions = {};
+   };
+
+   EOSIO_REFLECT(signed_block_lazy, base signed_block_header, transactions, block_extensions)
+
+   struct transaction_trace_v0_lazy {
+      eosio::checksum256                     id                = {};
+      transaction_status                     status            = {};
+      uint32_t                               cpu_usage_us      = {};
+      eosio::varuint32                       net_usage_words   = {};
+      int64_t                                elapsed           = {};
+      uint64_t                               net_usage         = {};
+      bool                                   scheduled         = {};
+      lazy_vector<action_trace>              action_traces     = {};
+      std::optional<account_delta>           account_ram_delta = {};
+      std::optional<std::string>             except            = {};
+      std::optional<uint64_t>                error_code        = {};
+      std::vector<recurse_transaction_trace> failed_dtrx_trace = {};
+      std::optional<partial_transaction>     partial           = {};
+   };
+
+   EOSIO_REFLECT(transaction_trace_v0_lazy, id, status, cpu_usage_us, net_usage_words, elapsed, net_usage, scheduled,
+                 action_traces, account_ram_delta, except, error_code, failed_dtrx_trace, partial)
+
+   using transaction_trace_lazy = std::variant<transaction_trace_v0_lazy>;
+
+   struct table_delta_v0_lazy {
+      std::string         name = {};
+      lazy_vector<row_v0> rows = {};
+   };
+
+   EOSIO_REFLECT(table_delta_v0_lazy, name, rows)
+
+   using table_delta_lazy = std::variant<table_delta_v0_lazy>;
+
+}} // namespace eosio::ship_protocol
@@ -0,0 +1,126 @@
+#pragma once
+
+#include "mapped_file.hpp"
+#include "parallel.hpp"
+#include "ship_ids.hpp"
+
+namespace eosio { namespace ship_protocol {
+
+   // One entry of a state-history log: the traces or table deltas of a block
+   struct log_entry {
+      uint32_t           block_num = 0;
+      eosio::checksum256 block_id  = {};
+      uint16_t           version   = 0;
+      input_stream       payload   = {}; // a view into the mapped log file
+   };
+
+   // Reads nodeos state-history logs (trace_history.log, chain_state_history.log) and their .index files through
+   // memory mappings. Entries are found in O(1) through the index and returned as views into the log without copying.
+   //
+   // Each entry is a header {magic, block_id, payload_size}, the payload and the entry's own file position. The index
+   // holds the position of every block's entry starting with the log's first block. nodeos stores payloads as a
+   // uint32 size followed by the zlib-compressed std::vector<transaction_trace> or std::vector<table_delta>; see
+   // compressed_data().
+   //
+   // The log must not be written to while it is mapped. Pruned logs are not supported.
+   class state_history_log {
+    public:
+      static constexpr size_t header_size = 8 + 32 + 8;
+
+      // path is the .log file; the index is the file of the same name ending in .index
+      explicit state_history_log(const std::string& path) : log{ path }, index{ index_path(path) } {
+         check(index.length() % 8 == 0, "state-history index has a partial entry");
+         if (!index.length())
+            return;
+         auto first = read_entry(position(0));
+         first_block = first.block_num;
+         end_block_  = first_block + index.length() / 8;
+      }
+
+      uint32_t begin_block() const { return first_block; }
+      uint32_t end_block() const { return end_block_; }
+      bool     contains(uint32_t block_num) const { return block_num >= first_block && block_num < end_block_; }
+
+      log_entry get(uint32_t block_num) const {
+         check(contains(block_num), "block " + std::to_string(block_num) + " is not in the state-history log");
+         auto entry = read_entry(position(block_num - first_block));
+         check(entry.block_num == block_num, "state-history index does not match its log");
+         return entry;
+      }
+
+      // Calls f(const log_entry&) for each block in [first, last) in order
+      template <typename F>
+      void for_each(uint32_t first, uint32_t last, F f) const {
+         for (uint32_t b = first; b < last; ++b) f(static_cast<const log_entry&>(get(b)));
+      }
+
+      // Splits [first, last) into num_threads consecutive ranges and calls f(const log_entry&) for the entries of
+      // each range on its own thread. f must be safe to call concurrently. The first exception thrown by f or by
+      // reading the log is rethrown once every thread has stopped.
+      template <typename F>
+      void parallel_for_each(uint32_t first, uint32_t last, uint32_t num_threads, F f) const {
+         parallel_for_ranges(first, last, num_threads, [&](uint32_t begin, uint32_t end) { for_each(begin, end, f); });
+      }
+
+      // The zlib stream in a payload written by nodeos, after its uint32 size
+      static input_stream compressed_data(const log_entry& entry) {
+         auto     bin = entry.payload;
+         uint32_t size;
+         bin.read_raw(size);
+         check(size <= bin.remaining(), convert_stream_error(stream_error::overrun));
+         return { bin.pos, size };
+      }
+
+      static bool is_ship(uint64_t magic) { return (magic & 0xffff'ffff'0000'0000) == eosio::name{ "ship" }.value; }
+
+      static uint32_t block_num_from_id(const eosio::checksum256& id) { return ship_protocol::block_num_from_id(id); }
+
+    private:
+      mapped_file log;
+      mapped_file index;
+      uint32_t    first_block = 0;
+      uint32_t    end_block_  = 0;
+
+      static std::string index_path(const std::string& path) {
+         auto ext = path.size() >= 4 && path.compare(path.size() - 4, 4, ".log") == 0 ? path.size() - 4 : path.size();
+         return path.substr(0, ext) + ".index";
+      }
+
+      uint64_t position(uint64_t i) const {
+         uint64_t pos;
+         memcpy(&pos, index.data() + i * 8, 8);
+         return pos;
+      }
+
+      log_entry read_entry(uint64_t pos) const {
+         auto     bin = log.slice(pos, header_size);
+         uint64_t magic, payload_size;
+         log_entry entry;
+         bin.read_raw(magic);
+         from_bin(entry.block_id, bin);
+         bin.read_raw(payload_size);
+         check(is_ship(magic), "state-history log entry has a bad magic number");
+         check(!(magic >> 16 & 0xffff), "pruned state-history logs are not supported");
+         entry.version   = uint16_t(magic);
+         entry.block_num = block_num_from_id(entry.block_id);
+         check(entry.version <= 1, "unsupported state-history log version " + std::to_string(entry.version));
+         check(payload_size <= log.length(), convert_stream_error(stream_error::overrun));
+         entry.payload = log.slice(pos + header_size, payload_size);
+         auto     suffix = log.slice(pos + header_size + payload_size, 8);
+         uint64_t suffix_pos;
+         suffix.read_raw(suffix_pos);
+         check(suffix_pos == pos, "state-history log entry position does not match");
+         return entry;
+      }
+   };
+
+   // Decodes a payload written by nodeos into value: std::vector<transaction_trace> for trace_history.log or
+   // std::vector<table_delta> for chain_state_history.log. inflater is an eosio::zlib_inflater (zlib.hpp); value may
+   // refer into its buffer, so it is valid until the inflater's next use.
+   template <typename T, typename Inflater>
+   void decode_log_entry(T& value, const log_entry& entry, Inflater& inflater) {
+      auto bin = inflater.inflate(state_history_log::compressed_data(entry));
+      from_bin(value, bin);
+   }
+
+}} // namespace eosio::ship_protocol
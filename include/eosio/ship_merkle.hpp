@@ -0,0 +1,116 @@
+#pragma once
+
+#include "sha256.hpp"
+#include "ship_protocol.hpp"
+
+#include <algorithm>
+
+namespace eosio { namespace ship_protocol {
+
+   // The merkle tree of block_header::transaction_mroot and action_mroot (before instant finality). Each level pairs
+   // neighbours, duplicating the last node of an odd level, and hashes the 64 bytes of the pair with the high bit of
+   // the left node's first byte cleared and that of the right node set. The root of no leaves is all zeros and the
+   // root of one leaf is the leaf itself.
+   //
+   // The pairs of a level are independent, so each level is hashed as one batch through sha256_many.
+   inline eosio::checksum256 merkle_root(std::vector<eosio::checksum256> nodes) {
+      if (nodes.empty())
+         return {};
+      std::vector<std::array<uint8_t, 64>> pairs;
+      std::vector<input_stream>            streams;
+      while (nodes.size() > 1) {
+         if (nodes.size() % 2)
+            nodes.push_back(nodes.back());
+         pairs.resize(nodes.size() / 2);
+         streams.resize(pairs.size());
+         for (size_t i = 0; i < pairs.size(); ++i) {
+            auto left  = nodes[2 * i].extract_as_byte_array();
+            auto right = nodes[2 * i + 1].extract_as_byte_array();
+            left[0] &= 0x7f;
+            right[0] |= 0x80;
+            std::copy(left.begin(), left.end(), pairs[i].begin());
+            std::copy(right.begin(), right.end(), pairs[i].begin() + 32);
+            streams[i] = { reinterpret_cast<const char*>(pairs[i].data()), pairs[i].size() };
+         }
+         sha256_many(streams.data(), streams.size(), nodes.data());
+         nodes.resize(pairs.size());
+      }
+      return nodes.front();
+   }
+
+   // The digest of a packed transaction that a transaction receipt commits to. Signatures and context-free data are
+   // hashed separately so they can be pruned without changing it.
+   inline eosio::checksum256 packed_transaction_digest(const packed_transaction& trx) {
+      std::vector<char> bin;
+      vector_stream     stream{ bin };
+      to_bin(trx.signatures, stream);
+      to_bin(trx.packed_context_free_data, stream);
+      auto prunable = sha256::hash(bin.data(), bin.size());
+      bin.clear();
+      to_bin(trx.compression, stream);
+      to_bin(trx.packed_trx, stream);
+      to_bin(prunable, stream);
+      return sha256::hash(bin.data(), bin.size());
+   }
+
+   // The leaf of transaction_mroot for a transaction_receipt or transaction_receipt_v0
+   template <typename Receipt>
+   eosio::checksum256 transaction_receipt_digest(const Receipt& receipt) {
+      std::vector<char> bin;
+      vector_stream     stream{ bin };
+      to_bin(static_cast<const transaction_receipt_header&>(receipt), stream);
+      if (auto* id = std::get_if<eosio::checksum256>(&receipt.trx))
+         to_bin(*id, stream);
+      else
+         to_bin(packed_transaction_digest(std::get<packed_transaction>(receipt.trx)), stream);
+      return sha256::hash(bin.data(), bin.size());
+   }
+
+   // The leaf of action_mroot for an action receipt
+   inline eosio::checksum256 action_receipt_digest(const action_receipt_v0& receipt) {
+      auto bin = convert_to_bin(receipt);
+      return sha256::hash(bin.data(), bin.size());
+   }
+
+   inline eosio::checksum256 compute_transaction_mroot(const signed_block& block) {
+      std::vector<eosio::checksum256> leaves;
+      leaves.reserve(block.transactions.size());
+      for (auto& receipt : block.transactions) leaves.push_back(transaction_receipt_digest(receipt));
+      return merkle_root(std::move(leaves));
+   }
+
+   // The action_mroot of a block from its traces. The leaves are the receipts of the actions in the order they ran,
+   // which is the order of their global sequence numbers. Actions of a failed deferred transaction were rolled back
+   // and have no leaves.
+   inline eosio::checksum256 compute_action_mroot(const std::vector<transaction_trace>& traces) {
+      std::vector<const action_receipt_v0*> receipts;
+      for (auto& trace : traces) {
+         for (auto& action : std::get<transaction_trace_v0>(trace).action_traces) {
+            std::visit(
+                  [&](auto& a) {
+                     if (a.receipt)
+                        receipts.push_back(&std::get<action_receipt_v0>(*a.receipt));
+                  },
+                  action);
+         }
+      }
+      std::sort(receipts.begin(), receipts.end(),
+                [](auto* a, auto* b) { return a->global_sequence < b->global_sequence; });
+
+      // receipts have similar sizes, so their digests batch well
+      std::vector<char>   bin;
+      vector_stream       stream{ bin };
+      std::vector<size_t> ends;
+      for (auto* receipt : receipts) {
+         to_bin(*receipt, stream);
+         ends.push_back(bin.size());
+      }
+      std::vector<input_stream> streams;
+      for (size_t i = 0; i < ends.size(); ++i)
+         streams.push_back({ bin.data() + (i ? ends[i - 1] : 0), bin.data() + ends[i] });
+      std::vector<eosio::checksum256> leaves(streams.size());
+      sha256_many(streams.data(), streams.size(), leaves.data());
+      return merkle_root(std::move(leaves));
+   }
+
+}} // namespace eosio::ship_protocol
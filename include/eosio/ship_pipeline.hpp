@@ -0,0 +1,206 @@
+#pragma once
+
+#include "check.hpp"
+#include "ship_delta_filter.hpp"
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+
+namespace eosio { namespace ship_protocol {
+
+   // A state-history `result` message with its block, traces, deltas and finality data decoded. The decoded values
+   // refer into message (action data, delta rows, ...), so they stay valid only as long as the decoded_result.
+   struct decoded_result {
+      std::vector<char>              message  = {};
+      ship_protocol::result          result   = {};
+      std::optional<signed_block>    block    = {};
+      std::vector<transaction_trace> traces   = {};
+      std::vector<table_delta>       deltas   = {};
+      std::optional<finality_data>   finality = {};
+   };
+
+   // Decodes a stream of state-history `result` messages on a pool of worker threads.
+   //
+   // The result header is read by push(); the block, traces, deltas and finality data are then decoded as separate
+   // tasks, so one large block spreads over several workers and consecutive blocks overlap. pop() returns results in
+   // the order their messages were pushed. Once max_in_flight messages have been pushed and not yet popped, push()
+   // blocks, which applies backpressure to whatever reads the socket or log. A message that fails to decode rethrows
+   // its error from the pop() that would have returned it.
+   //
+   // Given a delta_filter, only the table delta rows it selects are kept; the others are skipped without decoding.
+   //
+   // push() and pop() are meant to be called from different threads: a reader thread pushing and a consumer popping.
+   // close() wakes a push() waiting for space, which then throws. Destroying the decoder wakes both and they throw;
+   // messages still being decoded are abandoned.
+   class block_decoder {
+    public:
+      explicit block_decoder(uint32_t num_threads = std::thread::hardware_concurrency(), uint32_t max_in_flight = 64,
+                             std::optional<delta_filter> filter = {})
+          : max_in_flight{ std::max(max_in_flight, 1u) }, filter{ std::move(filter) } {
+         for (uint32_t i = 0; i < std::max(num_threads, 1u); ++i) workers.emplace_back([this] { run(); });
+      }
+
+      block_decoder(const block_decoder&) = delete;
+      block_decoder& operator=(const block_decoder&) = delete;
+
+      ~block_decoder() {
+         {
+            std::lock_guard<std::mutex> lock{ mutex };
+            stopping = true;
+         }
+         task_cv.notify_all();
+         space_cv.notify_all();
+         ready_cv.notify_all();
+         for (auto& w : workers) w.join();
+         // The workers stopped between tasks; fail what they didn't get to rather than leave it half decoded
+         tasks.clear();
+         for (auto& s : slots) {
+            if (s->remaining) {
+               s->error     = std::make_exception_ptr(std::runtime_error("block_decoder destroyed"));
+               s->remaining = 0;
+            }
+         }
+      }
+
+      void push(std::vector<char> message) {
+         auto s            = std::make_unique<slot>();
+         s->result.message = std::move(message);
+         try {
+            input_stream bin{ s->result.message };
+            from_bin(s->result.result, bin);
+         } catch (...) { s->error = std::current_exception(); }
+         const get_blocks_result_v0* blocks = nullptr;
+         if (!s->error) {
+            if (auto* v0 = std::get_if<get_blocks_result_v0>(&s->result.result))
+               blocks = v0;
+            else if (auto* v1 = std::get_if<get_blocks_result_v1>(&s->result.result))
+               blocks = v1;
+         }
+
+         std::unique_lock<std::mutex> lock{ mutex };
+         space_cv.wait(lock, [&] { return closed || stopping || slots.size() < max_in_flight; });
+         check(!closed, "block_decoder is closed");
+         check(!stopping, "block_decoder destroyed");
+         if (blocks) {
+            auto add = [&](part p, const std::optional<input_stream>& bin) {
+               if (bin) {
+                  tasks.push_back({ s.get(), p, *bin });
+                  ++s->remaining;
+               }
+            };
+            add(part::block, blocks->block);
+            add(part::traces, blocks->traces);
+            add(part::deltas, blocks->deltas);
+            if (auto* v1 = std::get_if<get_blocks_result_v1>(&s->result.result))
+               add(part::finality, v1->finality_data);
+         }
+         bool ready = !s->remaining;
+         slots.push_back(std::move(s));
+         lock.unlock();
+         if (ready)
+            ready_cv.notify_all();
+         else
+            task_cv.notify_all();
+      }
+
+      // Returns the next result in push order, or nullopt once close() has been called and every result returned
+      std::optional<decoded_result> pop() {
+         std::unique_lock<std::mutex> lock{ mutex };
+         ready_cv.wait(lock, [&] {
+            return stopping || (!slots.empty() && !slots.front()->remaining) || (closed && slots.empty());
+         });
+         check(!stopping, "block_decoder destroyed");
+         if (slots.empty())
+            return std::nullopt;
+         auto s = std::move(slots.front());
+         slots.pop_front();
+         lock.unlock();
+         space_cv.notify_one();
+         if (s->error)
+            std::rethrow_exception(s->error);
+         return std::move(s->result);
+      }
+
+      // No more messages will be pushed
+      void close() {
+         {
+            std::lock_guard<std::mutex> lock{ mutex };
+            closed = true;
+         }
+         ready_cv.notify_all();
+         space_cv.notify_all();
+      }
+
+    private:
+      enum class part { block, traces, deltas, finality };
+
+      struct slot {
+         decoded_result     result    = {};
+         std::exception_ptr error     = {};
+         uint32_t           remaining = 0;
+      };
+
+      struct task {
+         slot*        s   = nullptr;
+         part         p   = {};
+         input_stream bin = {};
+      };
+
+      const uint32_t                    max_in_flight;
+      const std::optional<delta_filter> filter;
+      std::mutex                        mutex;
+      std::condition_variable           task_cv;
+      std::condition_variable           space_cv;
+      std::condition_variable           ready_cv;
+      std::deque<std::unique_ptr<slot>> slots;
+      std::deque<task>                  tasks;
+      bool                              closed   = false;
+      bool                              stopping = false;
+      std::vector<std::thread>          workers;
+
+      // Each part is written to its own member of decoded_result, so tasks of one slot never share data
+      void decode(const task& t) const {
+         auto  bin = t.bin;
+         auto& r   = t.s->result;
+         switch (t.p) {
+            case part::block: from_bin(r.block.emplace(), bin); break;
+            case part::traces: from_bin(r.traces, bin); break;
+            case part::deltas:
+               if (filter)
+                  filter_deltas(bin, *filter, r.deltas);
+               else
+                  from_bin(r.deltas, bin);
+               break;
+            case part::finality: from_bin(r.finality.emplace(), bin); break;
+         }
+      }
+
+      void run() {
+         std::unique_lock<std::mutex> lock{ mutex };
+         for (;;) {
+            task_cv.wait(lock, [&] { return stopping || !tasks.empty(); });
+            if (stopping)
+               return;
+            auto t = tasks.front();
+            tasks.pop_front();
+            lock.unlock();
+            std::exception_ptr error;
+            try {
+               decode(t);
+            } catch (...) { error = std::current_exception(); }
+            lock.lock();
+            if (error && !t.s->error)
+               t.s->error = error;
+            if (!--t.s->remaining && t.s == slots.front().get())
+               ready_cv.notify_all();
+         }
+      }
+   };
+
+}} // namespace eosio::ship_protocol
@@ -0,0 +1,109 @@
+#pragma once
+
+#include "ship_lazy.hpp"
+
+#include <tuple>
+
+namespace eosio { namespace ship_protocol {
+
+   // Selects action traces by (receiver, account, action name). name{} in a subscription matches any value.
+   struct action_filter {
+      std::vector<std::tuple<eosio::name, eosio::name, eosio::name>> subscriptions = {};
+
+      bool match(eosio::name receiver, eosio::name account, eosio::name action) const {
+         for (auto& [r, a, n] : subscriptions)
+            if ((!r.value || r == receiver) && (!a.value || a == account) && (!n.value || n == action))
+               return true;
+         return false;
+      }
+   };
+
+   // An action trace selected by scan_action_traces
+   struct action_match {
+      eosio::checksum256 transaction_id         = {};
+      uint32_t           action_ordinal         = {};
+      uint32_t           creator_action_ordinal = {};
+      eosio::name        receiver               = {};
+      eosio::name        account                = {};
+      eosio::name        name                   = {};
+      input_stream       trace                  = {}; // the serialized action_trace, ready for from_bin
+   };
+
+   namespace trace_scan {
+      // Steps over a serialized T with the same layout walker as lazy_vector
+      template <typename T>
+      void skip(input_stream& bin) {
+         skip_bin((T*)nullptr, bin);
+      }
+
+      inline uint32_t read_variant_index(input_stream& bin, uint32_t num_alternatives) {
+         uint32_t index;
+         varuint32_from_bin(index, bin);
+         check(index < num_alternatives, convert_stream_error(stream_error::bad_variant_index));
+         return index;
+      }
+
+      // Reads the fields of an action_trace that identify it and steps over the rest. action_trace_v1 is
+      // action_trace_v0 followed by return_value.
+      template <typename F>
+      void scan_action(input_stream& bin, action_match& m, const action_filter& filter, F& f) {
+         using v0   = action_trace_v0;
+         auto begin = bin.pos;
+         auto index = read_variant_index(bin, std::variant_size_v<action_trace>);
+         varuint32_from_bin(m.action_ordinal, bin);
+         varuint32_from_bin(m.creator_action_ordinal, bin);
+         skip<decltype(v0::receipt)>(bin);
+         from_bin(m.receiver, bin);
+         from_bin(m.account, bin);
+         from_bin(m.name, bin);
+         skip<decltype(action::authorization)>(bin);
+         skip<decltype(action::data)>(bin);
+         skip<decltype(v0::context_free)>(bin);
+         skip<decltype(v0::elapsed)>(bin);
+         skip<decltype(v0::console)>(bin);
+         skip<decltype(v0::account_ram_deltas)>(bin);
+         skip<decltype(v0::except)>(bin);
+         skip<decltype(v0::error_code)>(bin);
+         if (index == 1)
+            skip<decltype(action_trace_v1::return_value)>(bin);
+         if (filter.match(m.receiver, m.account, m.name)) {
+            m.trace = { begin, bin.pos };
+            f(static_cast<const action_match&>(m));
+         }
+      }
+
+      template <typename F>
+      void scan_transaction(input_stream& bin, const action_filter& filter, F& f) {
+         using v0 = transaction_trace_v0;
+         action_match m;
+         read_variant_index(bin, std::variant_size_v<transaction_trace>);
+         from_bin(m.transaction_id, bin);
+         skip<decltype(v0::status)>(bin);
+         skip<decltype(v0::cpu_usage_us)>(bin);
+         skip<decltype(v0::net_usage_words)>(bin);
+         skip<decltype(v0::elapsed)>(bin);
+         skip<decltype(v0::net_usage)>(bin);
+         skip<decltype(v0::scheduled)>(bin);
+         uint32_t size;
+         varuint32_from_bin(size, bin);
+         for (uint32_t i = 0; i < size; ++i) scan_action(bin, m, filter, f);
+         skip<decltype(v0::account_ram_delta)>(bin);
+         skip<decltype(v0::except)>(bin);
+         skip<decltype(v0::error_code)>(bin);
+         skip<decltype(v0::failed_dtrx_trace)>(bin);
+         skip<decltype(v0::partial)>(bin);
+      }
+   } // namespace trace_scan
+
+   // Calls f(const action_match&) for each action trace in a serialized std::vector<transaction_trace> that passes
+   // filter. Only the variant index, ordinals, receiver, account and action name of each action trace are read; the
+   // rest of the traces are stepped over by their lengths without being decoded. The actions of failed deferred
+   // transactions (failed_dtrx_trace) are not reported.
+   template <typename F>
+   void scan_action_traces(input_stream bin, const action_filter& filter, F f) {
+      uint32_t size;
+      varuint32_from_bin(size, bin);
+      for (uint32_t i = 0; i < size; ++i) trace_scan::scan_transaction(bin, filter, f);
+   }
+
+}} // namespace eosio::ship_protocol
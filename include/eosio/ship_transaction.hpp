@@ -0,0 +1,42 @@
+#pragma once
+
+#include "ship_ids.hpp"
+
+namespace eosio { namespace ship_protocol {
+
+   enum class packed_transaction_compression : uint8_t {
+      none = 0,
+      zlib = 1,
+   };
+
+   // nodeos refuses to decompress more than this from a packed transaction
+   inline constexpr size_t max_unpacked_transaction_size = 1024 * 1024;
+
+   // The serialized data of a packed transaction field (packed_trx or packed_context_free_data). Uncompressed data is
+   // returned in place without copying. zlib-compressed data is inflated into the buffer of inflater, an
+   // eosio::zlib_inflater (zlib.hpp), so it stays valid until the inflater's next use; keep one inflater per thread
+   // and its buffer is reused without allocating once it has grown to the largest transaction.
+   template <typename Inflater>
+   input_stream unpack_transaction_data(const packed_transaction& trx, input_stream data, Inflater& inflater) {
+      switch (packed_transaction_compression{ trx.compression }) {
+         case packed_transaction_compression::none: return data;
+         case packed_transaction_compression::zlib: return inflater.inflate(data, max_unpacked_transaction_size);
+      }
+      throw std::runtime_error("unsupported packed transaction compression " + std::to_string(trx.compression));
+   }
+
+   // Decodes the transaction of a packed transaction. Its actions' data refer to the packed transaction or, when it
+   // is compressed, to inflater's buffer; see unpack_transaction_data.
+   template <typename Inflater>
+   void unpack_transaction(const packed_transaction& trx, transaction& result, Inflater& inflater) {
+      auto bin = unpack_transaction_data(trx, trx.packed_trx, inflater);
+      from_bin(result, bin);
+   }
+
+   // The transaction id of a packed transaction, which is the hash of its uncompressed transaction
+   template <typename Inflater>
+   eosio::checksum256 compute_transaction_id(const packed_transaction& trx, Inflater& inflater) {
+      return sha256::hash(unpack_transaction_data(trx, trx.packed_trx, inflater));
+   }
+
+}} // namespace eosio::ship_protocol
@@ -1,8 +1,10 @@
 #pragma once
 
+#include <algorithm>
 #include <deque>
 #include "for_each_field.hpp"
 #include "stream.hpp"
+#include "to_key_span.hpp"
 #include <list>
 #include <map>
 #include <optional>
@@ -57,9 +59,107 @@ void to_key(const std::tuple<Ts...>& obj, S& stream) {
    to_key_tuple<0>(obj, stream);
 }
 
+struct name;
+
+// Arithmetic types, scoped enumerations and names, whose keys are written a span at a time by the kernels of
+// to_key_span.hpp
+template <typename T>
+constexpr bool has_key_span() {
+   if constexpr (std::is_same_v<T, name> || std::is_floating_point_v<T>) {
+      return sizeof(T) == 4 || sizeof(T) == 8;
+   } else if constexpr (std::is_enum_v<T>) {
+      return !std::is_convertible_v<T, std::underlying_type_t<T>> && has_key_span<std::underlying_type_t<T>>();
+   } else if constexpr (std::is_integral_v<T> && !std::is_same_v<T, bool>) {
+      return sizeof(T) <= 8;
+   } else {
+      return false;
+   }
+}
+
+template <typename T, bool = std::is_enum_v<T>>
+struct key_span_integer {
+   using type = T;
+};
+
+template <typename T>
+struct key_span_integer<T, true> {
+   using type = std::underlying_type_t<T>;
+};
+
+// The sign bit of signed integers, which to_key flips
+template <typename T>
+constexpr auto key_span_flip() {
+   using I = typename key_span_integer<T>::type;
+   using U = std::make_unsigned_t<I>;
+   return std::is_signed_v<I> ? U(U(1) << (sizeof(U) * 8 - 1)) : U(0);
+}
+
+// Writes the keys of n elements into dest, which has room for n * sizeof(T) bytes
+template <typename T>
+void write_key_span(const T* src, std::size_t n, char* dest) {
+   static_assert(has_key_span<T>());
+   if constexpr (std::is_same_v<T, name>) {
+      to_key_detail::integer_keys(reinterpret_cast<const uint64_t*>(src), n, uint64_t(0), dest);
+   } else if constexpr (std::is_floating_point_v<T>) {
+      using U = std::conditional_t<sizeof(T) == 4, uint32_t, uint64_t>;
+      to_key_detail::float_keys(reinterpret_cast<const U*>(src), n, dest);
+   } else {
+      using U = std::make_unsigned_t<typename key_span_integer<T>::type>;
+      to_key_detail::integer_keys(reinterpret_cast<const U*>(src), n, key_span_flip<T>(), dest);
+   }
+}
+
+// The keys of n elements back to back, as in std::array
+template <typename T, typename S>
+void to_key_span(const T* src, std::size_t n, S& stream) {
+   if constexpr (std::is_same_v<S, size_stream>) {
+      stream.size += n * sizeof(T);
+   } else {
+      constexpr std::size_t chunk = 1024 / sizeof(T);
+      char                  buf[chunk * sizeof(T)];
+      for (std::size_t i = 0; i < n; i += chunk) {
+         auto count = std::min(chunk, n - i);
+         write_key_span(src + i, count, buf);
+         stream.write(buf, count * sizeof(T));
+      }
+   }
+}
+
+// The elements of a vector, each as to_key_optional writes it
+template <typename T, typename S>
+void to_key_optional_span(const T* src, std::size_t n, S& stream) {
+   constexpr std::size_t chunk = 1024 / sizeof(T);
+   if constexpr (sizeof(T) == 1) {
+      char buf[2 * chunk];
+      for (std::size_t i = 0; i < n; i += chunk) {
+         auto count = std::min(chunk, n - i);
+         stream.write(buf, to_key_detail::escaped_byte_keys(reinterpret_cast<const uint8_t*>(src + i), count,
+                                                            key_span_flip<T>(), buf));
+      }
+   } else if constexpr (std::is_same_v<S, size_stream>) {
+      stream.size += n * (sizeof(T) + 1);
+   } else {
+      char keys[chunk * sizeof(T)];
+      char buf[chunk * (sizeof(T) + 1)];
+      for (std::size_t i = 0; i < n; i += chunk) {
+         auto count = std::min(chunk, n - i);
+         write_key_span(src + i, count, keys);
+         for (std::size_t j = 0; j < count; ++j) {
+            buf[j * (sizeof(T) + 1)] = '\1';
+            memcpy(buf + j * (sizeof(T) + 1) + 1, keys + j * sizeof(T), sizeof(T));
+         }
+         stream.write(buf, count * (sizeof(T) + 1));
+      }
+   }
+}
+
 template <typename T, std::size_t N, typename S>
 void to_key(const std::array<T, N>& obj, S& stream) {
-   for (const T& elem : obj) { to_key(elem, stream); }
+   if constexpr (has_key_span<T>()) {
+      to_key_span(obj.data(), N, stream);
+   } else {
+      for (const T& elem : obj) { to_key(elem, stream); }
+   }
 }
 
 template <typename T, typename S>
@@ -109,7 +209,11 @@ void to_key_range(const T& obj, S& stream) {
 
 template <typename T, typename S>
 void to_key(const std::vector<T>& obj, S& stream) {
-   for (const T& elem : obj) { to_key_optional(&elem, stream); }
+   if constexpr (has_key_span<T>()) {
+      to_key_optional_span(obj.data(), obj.size(), stream);
+   } else {
+      for (const T& elem : obj) { to_key_optional(&elem, stream); }
+   }
    to_key_optional((const T*)nullptr, stream);
 }
 
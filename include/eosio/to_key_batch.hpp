@@ -0,0 +1,273 @@
+#pragma once
+
+#include "parallel.hpp"
+#include "to_key.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <numeric>
+#include <string_view>
+
+namespace eosio {
+
+   // fixed_key_size((T*)nullptr) is the size of the key of every T when it doesn't depend on the value, and 0 when it
+   // does. Types with their own to_key provide an overload found by argument-dependent lookup, next to that to_key.
+   template <typename T>
+   constexpr size_t fixed_key_size(T*);
+   constexpr size_t fixed_key_size(std::string*) { return 0; }
+   constexpr size_t fixed_key_size(std::string_view*) { return 0; }
+   template <typename T>
+   constexpr size_t fixed_key_size(std::vector<T>*) { return 0; }
+   template <typename T>
+   constexpr size_t fixed_key_size(std::list<T>*) { return 0; }
+   template <typename T>
+   constexpr size_t fixed_key_size(std::deque<T>*) { return 0; }
+   template <typename T>
+   constexpr size_t fixed_key_size(std::set<T>*) { return 0; }
+   template <typename T, typename U>
+   constexpr size_t fixed_key_size(std::map<T, U>*) { return 0; }
+   template <typename T>
+   constexpr size_t fixed_key_size(std::optional<T>*) { return 0; }
+   template <typename... Ts>
+   constexpr size_t fixed_key_size(std::variant<Ts...>*) { return 0; }
+
+   template <typename T, std::size_t N>
+   constexpr size_t fixed_key_size(std::array<T, N>*) {
+      return N * fixed_key_size((T*)nullptr);
+   }
+
+   template <typename T, typename U>
+   constexpr size_t fixed_key_size(std::pair<T, U>*) {
+      constexpr size_t first = fixed_key_size((T*)nullptr), second = fixed_key_size((U*)nullptr);
+      return first && second ? first + second : 0;
+   }
+
+   template <typename... Ts>
+   constexpr size_t fixed_key_size(std::tuple<Ts...>*) {
+      constexpr std::array<size_t, sizeof...(Ts)> sizes{ fixed_key_size((Ts*)nullptr)... };
+      size_t                                     result = 0;
+      for (auto size : sizes) {
+         if (!size)
+            return 0;
+         result += size;
+      }
+      return result;
+   }
+
+   template <typename T>
+   constexpr size_t fixed_key_size(T*) {
+      if constexpr (std::is_same_v<T, bool>) {
+         return 1;
+      } else if constexpr (std::is_arithmetic_v<T> || std::is_enum_v<T>) {
+         return sizeof(T);
+      } else if constexpr (reflection::has_for_each_field_v<T>) {
+         size_t result   = 0;
+         bool   variable = false;
+         for_each_field<T>([&](const char*, auto member) {
+            auto size = fixed_key_size((std::decay_t<decltype(member((T*)nullptr))>*)nullptr);
+            variable |= !size;
+            result += size;
+         });
+         return variable ? 0 : result;
+      } else {
+         return 0;
+      }
+   }
+
+   // The keys (to_key.hpp) of many objects encoded back to back into one buffer. Key i is
+   // data[offsets[i], offsets[i + 1]). When every key has the same size, key_size holds it, offsets is empty, and key i
+   // starts at i * key_size.
+   struct key_batch {
+      std::vector<char>     data;
+      std::vector<uint64_t> offsets;
+      size_t                key_size = 0;
+      size_t                count    = 0;
+
+      size_t size() const { return count; }
+
+      std::string_view key(size_t i) const {
+         if (key_size)
+            return { data.data() + i * key_size, key_size };
+         return { data.data() + offsets[i], size_t(offsets[i + 1] - offsets[i]) };
+      }
+   };
+
+   // Encodes the keys of objects into batch, reusing what batch has already allocated. Unlike convert_to_key there is
+   // no sizing pass: fixed-width keys are written in place and the others are appended to the buffer.
+   template <typename T>
+   void convert_to_keys(const std::vector<T>& objects, key_batch& batch) {
+      constexpr size_t key_size = fixed_key_size((T*)nullptr);
+      batch.data.clear();
+      batch.offsets.clear();
+      batch.key_size = key_size;
+      batch.count    = objects.size();
+      if constexpr (key_size != 0) {
+         batch.data.resize(objects.size() * key_size);
+         char* pos = batch.data.data();
+         for (auto& obj : objects) {
+            fixed_buf_stream stream{ pos, key_size };
+            to_key(obj, stream);
+            check(stream.pos == stream.end, convert_stream_error(stream_error::underrun));
+            pos += key_size;
+         }
+      } else {
+         batch.offsets.reserve(objects.size() + 1);
+         batch.offsets.push_back(0);
+         vector_stream stream{ batch.data };
+         for (auto& obj : objects) {
+            to_key(obj, stream);
+            batch.offsets.push_back(batch.data.size());
+         }
+      }
+   }
+
+   template <typename T>
+   key_batch convert_to_keys(const std::vector<T>& objects) {
+      key_batch result;
+      convert_to_keys(objects, result);
+      return result;
+   }
+
+   namespace key_sort_detail {
+
+      // Buckets this small are finished with a comparison sort
+      inline constexpr size_t small_bucket = 64;
+
+      using bucket_counts = std::array<uint32_t, 257>;
+
+      // Byte depth of key i plus one, or 0 past its end so that a key sorts before the keys it is a prefix of
+      inline uint32_t key_byte(const key_batch& batch, uint32_t i, size_t depth) {
+         if (batch.key_size)
+            return depth < batch.key_size ? uint8_t(batch.data[i * batch.key_size + depth]) + 1 : 0;
+         auto key = batch.key(i);
+         return depth < key.size() ? uint8_t(key[depth]) + 1 : 0;
+      }
+
+      // Equal keys keep the order of their indexes, which is their original order
+      inline void comparison_sort(const key_batch& batch, uint32_t* indexes, size_t n, size_t depth) {
+         std::sort(indexes, indexes + n, [&](uint32_t a, uint32_t b) {
+            // char_traits<char> compares as unsigned char
+            int c = batch.key(a).substr(depth).compare(batch.key(b).substr(depth));
+            return c < 0 || (c == 0 && a < b);
+         });
+      }
+
+      // The number of bytes from depth on that the keys of indexes all share. It usually stops at the second key.
+      inline size_t shared_prefix(const key_batch& batch, const uint32_t* indexes, size_t n, size_t depth) {
+         auto   first  = batch.key(indexes[0]).substr(depth);
+         size_t result = first.size();
+         for (size_t i = 1; i < n && result; ++i) {
+            auto key = batch.key(indexes[i]).substr(depth);
+            result   = std::mismatch(first.begin(), first.begin() + std::min(result, key.size()), key.begin()).first -
+                     first.begin();
+         }
+         return result;
+      }
+
+      // Stably partitions indexes by byte depth of their keys, after skipping the bytes that all the keys share.
+      // digits is scratch space for the bytes so each key is read once. Returns false when the keys are all equal and
+      // there is nothing left to sort.
+      inline bool split(const key_batch& batch, uint32_t* indexes, uint32_t* temp, uint16_t* digits, size_t n,
+                        size_t& depth, bucket_counts& counts) {
+         depth += shared_prefix(batch, indexes, n, depth);
+         counts.fill(0);
+         for (size_t i = 0; i < n; ++i) ++counts[digits[i] = key_byte(batch, indexes[i], depth)];
+         if (counts[0] == n)
+            return false;
+         bucket_counts starts;
+         uint32_t      start = 0;
+         for (size_t b = 0; b < counts.size(); ++b) {
+            starts[b] = start;
+            start += counts[b];
+         }
+         for (size_t i = 0; i < n; ++i) temp[starts[digits[i]]++] = indexes[i];
+         std::copy(temp, temp + n, indexes);
+         return true;
+      }
+
+      // Splits along one path before the rest of a bucket is finished with a comparison sort
+      inline constexpr size_t max_levels = 32;
+
+      // The buckets still to be sorted are kept on an explicit stack, so keys which are prefixes of each other can't
+      // exhaust the call stack. A bucket which kept almost all the keys of its parent, or which is max_levels splits
+      // deep, is finished with a comparison sort, since splitting it further costs a pass over it per byte.
+      inline void sort(const key_batch& batch, uint32_t* indexes, uint32_t* temp, uint16_t* digits, size_t n,
+                       size_t depth) {
+         struct range {
+            size_t start;
+            size_t size;
+            size_t depth;
+            size_t levels;
+         };
+         std::vector<range> stack{ { 0, n, depth, 0 } };
+         bucket_counts      counts;
+         while (!stack.empty()) {
+            auto r = stack.back();
+            stack.pop_back();
+            if (r.size <= small_bucket || r.levels >= max_levels) {
+               comparison_sort(batch, indexes + r.start, r.size, r.depth);
+               continue;
+            }
+            if (!split(batch, indexes + r.start, temp + r.start, digits + r.start, r.size, r.depth, counts))
+               continue;
+            // bucket 0 holds the keys which ended, and those are equal
+            size_t start = r.start + counts[0];
+            for (size_t b = 1; b < counts.size(); ++b) {
+               if (counts[b] > r.size - r.size / 32)
+                  comparison_sort(batch, indexes + start, counts[b], r.depth + 1);
+               else if (counts[b] > 1)
+                  stack.push_back({ start, counts[b], r.depth + 1, r.levels + 1 });
+               start += counts[b];
+            }
+         }
+      }
+
+   } // namespace key_sort_detail
+
+   // The indexes of the keys of batch in key order, which is the order of the objects they were encoded from. Equal
+   // keys keep their original order.
+   //
+   // This is an MSD radix sort. The keys are split into buckets by their first byte that isn't shared by all of them,
+   // then the buckets are sorted, largest first, on up to num_threads threads. Each bucket is split by the next byte
+   // in turn until it is small enough for a comparison sort, or until splitting stops making progress.
+   inline std::vector<uint32_t> sort_keys(const key_batch& batch, uint32_t num_threads = 1) {
+      using namespace key_sort_detail;
+      check(batch.size() <= UINT32_MAX, "too many keys to sort");
+      uint32_t              n = batch.size();
+      std::vector<uint32_t> indexes(n), temp(n);
+      std::vector<uint16_t> digits(n);
+      std::iota(indexes.begin(), indexes.end(), 0);
+      if (num_threads <= 1 || n <= small_bucket) {
+         key_sort_detail::sort(batch, indexes.data(), temp.data(), digits.data(), n, 0);
+         return indexes;
+      }
+
+      size_t        depth = 0;
+      bucket_counts counts;
+      if (!split(batch, indexes.data(), temp.data(), digits.data(), n, depth, counts))
+         return indexes;
+      struct bucket {
+         uint32_t start;
+         uint32_t size;
+      };
+      std::vector<bucket> buckets;
+      uint32_t            start = counts[0];
+      for (size_t b = 1; b < counts.size(); ++b) {
+         if (counts[b] > 1)
+            buckets.push_back({ start, counts[b] });
+         start += counts[b];
+      }
+      std::sort(buckets.begin(), buckets.end(), [](auto& a, auto& b) { return a.size > b.size; });
+      std::atomic<size_t> next{ 0 };
+      parallel_for_ranges(0, num_threads, num_threads, [&](uint32_t, uint32_t) {
+         for (size_t i; (i = next++) < buckets.size();) {
+            auto& b = buckets[i];
+            key_sort_detail::sort(batch, indexes.data() + b.start, temp.data() + b.start, digits.data() + b.start,
+                                  b.size, depth + 1);
+         }
+      });
+      return indexes;
+   }
+
+} // namespace eosio
@@ -0,0 +1,173 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#   define EOSIO_TO_KEY_X86 1
+#   include <immintrin.h>
+#endif
+
+namespace eosio {
+
+   // Kernels which write the keys (to_key.hpp) of whole spans of numbers. Integers are stored big-endian with the sign
+   // bit flipped, floats have the bits of negative values inverted, and the escaped encoding of one-byte elements in
+   // vectors follows every 0 with a 1. The AVX2 versions do 32 bytes at a time and are used when the cpu has AVX2.
+   namespace to_key_detail {
+
+      template <typename U>
+      U byte_swap(U v) {
+         if constexpr (sizeof(U) == 1)
+            return v;
+         else if constexpr (sizeof(U) == 2)
+            return __builtin_bswap16(v);
+         else if constexpr (sizeof(U) == 4)
+            return __builtin_bswap32(v);
+         else
+            return __builtin_bswap64(v);
+      }
+
+      // The keys of n unsigned integers of the same size as the original integers; flip is the sign bit for signed
+      // types and 0 otherwise
+      template <typename U>
+      void integer_keys_portable(const U* src, size_t n, U flip, char* dest) {
+         for (size_t i = 0; i < n; ++i) {
+            U v = byte_swap(U(src[i] ^ flip));
+            memcpy(dest + i * sizeof(U), &v, sizeof(U));
+         }
+      }
+
+      // The keys of n floats or doubles given as their bits
+      template <typename U>
+      void float_keys_portable(const U* src, size_t n, char* dest) {
+         constexpr U signbit = U(1) << (sizeof(U) * 8 - 1);
+         for (size_t i = 0; i < n; ++i) {
+            U v = src[i] == signbit ? 0 : src[i];
+            v   = byte_swap(U(v ^ ((v & signbit) ? U(~U(0)) : signbit)));
+            memcpy(dest + i * sizeof(U), &v, sizeof(U));
+         }
+      }
+
+      // The escaped keys of n one-byte elements of a vector, without the terminator. dest must have room for 2 * n
+      // bytes; returns the number written.
+      inline size_t escaped_byte_keys_portable(const uint8_t* src, size_t n, uint8_t flip, char* dest) {
+         char* out = dest;
+         for (size_t i = 0; i < n; ++i) {
+            uint8_t b = src[i] ^ flip;
+            *out++    = b;
+            if (!b)
+               *out++ = 1;
+         }
+         return out - dest;
+      }
+
+#ifdef EOSIO_TO_KEY_X86
+      inline bool cpu_has_avx2() {
+         static const bool result = __builtin_cpu_supports("avx2");
+         return result;
+      }
+
+      // Reverses the bytes of each U within the 128-bit lanes
+      template <typename U>
+      __attribute__((target("avx2"))) __m256i byte_swap_control() {
+         alignas(32) int8_t control[32];
+         for (int i = 0; i < 32; ++i) control[i] = int8_t(i % 16 / sizeof(U) * sizeof(U) + sizeof(U) - 1 - i % sizeof(U));
+         return _mm256_load_si256(reinterpret_cast<const __m256i*>(control));
+      }
+
+      template <typename U>
+      __attribute__((target("avx2"))) __m256i broadcast(U v) {
+         alignas(32) U values[32 / sizeof(U)];
+         for (auto& x : values) x = v;
+         return _mm256_load_si256(reinterpret_cast<const __m256i*>(values));
+      }
+
+      template <typename U>
+      __attribute__((target("avx2"))) void integer_keys_avx2(const U* src, size_t n, U flip, char* dest) {
+         constexpr size_t per_vector = 32 / sizeof(U);
+         __m256i          control    = byte_swap_control<U>();
+         __m256i          flips      = broadcast(flip);
+         size_t           i          = 0;
+         for (; i + per_vector <= n; i += per_vector) {
+            __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+            v         = _mm256_shuffle_epi8(_mm256_xor_si256(v, flips), control);
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(dest + i * sizeof(U)), v);
+         }
+         integer_keys_portable(src + i, n - i, flip, dest + i * sizeof(U));
+      }
+
+      template <typename U>
+      __attribute__((target("avx2"))) void float_keys_avx2(const U* src, size_t n, char* dest) {
+         static_assert(sizeof(U) == 4 || sizeof(U) == 8);
+         constexpr size_t per_vector = 32 / sizeof(U);
+         __m256i          control    = byte_swap_control<U>();
+         __m256i          signbits   = broadcast(U(U(1) << (sizeof(U) * 8 - 1)));
+         size_t           i          = 0;
+         for (; i + per_vector <= n; i += per_vector) {
+            __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+            __m256i negative_zero, negative;
+            if constexpr (sizeof(U) == 4) {
+               negative_zero = _mm256_cmpeq_epi32(v, signbits);
+               negative      = _mm256_srai_epi32(v, 31);
+            } else {
+               negative_zero = _mm256_cmpeq_epi64(v, signbits);
+               negative      = _mm256_cmpgt_epi64(_mm256_setzero_si256(), v);
+            }
+            // -0 is stored as 0; negative values are inverted and the others get their sign bit set
+            v        = _mm256_andnot_si256(negative_zero, v);
+            negative = _mm256_andnot_si256(negative_zero, negative);
+            v        = _mm256_xor_si256(v, _mm256_or_si256(negative, signbits));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(dest + i * sizeof(U)), _mm256_shuffle_epi8(v, control));
+         }
+         float_keys_portable(src + i, n - i, dest + i * sizeof(U));
+      }
+
+      // Blocks of 32 bytes without a 0 are copied as they are; the rare blocks with one are escaped a byte at a time
+      __attribute__((target("avx2"))) inline size_t escaped_byte_keys_avx2(const uint8_t* src, size_t n, uint8_t flip,
+                                                                          char* dest) {
+         __m256i flips = _mm256_set1_epi8(char(flip));
+         char*   out   = dest;
+         size_t  i     = 0;
+         for (; i + 32 <= n; i += 32) {
+            __m256i v = _mm256_xor_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i)), flips);
+            if (_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, _mm256_setzero_si256()))) {
+               out += escaped_byte_keys_portable(src + i, 32, flip, out);
+            } else {
+               _mm256_storeu_si256(reinterpret_cast<__m256i*>(out), v);
+               out += 32;
+            }
+         }
+         return out - dest + escaped_byte_keys_portable(src + i, n - i, flip, out);
+      }
+#endif
+
+      template <typename U>
+      void integer_keys(const U* src, size_t n, U flip, char* dest) {
+#ifdef EOSIO_TO_KEY_X86
+         if (cpu_has_avx2())
+            return integer_keys_avx2(src, n, flip, dest);
+#endif
+         integer_keys_portable(src, n, flip, dest);
+      }
+
+      template <typename U>
+      void float_keys(const U* src, size_t n, char* dest) {
+#ifdef EOSIO_TO_KEY_X86
+         if (cpu_has_avx2())
+            return float_keys_avx2(src, n, dest);
+#endif
+         float_keys_portable(src, n, dest);
+      }
+
+      inline size_t escaped_byte_keys(const uint8_t* src, size_t n, uint8_t flip, char* dest) {
+#ifdef EOSIO_TO_KEY_X86
+         if (cpu_has_avx2())
+            return escaped_byte_keys_avx2(src, n, flip, dest);
+#endif
+         return escaped_byte_keys_portable(src, n, flip, dest);
+      }
+
+   } // namespace to_key_detail
+
+} // namespace eosio
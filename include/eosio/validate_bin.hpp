@@ -0,0 +1,154 @@
+#pragma once
+
+#include "for_each_field.hpp"
+#include "from_bin.hpp"
+#include "stream.hpp"
+#include "varint.hpp"
+
+#include <array>
+#include <optional>
+#include <string>
+#include <variant>
+#include <vector>
+
+namespace eosio {
+
+   // Non-throwing counterparts of the readers of from_bin.hpp, for paths where malformed input is common enough that
+   // unwinding exceptions would dominate the cost of rejecting it. They return stream_error::no_error or the error the
+   // throwing reader raises, and accept exactly what it accepts.
+
+   inline stream_error try_skip(input_stream& stream, uint64_t size) {
+      if (size > stream.remaining())
+         return stream_error::overrun;
+      stream.pos += size;
+      return stream_error::no_error;
+   }
+
+   template <typename UInt, int max_shift>
+   stream_error try_varuint_from_bin(UInt& dest, input_stream& stream) {
+      dest          = 0;
+      int     shift = 0;
+      uint8_t b     = 0;
+      do {
+         if (shift >= max_shift)
+            return stream_error::invalid_varuint_encoding;
+         if (stream.pos == stream.end)
+            return stream_error::overrun;
+         b = *stream.pos++;
+         dest |= UInt(b & 0x7f) << shift;
+         shift += 7;
+      } while (b & 0x80);
+      return stream_error::no_error;
+   }
+
+   inline stream_error try_varuint32_from_bin(uint32_t& dest, input_stream& stream) {
+      return try_varuint_from_bin<uint32_t, 35>(dest, stream);
+   }
+
+   inline stream_error try_varuint64_from_bin(uint64_t& dest, input_stream& stream) {
+      return try_varuint_from_bin<uint64_t, 70>(dest, stream);
+   }
+
+   // validate_bin((T*)nullptr, stream) steps over a serialized T, like skip_bin in lazy_vector.hpp, and returns the
+   // error from_bin would throw for it instead of throwing.
+   template <typename T>
+   stream_error validate_bin(T*, input_stream& stream);
+   inline stream_error validate_bin(varuint32*, input_stream& stream);
+   inline stream_error validate_bin(varint32*, input_stream& stream);
+   inline stream_error validate_bin(std::string*, input_stream& stream);
+   template <typename T>
+   stream_error validate_bin(std::vector<T>*, input_stream& stream);
+   template <typename T>
+   stream_error validate_bin(std::optional<T>*, input_stream& stream);
+   template <typename... Ts>
+   stream_error validate_bin(std::variant<Ts...>*, input_stream& stream);
+   template <typename T, std::size_t N>
+   stream_error validate_bin(std::array<T, N>*, input_stream& stream);
+
+   template <typename T>
+   stream_error validate_bin(T*, input_stream& stream) {
+      if constexpr (has_bitwise_serialization<T>()) {
+         return try_skip(stream, sizeof(T));
+      } else {
+         static_assert(reflection::has_for_each_field_v<T> && std::is_same_v<serialization_type<T>, void>,
+                       "validate_bin needs an overload for this type");
+         auto result = stream_error::no_error;
+         for_each_field<T>([&](const char*, auto member) {
+            if (result == stream_error::no_error)
+               result = validate_bin((std::decay_t<decltype(member((T*)nullptr))>*)nullptr, stream);
+         });
+         return result;
+      }
+   }
+
+   inline stream_error validate_bin(varuint32*, input_stream& stream) {
+      uint32_t v;
+      return try_varuint32_from_bin(v, stream);
+   }
+
+   inline stream_error validate_bin(varint32*, input_stream& stream) {
+      uint32_t v;
+      return try_varuint32_from_bin(v, stream);
+   }
+
+   inline stream_error validate_bin(std::string*, input_stream& stream) {
+      uint32_t size;
+      if (auto e = try_varuint32_from_bin(size, stream); e != stream_error::no_error)
+         return e;
+      return try_skip(stream, size);
+   }
+
+   template <typename T>
+   stream_error validate_bin(std::vector<T>*, input_stream& stream) {
+      if constexpr (has_bitwise_serialization<T>() && sizeof(size_t) >= 8) {
+         uint64_t size;
+         if (auto e = try_varuint64_from_bin(size, stream); e != stream_error::no_error)
+            return e;
+         if (size > stream.remaining() / sizeof(T))
+            return stream_error::overrun;
+         return try_skip(stream, size * sizeof(T));
+      } else {
+         uint32_t size;
+         if (auto e = try_varuint32_from_bin(size, stream); e != stream_error::no_error)
+            return e;
+         for (uint32_t i = 0; i < size; ++i)
+            if (auto e = validate_bin((T*)nullptr, stream); e != stream_error::no_error)
+               return e;
+         return stream_error::no_error;
+      }
+   }
+
+   template <typename T>
+   stream_error validate_bin(std::optional<T>*, input_stream& stream) {
+      if (stream.pos == stream.end)
+         return stream_error::overrun;
+      if (!*stream.pos++)
+         return stream_error::no_error;
+      return validate_bin((T*)nullptr, stream);
+   }
+
+   template <typename... Ts>
+   stream_error validate_bin(std::variant<Ts...>*, input_stream& stream) {
+      using validator                          = stream_error (*)(input_stream&);
+      static constexpr validator alternatives[] = { [](input_stream& s) { return validate_bin((Ts*)nullptr, s); }... };
+      uint32_t                   index;
+      if (auto e = try_varuint32_from_bin(index, stream); e != stream_error::no_error)
+         return e;
+      if (index >= sizeof...(Ts))
+         return stream_error::bad_variant_index;
+      return alternatives[index](stream);
+   }
+
+   template <typename T, std::size_t N>
+   stream_error validate_bin(std::array<T, N>*, input_stream& stream) {
+      if constexpr (has_bitwise_serialization<T>()) {
+         return try_skip(stream, N * sizeof(T));
+      } else {
+         for (std::size_t i = 0; i < N; ++i)
+            if (auto e = validate_bin((T*)nullptr, stream); e != stream_error::no_error)
+               return e;
+         return stream_error::no_error;
+      }
+   }
+
+} // namespace eosio
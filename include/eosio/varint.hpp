@@ -234,6 +234,8 @@ void to_key(const varuint32& obj, S& stream) {
    return to_key_varuint32(obj.value, stream);
 }
 
+constexpr size_t fixed_key_size(varuint32*) { return 0; }
+
 /**
  *  Variable Length Signed Integer. This provides more efficient serialization of 32-bit signed int.
  *  It serializes a 32-bit signed integer in as few bytes as possible.
@@ -449,4 +451,6 @@ void to_key(const varint32& obj, S& stream) {
    return to_key_varint32(obj.value, stream);
 }
 
+constexpr size_t fixed_key_size(varint32*) { return 0; }
+
 } // namespace eosio
@@ -0,0 +1,50 @@
+#pragma once
+
+#include "check.hpp"
+#include "stream.hpp"
+
+#include <zlib.h>
+
+#include <vector>
+
+namespace eosio {
+
+   // Decompresses zlib streams into a buffer that is reused from one call to the next. Keep one per thread.
+   class zlib_inflater {
+    public:
+      zlib_inflater() { check(inflateInit(&z) == Z_OK, "unable to initialize zlib"); }
+      zlib_inflater(const zlib_inflater&) = delete;
+      zlib_inflater& operator=(const zlib_inflater&) = delete;
+      ~zlib_inflater() { inflateEnd(&z); }
+
+      // Decompresses a complete zlib stream of at most max_size bytes. The result refers to the inflater's buffer, so it
+      // stays valid until the next call.
+      input_stream inflate(input_stream in, size_t max_size = SIZE_MAX) {
+         check(inflateReset(&z) == Z_OK, "unable to reset zlib");
+         z.next_in  = reinterpret_cast<Bytef*>(const_cast<char*>(in.pos));
+         z.avail_in = in.remaining();
+         if (out.size() < 2 * in.remaining() + 256)
+            out.resize(2 * in.remaining() + 256);
+         size_t size = 0;
+         for (;;) {
+            z.next_out  = reinterpret_cast<Bytef*>(out.data() + size);
+            z.avail_out = out.size() - size;
+            int result  = ::inflate(&z, Z_NO_FLUSH);
+            size        = out.size() - z.avail_out;
+            check(size <= max_size, "decompressed zlib data is too large");
+            if (result == Z_STREAM_END)
+               break;
+            check(result == Z_OK || result == Z_BUF_ERROR, "invalid zlib data");
+            check(z.avail_in || !z.avail_out, "truncated zlib data");
+            if (!z.avail_out)
+               out.resize(out.size() * 2);
+         }
+         return { out.data(), size };
+      }
+
+    private:
+      z_stream          z{};
+      std::vector<char> out;
+   };
+
+} // namespace eosio
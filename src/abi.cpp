@@ -6,8 +6,8 @@ using namespace eosio;
 namespace {
 
 template <int i>
-bool ends_with(const std::string& s, const char (&suffix)[i]) {
-    return s.size() >= i - 1 && !strcmp(s.c_str() + s.size() - (i - 1), suffix);
+bool ends_with(std::string_view s, const char (&suffix)[i]) {
+    return s.size() >= i - 1 && s.substr(s.size() - (i - 1)) == suffix;
 }
 
 template <typename T>
@@ -24,12 +24,32 @@ struct abi_serializer_impl : abi_serializer {
                              bool start) const override {
         return ::abieos::bin_to_json((T*)nullptr, state, allow_extensions, type, start);
     }
+    void json_to_bin(::abieos::bin_builder_state& state, bool allow_extensions, const abi_type* type,
+                             bool start) const override {
+        return ::abieos::json_to_bin((T*)nullptr, state, allow_extensions, type, start);
+    }
+    void skip_bin(eosio::input_stream& bin, bool allow_extensions, const abi_type* type, int depth) const override {
+        return ::abieos::skip_bin((T*)nullptr, bin, allow_extensions, type, depth);
+    }
+    void bin_to_key(eosio::input_stream& bin, eosio::vector_stream& writer, bool allow_extensions,
+                    const abi_type* type, int depth) const override {
+        return ::abieos::bin_to_key((T*)nullptr, bin, writer, allow_extensions, type, depth);
+    }
+    ::abieos::bin_error validate_bin(eosio::input_stream& bin, bool allow_extensions, const abi_type* type,
+                                     int depth) const override {
+        return ::abieos::validate_bin((T*)nullptr, bin, allow_extensions, type, depth);
+    }
+    void bin_to_value(eosio::input_stream& bin, ::abieos::bin_value& value, std::vector<char>& buffer) const override {
+        return ::abieos::bin_to_value((T*)nullptr, bin, value, buffer);
+    }
 };
 
 template <typename T>
 constexpr auto abi_serializer_for = abi_serializer_impl<T>{};
 
-abi_type::alias resolve(std::map<std::string, abi_type>& abi_types, const abi_type::alias_def* type, int depth);
+using abi_type_map = std::map<std::string, abi_type, std::less<>>;
+
+abi_type::alias resolve(abi_type_map& abi_types, const abi_type::alias_def* type, int depth);
 
 template<typename... T, typename... A>
 bool holds_any_alternative(const std::variant<A...>& v) {
@@ -43,35 +63,69 @@ constexpr void for_each_abi_type(F f) {
     std::apply([&f](auto&& ...t) { (f(&t), ...); }, basic_abi_types{});
 }
 
-abi_type* get_type(std::map<std::string, abi_type>& abi_types, const std::string& name, int depth) {
+const abi_serializer* builtin_serializer(std::string_view name) {
+    static const auto serializers = [] {
+        std::unordered_map<std::string_view, const abi_serializer*> result;
+        for_each_abi_type([&](auto* p) {
+            result.emplace(get_type_name(p), &abi_serializer_for<std::decay_t<decltype(*p)>>);
+        });
+        return result;
+    }();
+    auto it = serializers.find(name);
+    return it == serializers.end() ? nullptr : it->second;
+}
+
+bool is_builtin(std::string_view name) { return name == "extended_asset" || builtin_serializer(name); }
+
+// Adds the builtin type name, or returns null if there isn't one. convert adds all of them up front; convert_lazy
+// leaves them to get_type.
+abi_type* add_builtin(abi_type_map& abi_types, std::string_view name) {
+    if (name == "extended_asset") {
+        auto* quantity = add_builtin(abi_types, "asset");
+        auto* contract = add_builtin(abi_types, "name");
+        return &abi_types
+                    .try_emplace(std::string{name}, std::string{name},
+                                 abi_type::struct_{nullptr, {{"quantity", quantity}, {"contract", contract}}},
+                                 &abi_serializer_for<::abieos::pseudo_object>)
+                    .first->second;
+    }
+    auto* ser = builtin_serializer(name);
+    if (!ser)
+        return nullptr;
+    return &abi_types.try_emplace(std::string{name}, std::string{name}, abi_type::builtin{}, ser).first->second;
+}
+
+abi_type* get_type(abi_type_map& abi_types, std::string_view name, int depth) {
     eosio::check(depth < 32, eosio::convert_abi_error(abi_error::recursion_limit_reached));
     auto it = abi_types.find(name);
     if (it == abi_types.end()) {
-        if (ends_with(name, "?")) {
+        if (auto* builtin = add_builtin(abi_types, name)) {
+            return builtin;
+        } else if (ends_with(name, "?")) {
             auto base = get_type(abi_types, name.substr(0, name.size() - 1), depth + 1);
             // removed abi_type::array from invalid types for nesting, optional array should work
             eosio::check(
                 !holds_any_alternative<abi_type::optional, abi_type::extension>(base->_data),
-                "Invalid optional nesting for type: " + name
+                "Invalid optional nesting for type: " + std::string{name}
             );
-            auto [iter, success] = abi_types.try_emplace(name, name, abi_type::optional{base}, &abi_serializer_for< ::abieos::pseudo_optional>);
+            auto [iter, success] = abi_types.try_emplace(std::string{name}, std::string{name}, abi_type::optional{base}, &abi_serializer_for< ::abieos::pseudo_optional>);
             return &iter->second;
         } else if (ends_with(name, "[]")) {
             auto element = get_type(abi_types, name.substr(0, name.size() - 2), depth + 1);
             // removed abi_type::array from invalid types for nesting, array of arrays should work
             eosio::check(
                 !holds_any_alternative<abi_type::optional, abi_type::extension>(element->_data),
-                "Invalid array nesting for type: " + name
+                "Invalid array nesting for type: " + std::string{name}
             );
-            auto [iter, success] = abi_types.try_emplace(name, name, abi_type::array{element}, &abi_serializer_for< ::abieos::pseudo_array>);
+            auto [iter, success] = abi_types.try_emplace(std::string{name}, std::string{name}, abi_type::array{element}, &abi_serializer_for< ::abieos::pseudo_array>);
             return &iter->second;
         } else if (ends_with(name, "$")) {
             auto base = get_type(abi_types, name.substr(0, name.size() - 1), depth + 1);
             eosio::check(
                 !std::holds_alternative<abi_type::extension>(base->_data),
-                "Invalid extension nesting for type: " + name
+                "Invalid extension nesting for type: " + std::string{name}
             );
-            auto [iter, success] = abi_types.try_emplace(name, name, abi_type::extension{base}, &abi_serializer_for< ::abieos::pseudo_extension>);
+            auto [iter, success] = abi_types.try_emplace(std::string{name}, std::string{name}, abi_type::extension{base}, &abi_serializer_for< ::abieos::pseudo_extension>);
             return &iter->second;
         } else
            eosio::check(false, eosio::convert_abi_error(abi_error::unknown_type));
@@ -89,14 +143,14 @@ abi_type* get_type(std::map<std::string, abi_type>& abi_types, const std::string
     return &it->second;
 }
 
-abi_type::struct_ resolve(std::map<std::string, abi_type>& abi_types, const struct_def* type, int depth) {
+abi_type::struct_ resolve(abi_type_map& abi_types, const struct_def_view* type, int depth) {
    eosio::check(depth < 32,
         eosio::convert_abi_error(abi_error::recursion_limit_reached));
     abi_type::struct_ result;
     if (!type->base.empty()) {
         auto base = get_type(abi_types, type->base, depth + 1);
 
-        if(auto* base_def = std::get_if<const struct_def*>(&base->_data)) {
+        if(auto* base_def = std::get_if<const struct_def_view*>(&base->_data)) {
             auto b = resolve(abi_types, *base_def, depth + 1);
             base->_data = std::move(b);
         }
@@ -108,24 +162,24 @@ abi_type::struct_ resolve(std::map<std::string, abi_type>& abi_types, const stru
     }
     for (auto& field : type->fields) {
         auto t = get_type(abi_types, field.type, depth + 1);
-        result.fields.push_back(abi_field{field.name, t});
+        result.fields.push_back(abi_field{std::string{field.name}, t});
     }
     return result;
 }
 
 
-abi_type::variant resolve(std::map<std::string, abi_type>& abi_types, const variant_def* type, int depth) {
+abi_type::variant resolve(abi_type_map& abi_types, const variant_def_view* type, int depth) {
    eosio::check(depth < 32,
         eosio::convert_abi_error(abi_error::recursion_limit_reached));
     abi_type::variant result;
-    for (const std::string& field : type->types) {
+    for (auto field : type->types) {
         auto t = get_type(abi_types, field, depth + 1);
-        result.push_back({field, t});
+        result.push_back({std::string{field}, t});
     }
     return result;
 }
 
-abi_type::alias resolve(std::map<std::string, abi_type>& abi_types, const abi_type::alias_def* type, int depth) {
+abi_type::alias resolve(abi_type_map& abi_types, const abi_type::alias_def* type, int depth) {
     auto t = get_type(abi_types, *type, depth + 1);
     eosio::check(!std::holds_alternative<abi_type::extension>(t->_data),
         eosio::convert_abi_error(abi_error::extension_typedef));
@@ -133,7 +187,7 @@ abi_type::alias resolve(std::map<std::string, abi_type>& abi_types, const abi_ty
 }
 
 struct fill_t {
-   std::map<std::string, abi_type>& abi_types;
+   abi_type_map& abi_types;
    abi_type& type;
    int depth;
    template<typename T>
@@ -146,24 +200,187 @@ struct fill_t {
    }
 };
 
-void fill(std::map<std::string, abi_type>& abi_types, abi_type& type, int depth) {
+void fill(abi_type_map& abi_types, abi_type& type, int depth) {
    return std::visit(fill_t{abi_types, type, depth}, type._data);
 }
 
+// Resolves t and the types it refers to, directly or not, unless they are in resolved already
+void fill_reachable(abi_type_map& abi_types, abi_type* t,
+                    std::unordered_set<const abi_type*>& resolved) {
+    std::vector<abi_type*> pending{t};
+    std::unordered_set<const abi_type*> seen;
+    while (!pending.empty()) {
+        auto* type = pending.back();
+        pending.pop_back();
+        if (resolved.count(type) || !seen.insert(type).second)
+            continue;
+        fill(abi_types, *type, 0);
+        std::visit(
+            [&](auto& data) {
+                using T = std::decay_t<decltype(data)>;
+                if constexpr (std::is_same_v<T, abi_type::struct_> || std::is_same_v<T, abi_type::variant>) {
+                    const std::vector<abi_field>* fields;
+                    if constexpr (std::is_same_v<T, abi_type::struct_>)
+                        fields = &data.fields;
+                    else
+                        fields = &data;
+                    // abi_types owns the fields' types, so they may be resolved too
+                    for (auto& field : *fields)
+                        pending.push_back(const_cast<abi_type*>(field.type));
+                } else if constexpr (std::is_same_v<T, abi_type::alias> || std::is_same_v<T, abi_type::optional> ||
+                                     std::is_same_v<T, abi_type::extension> || std::is_same_v<T, abi_type::array>) {
+                    pending.push_back(data.type);
+                }
+            },
+            type->_data);
+    }
+    resolved.insert(seen.begin(), seen.end());
 }
 
-
-const abi_type* eosio::abi::get_type(const std::string& name) {
-   return ::get_type(abi_types, name, 0);
-}
-
-void eosio::convert(const abi_def& abi, eosio::abi& c) {
+void add_names(const abi_def_view& abi, eosio::abi& c) {
     for (auto& a : abi.actions)
         c.action_types[a.name] = a.type;
     for (auto& t : abi.tables)
         c.table_types[t.name] = t.type;
-    for (auto& r : abi.action_results.value)
+    for (auto& r : abi.action_results)
         c.action_result_types[r.name] = r.result_type;
+}
+
+// Registers the types, structs and variants of abi without resolving them
+void add_definitions(const abi_def_view& abi, eosio::abi& c) {
+    auto add = [&](std::string_view name, auto* definition, const abi_serializer* ser) {
+        eosio::check(!name.empty(), eosio::convert_abi_error(abi_error::missing_name));
+        eosio::check(!is_builtin(name), eosio::convert_abi_error(abi_error::redefined_type));
+        auto [_, inserted] = c.abi_types.try_emplace(std::string{name}, std::string{name}, definition, ser);
+        eosio::check(inserted, eosio::convert_abi_error(abi_error::redefined_type));
+    };
+    for (auto& t : abi.types)
+        add(t.new_type_name, &t.type, nullptr);
+    for (auto& s : abi.structs)
+        add(s.name, &s, &abi_serializer_for<::abieos::pseudo_object>);
+    for (auto& v : abi.variants)
+        add(v.name, &v, &abi_serializer_for<::abieos::pseudo_variant>);
+}
+
+}
+
+
+const abi_type* eosio::abi::get_type(const std::string& name) {
+   if (!lazy)
+      return ::get_type(abi_types, name, 0);
+   std::lock_guard<std::mutex> lock{ lazy->mutex };
+   auto*                       t = ::get_type(abi_types, name, 0);
+   if (!lazy->resolved.count(t))
+      fill_reachable(abi_types, t, lazy->resolved);
+   return t;
+}
+
+uint32_t eosio::compiled_abi::intern(const std::string& name) {
+   auto [it, inserted] = interned.try_emplace(name, names.size());
+   if (inserted)
+      names += name;
+   return it->second;
+}
+
+uint32_t eosio::compiled_abi::index_of(const abi_type* t) {
+   {
+      std::shared_lock<std::shared_mutex> lock{ *mutex };
+      if (auto it = indexes.find(t); it != indexes.end())
+         return it->second;
+   }
+   std::lock_guard<std::shared_mutex> lock{ *mutex };
+   if (auto it = indexes.find(t); it != indexes.end())
+      return it->second;
+
+   // Types get their index when they are first seen and are filled in from the queue afterwards, so that the fields of
+   // each struct and variant are appended together
+   size_t                       old_types = types.size(), old_fields = fields.size();
+   std::vector<const abi_type*> queue;
+   auto                         add = [&](const abi_type* t) {
+      while (auto* a = std::get_if<abi_type::alias>(&t->_data)) t = a->type;
+      auto [it, inserted] = indexes.try_emplace(t, uint32_t(types.size()));
+      if (inserted) {
+         types.push_back({ t, 0, 0, builtin });
+         queue.push_back(t);
+      }
+      return it->second;
+   };
+   std::vector<char> json;
+   auto              add_field = [&](const abi_field& f, char separator) {
+      json.clear();
+      vector_stream stream{ json };
+      to_json(f.name, stream);
+      json.push_back(separator);
+      auto type = add(f.type);
+      auto name = intern({ json.data(), json.size() });
+      fields.push_back({ name, uint32_t(json.size()), type });
+   };
+
+   try {
+      auto result = add(t);
+      for (size_t i = 0; i < queue.size(); ++i) {
+         auto*    src   = queue[i];
+         uint32_t index = indexes[src];
+         if (auto* o = src->optional_of()) {
+            auto of = add(o);
+            types[index] = { src, of, 0, optional };
+         } else if (auto* e = src->extension_of()) {
+            auto of = add(e);
+            types[index] = { src, of, 0, extension };
+         } else if (auto* a = src->array_of()) {
+            auto of = add(a);
+            types[index] = { src, of, 0, array };
+         } else if (auto* s = src->as_struct()) {
+            uint32_t first = fields.size();
+            for (auto& f : s->fields) add_field(f, ':');
+            types[index] = { src, first, uint32_t(s->fields.size()), object };
+         } else if (auto* v = src->as_variant()) {
+            uint32_t first = fields.size();
+            for (auto& f : *v) add_field(f, ',');
+            types[index] = { src, first, uint32_t(v->size()), variant };
+         } else {
+            check(std::holds_alternative<abi_type::builtin>(src->_data), convert_abi_error(abi_error::bad_abi));
+         }
+      }
+      indexes.try_emplace(t, result);
+      return result;
+   } catch (...) {
+      for (size_t i = old_types; i < types.size(); ++i) indexes.erase(types[i].source);
+      indexes.erase(t);
+      types.resize(old_types);
+      fields.resize(old_fields);
+      throw;
+   }
+}
+
+void eosio::convert(const abi_def& def, abi_def_view& view) {
+    view.version = def.version;
+    for (auto& t : def.types)
+        view.types.push_back({t.new_type_name, t.type});
+    for (auto& s : def.structs) {
+        auto& fields = view.structs.emplace_back(struct_def_view{s.name, s.base}).fields;
+        for (auto& f : s.fields)
+            fields.push_back({f.name, f.type});
+    }
+    for (auto& a : def.actions)
+        view.actions.push_back({a.name, a.type});
+    for (auto& t : def.tables)
+        view.tables.push_back({t.name, t.index_type, {t.key_names.begin(), t.key_names.end()},
+                               {t.key_types.begin(), t.key_types.end()}, t.type});
+    for (auto& v : def.variants.value)
+        view.variants.push_back({v.name, {v.types.begin(), v.types.end()}});
+    for (auto& r : def.action_results.value)
+        view.action_results.push_back({r.name, r.result_type});
+}
+
+void eosio::convert(const abi_def& def, eosio::abi& c) {
+    abi_def_view view;
+    convert(def, view);
+    convert(view, c);
+}
+
+void eosio::convert(const abi_def_view& abi, eosio::abi& c) {
+    add_names(abi, c);
     for_each_abi_type([&](auto* p) {
         const char* name = get_type_name(p);
         c.abi_types.try_emplace(name, name, abi_type::builtin{}, &abi_serializer_for<std::decay_t<decltype(*p)>>);
@@ -175,40 +392,44 @@ void eosio::convert(const abi_def& abi, eosio::abi& c) {
                                 &abi_serializer_for<::abieos::pseudo_object>);
     }
 
-    for (auto& t : abi.types) {
-       eosio::check(!t.new_type_name.empty(),
-            eosio::convert_abi_error(abi_error::missing_name));
-        auto [_, inserted] = c.abi_types.try_emplace(t.new_type_name, t.new_type_name, &t.type, nullptr);
-        eosio::check(inserted,
-            eosio::convert_abi_error(abi_error::redefined_type));
-    }
-    for (auto& s : abi.structs) {
-       eosio::check(!s.name.empty(),
-            eosio::convert_abi_error(abi_error::missing_name));
-        auto [it, inserted] = c.abi_types.try_emplace(s.name, s.name, &s, &abi_serializer_for<::abieos::pseudo_object>);
-        eosio::check(inserted,
-            eosio::convert_abi_error(abi_error::redefined_type));
-    }
-    for (auto& v : abi.variants.value) {
-       eosio::check(!v.name.empty(),
-            eosio::convert_abi_error(abi_error::missing_name));
-        auto [it, inserted] = c.abi_types.try_emplace(v.name, v.name, &v, &abi_serializer_for<::abieos::pseudo_variant>);
-        eosio::check(inserted,
-            eosio::convert_abi_error(abi_error::redefined_type));
-    }
+    add_definitions(abi, c);
     for (auto& [_, t] : c.abi_types) {
         fill(c.abi_types, t, 0);
     }
 }
 
+void eosio::convert_lazy(abi_def&& def, eosio::abi& c) {
+    c.lazy = std::make_unique<lazy_abi_def>();
+    c.lazy->def = std::move(def);
+    convert(c.lazy->def, c.lazy->view);
+    add_names(c.lazy->view, c);
+    add_definitions(c.lazy->view, c);
+}
+
+void eosio::convert_lazy(std::vector<char>&& bin, abi_def_view&& def, eosio::abi& c) {
+    c.lazy = std::make_unique<lazy_abi_def>();
+    c.lazy->bin = std::move(bin);
+    c.lazy->view = std::move(def);
+    add_names(c.lazy->view, c);
+    add_definitions(c.lazy->view, c);
+}
+
 void to_abi_def(abi_def& def, const std::string& name, const abi_type::builtin&) {}
 void to_abi_def(abi_def& def, const std::string& name, const abi_type::optional&) {}
 void to_abi_def(abi_def& def, const std::string& name, const abi_type::array&) {}
 void to_abi_def(abi_def& def, const std::string& name, const abi_type::extension&) {}
 
-template<typename T>
-void to_abi_def(abi_def& def, const std::string& name, const T*) {
-   eosio::check(false, eosio::convert_abi_error(eosio::abi_error::bad_abi));
+// Types of a lazily converted abi which haven't been used are still in their original form
+void to_abi_def(abi_def& def, const std::string& name, const abi_type::alias_def* alias) {
+   def.types.push_back({name, std::string{*alias}});
+}
+void to_abi_def(abi_def& def, const std::string& name, const struct_def_view* struct_) {
+   std::vector<field_def> fields;
+   for (auto& f : struct_->fields) fields.push_back({std::string{f.name}, std::string{f.type}});
+   def.structs.push_back({name, std::string{struct_->base}, std::move(fields)});
+}
+void to_abi_def(abi_def& def, const std::string& name, const variant_def_view* variant) {
+   def.variants.value.push_back({name, {variant->types.begin(), variant->types.end()}});
 }
 
 void to_abi_def(abi_def& def, const std::string& name, const abi_type::alias& alias) {
@@ -2,6 +2,10 @@
 
 #include "abieos.h"
 #include "abieos.hpp"
+#include "abieos_compact.hpp"
+#include "abieos_json_cache.hpp"
+#include "abieos_stats.hpp"
+#include "abieos_view.hpp"
 
 #include <memory>
 
@@ -12,8 +16,13 @@ struct abieos_context_s {
     std::string last_error_buffer{};
     std::string result_str{};
     std::vector<char> result_bin{};
+    conversion_scratch scratch{};
+    stats_registry stats{};
+    bin_to_json_cache json_cache{};
+    bool lazy_abis = false;
 
     std::map<name, abi> contracts{};
+    std::unique_ptr<bin_builder_state> builder{};
 };
 
 void fix_null_str(const char*& s) {
@@ -102,7 +111,10 @@ extern "C" abieos_bool abieos_set_abi(abieos_context* context, uint64_t contract
         if (!check_abi_version(def.version, error))
             return set_error(context, std::move(error));
         abieos::abi c;
-        convert(def, c);
+        if (context->lazy_abis)
+            convert_lazy(std::move(def), c);
+        else
+            convert(def, c);
         context->contracts.insert({name{contract}, std::move(c)});
         return true;
     });
@@ -114,16 +126,22 @@ extern "C" abieos_bool abieos_set_abi_bin(abieos_context* context, uint64_t cont
         if (!data || !size)
             return set_error(context, "no data");
         std::string error;
+        // A lazily converted abi refers to its definitions, so it keeps a copy
+        std::vector<char> bin;
+        if (context->lazy_abis) {
+            bin.assign(data, data + size);
+            data = bin.data();
+        }
         eosio::input_stream stream{data, size};
-        std::string version;
-        from_bin(version, stream);
-        if (!check_abi_version(version, error))
-            return set_error(context, std::move(error));
-        abi_def def{};
-        stream = {data, size};
+        abi_def_view def{};
         from_bin(def, stream);
+        if (!check_abi_version(def.version, error))
+            return set_error(context, std::move(error));
         abieos::abi c;
-        convert(def, c);
+        if (context->lazy_abis)
+            convert_lazy(std::move(bin), std::move(def), c);
+        else
+            convert(def, c);
         context->contracts.insert({name{contract}, std::move(c)});
         return true;
     });
@@ -143,6 +161,13 @@ extern "C" abieos_bool abieos_set_abi_hex(abieos_context* context, uint64_t cont
     });
 }
 
+extern "C" abieos_bool abieos_set_lazy_abis(abieos_context* context, abieos_bool lazy) {
+    return handle_exceptions(context, false, [&] {
+        context->lazy_abis = lazy;
+        return true;
+    });
+}
+
 extern "C" const char* abieos_get_type_for_action(abieos_context* context, uint64_t contract, uint64_t action) {
     return handle_exceptions(context, nullptr, [&] {
         auto contract_it = context->contracts.find(::abieos::name{contract});
@@ -194,14 +219,17 @@ extern "C" abieos_bool abieos_json_to_bin(abieos_context* context, uint64_t cont
     fix_null_str(type);
     fix_null_str(json);
     return handle_exceptions(context, false, [&] {
+        stats_scope stats{context->stats, stats_operation::json_to_bin, contract, strlen(json)};
         context->last_error = "json parse error";
         auto contract_it = context->contracts.find(::abieos::name{contract});
         if (contract_it == context->contracts.end())
             return set_error(context, "contract \"" + eosio::name_to_string(contract) + "\" is not loaded");
         std::string error;
         auto t = contract_it->second.get_type(type);
+        stats.set_type(t);
         context->result_bin.clear();
-        context->result_bin = t->json_to_bin(json);
+        ::abieos::json_to_bin(context->result_bin, t, json, [] {}, context->scratch);
+        stats.succeeded(context->result_bin.size());
         return true;
     });
 }
@@ -211,14 +239,17 @@ extern "C" abieos_bool abieos_json_to_bin_reorderable(abieos_context* context, u
     fix_null_str(type);
     fix_null_str(json);
     return handle_exceptions(context, false, [&] {
+        stats_scope stats{context->stats, stats_operation::json_to_bin, contract, strlen(json)};
         context->last_error = "json parse error";
         auto contract_it = context->contracts.find(::abieos::name{contract});
         if (contract_it == context->contracts.end())
             return set_error(context, "contract \"" + eosio::name_to_string(contract) + "\" is not loaded");
         std::string error;
         auto t = contract_it->second.get_type(type);
+        stats.set_type(t);
         context->result_bin.clear();
         context->result_bin = t->json_to_bin_reorderable(json);
+        stats.succeeded(context->result_bin.size());
         return true;
     });
 }
@@ -229,6 +260,7 @@ extern "C" const char* abieos_bin_to_json(abieos_context* context, uint64_t cont
     return handle_exceptions(context, nullptr, [&]() -> const char* {
         if (!data)
             size = 0;
+        stats_scope stats{context->stats, stats_operation::bin_to_json, contract, size};
         context->last_error = "binary decode error";
         auto contract_it = context->contracts.find(::abieos::name{contract});
         std::string error;
@@ -237,8 +269,22 @@ extern "C" const char* abieos_bin_to_json(abieos_context* context, uint64_t cont
             return nullptr;
         }
         auto t = contract_it->second.get_type(type);
+        stats.set_type(t);
+        auto& cache = context->json_cache;
+        uint64_t hash = 0;
+        if (cache.enabled()) {
+            hash = cache.key_hash(name{contract}, t, {data, size});
+            if (cache.find(hash, name{contract}, t, {data, size}, context->result_str)) {
+                stats.succeeded(context->result_str.size());
+                return context->result_str.c_str();
+            }
+        }
+        auto index = contract_it->second.compiled.index_of(t);
         eosio::input_stream bin{data, size};
-        context->result_str = t->bin_to_json(bin);
+        ::abieos::bin_to_json(bin, contract_it->second.compiled, index, context->result_str, context->scratch);
+        if (cache.enabled())
+            cache.insert(hash, name{contract}, t, {data, size}, context->result_str);
+        stats.succeeded(context->result_str.size());
         return context->result_str.c_str();
     });
 }
@@ -247,7 +293,8 @@ extern "C" const char* abieos_hex_to_json(abieos_context* context, uint64_t cont
                                           const char* hex) {
     fix_null_str(hex);
     return handle_exceptions(context, nullptr, [&]() -> const char* {
-        std::vector<char> data;
+        auto& data = context->scratch.hex_data;
+        data.clear();
         std::string error;
         if (!unhex(error, hex, hex + strlen(hex), std::back_inserter(data))) {
             if (!error.empty())
@@ -304,6 +351,346 @@ extern "C" abieos_bool abieos_delete_contract(abieos_context* context, uint64_t
         return false;
     } else {
         context->contracts.erase(itr);
+        context->stats.forget_types();
+        context->json_cache.clear();
         return true;
     }
 }
+
+// A failed builder call leaves the partial output in an unknown state, so it is discarded
+template <typename F>
+abieos_bool handle_builder(abieos_context* context, F f) noexcept {
+    auto ok = handle_exceptions(context, false, [&] {
+        if (!context->builder)
+            return set_error(context, "no builder in progress");
+        f(*context->builder);
+        return true;
+    });
+    if (!ok && context)
+        context->builder.reset();
+    return ok;
+}
+
+template <typename F>
+abieos_bool builder_push(abieos_context* context, builder_value_kind kind, F set_value) noexcept {
+    return handle_builder(context, [&](bin_builder_state& state) {
+        state.kind = kind;
+        set_value(state);
+        bin_builder_push(state);
+    });
+}
+
+extern "C" abieos_bool abieos_builder_begin(abieos_context* context, uint64_t contract, const char* type) {
+    fix_null_str(type);
+    return handle_exceptions(context, false, [&] {
+        context->builder.reset();
+        auto contract_it = context->contracts.find(::abieos::name{contract});
+        if (contract_it == context->contracts.end())
+            return set_error(context, "contract \"" + eosio::name_to_string(contract) + "\" is not loaded");
+        context->builder = std::make_unique<bin_builder_state>(contract_it->second.get_type(type));
+        return true;
+    });
+}
+
+extern "C" abieos_bool abieos_builder_begin_struct(abieos_context* context) {
+    return handle_builder(context, [](bin_builder_state& state) { bin_builder_begin_struct(state); });
+}
+
+extern "C" abieos_bool abieos_builder_end_struct(abieos_context* context) {
+    return handle_builder(context, [](bin_builder_state& state) { bin_builder_end_struct(state); });
+}
+
+extern "C" abieos_bool abieos_builder_begin_array(abieos_context* context) {
+    return handle_builder(context, [](bin_builder_state& state) { bin_builder_begin_array(state); });
+}
+
+extern "C" abieos_bool abieos_builder_end_array(abieos_context* context) {
+    return handle_builder(context, [](bin_builder_state& state) { bin_builder_end_array(state); });
+}
+
+extern "C" abieos_bool abieos_builder_begin_variant(abieos_context* context, const char* alternative) {
+    fix_null_str(alternative);
+    return handle_builder(context, [&](bin_builder_state& state) { bin_builder_begin_variant(state, alternative); });
+}
+
+extern "C" abieos_bool abieos_builder_end_variant(abieos_context* context) {
+    return handle_builder(context, [](bin_builder_state& state) { bin_builder_end_variant(state); });
+}
+
+extern "C" abieos_bool abieos_builder_push_null(abieos_context* context) {
+    return builder_push(context, builder_value_kind::null, [](bin_builder_state&) {});
+}
+
+extern "C" abieos_bool abieos_builder_push_bool(abieos_context* context, abieos_bool value) {
+    return builder_push(context, builder_value_kind::boolean,
+                        [&](bin_builder_state& state) { state.value_bool = value; });
+}
+
+extern "C" abieos_bool abieos_builder_push_int64(abieos_context* context, int64_t value) {
+    return builder_push(context, builder_value_kind::int64,
+                        [&](bin_builder_state& state) { state.value_int64 = value; });
+}
+
+extern "C" abieos_bool abieos_builder_push_uint64(abieos_context* context, uint64_t value) {
+    return builder_push(context, builder_value_kind::uint64,
+                        [&](bin_builder_state& state) { state.value_uint64 = value; });
+}
+
+extern "C" abieos_bool abieos_builder_push_double(abieos_context* context, double value) {
+    return builder_push(context, builder_value_kind::float64,
+                        [&](bin_builder_state& state) { state.value_double = value; });
+}
+
+extern "C" abieos_bool abieos_builder_push_name(abieos_context* context, uint64_t value) {
+    return builder_push(context, builder_value_kind::name,
+                        [&](bin_builder_state& state) { state.value_uint64 = value; });
+}
+
+extern "C" abieos_bool abieos_builder_push_string(abieos_context* context, const char* data, size_t size) {
+    if (!data)
+        size = 0;
+    return builder_push(context, builder_value_kind::string,
+                        [&](bin_builder_state& state) { state.value_string = {data, size}; });
+}
+
+extern "C" abieos_bool abieos_builder_push_bytes(abieos_context* context, const char* data, size_t size) {
+    if (!data)
+        size = 0;
+    return builder_push(context, builder_value_kind::bytes,
+                        [&](bin_builder_state& state) { state.value_string = {data, size}; });
+}
+
+extern "C" abieos_bool abieos_builder_finish(abieos_context* context) {
+    return handle_builder(context, [&](bin_builder_state& state) {
+        context->result_bin.clear();
+        bin_builder_finish(state, context->result_bin);
+        context->builder.reset();
+    });
+}
+
+namespace {
+
+// Forwards bin_visitor events to the C callbacks; a null callback accepts the event
+struct c_bin_visitor final : bin_visitor {
+    const abieos_visitor& callbacks;
+    void* user;
+
+    c_bin_visitor(const abieos_visitor& callbacks, void* user) : callbacks{callbacks}, user{user} {}
+
+    template <typename F, typename... A>
+    bool call(F* f, A... a) {
+        return !f || f(user, a...);
+    }
+
+    bool null() override { return call(callbacks.null_value); }
+    bool boolean(bool value) override { return call(callbacks.bool_value, abieos_bool(value)); }
+    bool int64(int64_t value) override { return call(callbacks.int64_value, value); }
+    bool uint64(uint64_t value) override { return call(callbacks.uint64_value, value); }
+    bool float64(double value) override { return call(callbacks.double_value, value); }
+    bool name(uint64_t value) override { return call(callbacks.name_value, value); }
+    bool string(std::string_view value) override { return call(callbacks.string_value, value.data(), value.size()); }
+    bool bytes(std::string_view value) override { return call(callbacks.bytes_value, value.data(), value.size()); }
+    bool start_object() override { return call(callbacks.start_object); }
+    bool key(std::string_view key) override { return call(callbacks.key, key.data(), key.size()); }
+    bool end_object() override { return call(callbacks.end_object); }
+    bool start_array(uint32_t size) override { return call(callbacks.start_array, size); }
+    bool end_array() override { return call(callbacks.end_array); }
+    bool start_variant(std::string_view alternative) override {
+        return call(callbacks.start_variant, alternative.data(), alternative.size());
+    }
+    bool end_variant() override { return call(callbacks.end_variant); }
+};
+
+} // namespace
+
+extern "C" abieos_bool abieos_bin_to_visitor(abieos_context* context, uint64_t contract, const char* type,
+                                             const char* data, size_t size, const abieos_visitor* visitor,
+                                             void* user) {
+    fix_null_str(type);
+    return handle_exceptions(context, false, [&] {
+        if (!data)
+            size = 0;
+        stats_scope stats{context->stats, stats_operation::bin_to_visitor, contract, size};
+        if (!visitor)
+            return set_error(context, "visitor is null");
+        auto contract_it = context->contracts.find(::abieos::name{contract});
+        if (contract_it == context->contracts.end())
+            return set_error(context, "contract \"" + eosio::name_to_string(contract) + "\" is not loaded");
+        auto t = contract_it->second.get_type(type);
+        stats.set_type(t);
+        eosio::input_stream bin{data, size};
+        c_bin_visitor v{*visitor, user};
+        bin_to_visitor(bin, t, v);
+        stats.succeeded(0);
+        return true;
+    });
+}
+
+template <typename F>
+abieos_bool bin_to_compact(abieos_context* context, stats_operation op, uint64_t contract, const char* type,
+                           const char* data, size_t size, F convert) noexcept {
+    fix_null_str(type);
+    return handle_exceptions(context, false, [&] {
+        if (!data)
+            size = 0;
+        stats_scope stats{context->stats, op, contract, size};
+        auto contract_it = context->contracts.find(::abieos::name{contract});
+        if (contract_it == context->contracts.end())
+            return set_error(context, "contract \"" + eosio::name_to_string(contract) + "\" is not loaded");
+        auto t = contract_it->second.get_type(type);
+        stats.set_type(t);
+        eosio::input_stream bin{data, size};
+        context->result_bin.clear();
+        convert(bin, t, context->result_bin);
+        stats.succeeded(context->result_bin.size());
+        return true;
+    });
+}
+
+extern "C" abieos_bool abieos_bin_to_cbor(abieos_context* context, uint64_t contract, const char* type,
+                                          const char* data, size_t size, abieos_bool names_as_strings) {
+    return bin_to_compact(context, stats_operation::bin_to_cbor, contract, type, data, size,
+                          [&](auto& bin, auto* t, auto& out) { bin_to_cbor(bin, t, out, {bool(names_as_strings)}); });
+}
+
+extern "C" abieos_bool abieos_bin_to_msgpack(abieos_context* context, uint64_t contract, const char* type,
+                                             const char* data, size_t size, abieos_bool names_as_strings) {
+    return bin_to_compact(context, stats_operation::bin_to_msgpack, contract, type, data, size,
+                          [&](auto& bin, auto* t, auto& out) {
+                              bin_to_msgpack(bin, t, out, {bool(names_as_strings)});
+                          });
+}
+
+extern "C" abieos_bool abieos_bin_to_key(abieos_context* context, uint64_t contract, const char* type,
+                                         const char* data, size_t size) {
+    return bin_to_compact(context, stats_operation::bin_to_key, contract, type, data, size,
+                          [&](auto& bin, auto* t, auto& out) { bin_to_key(bin, t, out); });
+}
+
+extern "C" abieos_bool abieos_validate_bin(abieos_context* context, uint64_t contract, const char* type,
+                                           const char* data, size_t size) {
+    fix_null_str(type);
+    return handle_exceptions(context, false, [&] {
+        if (!data)
+            size = 0;
+        stats_scope stats{context->stats, stats_operation::validate_bin, contract, size};
+        auto contract_it = context->contracts.find(::abieos::name{contract});
+        if (contract_it == context->contracts.end())
+            return set_error(context, "contract \"" + eosio::name_to_string(contract) + "\" is not loaded");
+        auto t = contract_it->second.get_type(type);
+        stats.set_type(t);
+        eosio::input_stream bin{data, size};
+        if (auto error = ::abieos::validate_bin(bin, true, t)) {
+            context->last_error = error.message().data();
+            return false;
+        }
+        stats.succeeded(0);
+        return true;
+    });
+}
+
+extern "C" abieos_bool abieos_set_json_cache(abieos_context* context, size_t max_bytes, size_t max_entry_bytes) {
+    return handle_exceptions(context, false, [&] {
+        context->json_cache.set_limits(max_bytes, max_entry_bytes);
+        return true;
+    });
+}
+
+extern "C" abieos_bool abieos_get_json_cache_stats(abieos_context* context, uint64_t* hits, uint64_t* misses,
+                                                   uint64_t* entries, uint64_t* bytes) {
+    return handle_exceptions(context, false, [&] {
+        auto& cache = context->json_cache;
+        if (hits)
+            *hits = cache.hits;
+        if (misses)
+            *misses = cache.misses;
+        if (entries)
+            *entries = cache.size();
+        if (bytes)
+            *bytes = cache.bytes();
+        return true;
+    });
+}
+
+#ifdef ABIEOS_NO_STATS
+
+extern "C" abieos_bool abieos_set_stats_enabled(abieos_context* context, abieos_bool enabled) {
+    return handle_exceptions(context, false, [&] { return set_error(context, "abieos was built without stats"); });
+}
+
+extern "C" const char* abieos_get_stats_json(abieos_context* context) {
+    return handle_exceptions(context, nullptr, [&]() -> const char* {
+        set_error(context, "abieos was built without stats");
+        return nullptr;
+    });
+}
+
+extern "C" abieos_bool abieos_reset_stats(abieos_context* context) {
+    return handle_exceptions(context, false, [&] { return set_error(context, "abieos was built without stats"); });
+}
+
+#else
+
+extern "C" abieos_bool abieos_set_stats_enabled(abieos_context* context, abieos_bool enabled) {
+    return handle_exceptions(context, false, [&] {
+        context->stats.enabled = enabled;
+        return true;
+    });
+}
+
+extern "C" const char* abieos_get_stats_json(abieos_context* context) {
+    return handle_exceptions(context, nullptr, [&]() -> const char* {
+        context->stats.to_json(context->result_str);
+        return context->result_str.c_str();
+    });
+}
+
+extern "C" abieos_bool abieos_reset_stats(abieos_context* context) {
+    return handle_exceptions(context, false, [&] {
+        context->stats.reset();
+        return true;
+    });
+}
+
+#endif
+
+extern "C" const abieos_type* abieos_get_type(abieos_context* context, uint64_t contract, const char* type) {
+    fix_null_str(type);
+    return handle_exceptions(context, nullptr, [&]() -> const abieos_type* {
+        auto contract_it = context->contracts.find(::abieos::name{contract});
+        if (contract_it == context->contracts.end()) {
+            set_error(context, "contract \"" + eosio::name_to_string(contract) + "\" is not loaded");
+            return nullptr;
+        }
+        return reinterpret_cast<const abieos_type*>(contract_it->second.get_type(type));
+    });
+}
+
+extern "C" abieos_bool abieos_get_fields_u64(abieos_context* context, const abieos_type* handle,
+                                             const char* const* paths, size_t count, const char* data, size_t size,
+                                             uint64_t* values) {
+    return handle_exceptions(context, false, [&] {
+        if (!handle)
+            return set_error(context, "type handle is null");
+        if (!data)
+            size = 0;
+        bin_view view{reinterpret_cast<const abi_type*>(handle), {data, size}};
+        for (size_t i = 0; i < count; ++i) {
+            const char* path = paths[i];
+            fix_null_str(path);
+            auto value = view.get_u64(path);
+            if (!value)
+                return set_error(context, std::string{"field \""} + path + "\" is absent");
+            values[i] = *value;
+        }
+        return true;
+    });
+}
+
+extern "C" uint64_t abieos_get_field_u64(abieos_context* context, const abieos_type* handle, const char* path,
+                                         const char* data, size_t size) {
+    uint64_t value = 0;
+    if (!abieos_get_fields_u64(context, handle, &path, 1, data, size, &value))
+        return 0;
+    return value;
+}
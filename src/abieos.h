@@ -44,6 +44,11 @@ abieos_bool abieos_set_abi_bin(abieos_context* context, uint64_t contract, const
 // Set abi (hex format). Returns false on error.
 abieos_bool abieos_set_abi_hex(abieos_context* context, uint64_t contract, const char* hex);
 
+// Make the abieos_set_abi* functions load abis lazily, or not; they start out loading eagerly. A lazily loaded abi only
+// registers its definitions, which makes loading cost about as much as parsing. Each type is resolved the first time it
+// is used, so errors in types which are never used aren't reported. Returns false on error.
+abieos_bool abieos_set_lazy_abis(abieos_context* context, abieos_bool lazy);
+
 // Get the type name for an action. The context owns the returned memory. Returns null on error; use abieos_get_error
 // to retrieve error.
 const char* abieos_get_type_for_action(abieos_context* context, uint64_t contract, uint64_t action);
@@ -82,6 +87,127 @@ const char* abieos_abi_bin_to_json(abieos_context* context, const char* abi_bin_
 // Delete a contract from the context
 abieos_bool abieos_delete_contract(abieos_context* context, uint64_t contract);
 
+// Start building binary for a type without going through json. Values are pushed in field order using the
+// abieos_builder_* functions below and are validated against the abi as they arrive. A context holds one builder at a
+// time; calling abieos_builder_begin again discards any unfinished one. Returns false on error.
+abieos_bool abieos_builder_begin(abieos_context* context, uint64_t contract, const char* type);
+
+// Start or end a struct, array, or variant. abieos_builder_begin_variant selects the alternative by its type name;
+// push the alternative's value, then call abieos_builder_end_variant. Returns false on error.
+abieos_bool abieos_builder_begin_struct(abieos_context* context);
+abieos_bool abieos_builder_end_struct(abieos_context* context);
+abieos_bool abieos_builder_begin_array(abieos_context* context);
+abieos_bool abieos_builder_end_array(abieos_context* context);
+abieos_bool abieos_builder_begin_variant(abieos_context* context, const char* alternative);
+abieos_bool abieos_builder_end_variant(abieos_context* context);
+
+// Push the next value. Integers are range-checked against the target integer type. abieos_builder_push_null fills an
+// absent optional. abieos_builder_push_string accepts strings and the json string form of other types (e.g. asset
+// "1.0000 SYS", time_point, public_key). abieos_builder_push_bytes takes raw bytes. Returns false on error.
+abieos_bool abieos_builder_push_null(abieos_context* context);
+abieos_bool abieos_builder_push_bool(abieos_context* context, abieos_bool value);
+abieos_bool abieos_builder_push_int64(abieos_context* context, int64_t value);
+abieos_bool abieos_builder_push_uint64(abieos_context* context, uint64_t value);
+abieos_bool abieos_builder_push_double(abieos_context* context, double value);
+abieos_bool abieos_builder_push_name(abieos_context* context, uint64_t value);
+abieos_bool abieos_builder_push_string(abieos_context* context, const char* data, size_t size);
+abieos_bool abieos_builder_push_bytes(abieos_context* context, const char* data, size_t size);
+
+// Finish building. Use abieos_get_bin_* to retrieve result. Returns false on error.
+abieos_bool abieos_builder_finish(abieos_context* context);
+
+// Convert binary to CBOR or MessagePack. Structs become maps keyed by field name, variants become [alternative, value],
+// bytes and checksums become byte strings and assets become maps {amount, precision, symbol}. Names are written as
+// uint64 unless names_as_strings is set. Use abieos_get_bin_* to retrieve result. Returns false on error.
+abieos_bool abieos_bin_to_cbor(abieos_context* context, uint64_t contract, const char* type, const char* data,
+                               size_t size, abieos_bool names_as_strings);
+abieos_bool abieos_bin_to_msgpack(abieos_context* context, uint64_t contract, const char* type, const char* data,
+                                  size_t size, abieos_bool names_as_strings);
+
+// Convert binary to an order-preserving key: comparing two keys byte by byte orders them like their values. The key
+// has the same encoding as eosio::to_key (to_key.hpp) on the matching C++ type. Use abieos_get_bin_* to retrieve
+// result. Returns false on error.
+abieos_bool abieos_bin_to_key(abieos_context* context, uint64_t contract, const char* type, const char* data,
+                              size_t size);
+
+// Check that data holds a value of type without converting it. Returns false when abieos_bin_to_json would fail on
+// truncated data, a bad varuint, a bad variant index or too much nesting; use abieos_get_error to retrieve error.
+// Malformed data is rejected without throwing or allocating, so this is a cheap filter ahead of a conversion.
+abieos_bool abieos_validate_bin(abieos_context* context, uint64_t contract, const char* type, const char* data,
+                                size_t size);
+
+// Cache the json abieos_bin_to_json returns, so that converting byte-identical data again with the same contract and
+// type copies the earlier result instead of decoding it. The cache holds at most about max_bytes of data and json,
+// dropping the least recently used entries first, and skips results that would take more than max_entry_bytes.
+// max_bytes of 0 turns the cache off and empties it; it starts off. Deleting a contract empties it. Returns false on
+// error.
+abieos_bool abieos_set_json_cache(abieos_context* context, size_t max_bytes, size_t max_entry_bytes);
+
+// Get the hit and miss counts of the json cache and how many entries and bytes it holds. Any of the pointers may be
+// null. Returns false on error.
+abieos_bool abieos_get_json_cache_stats(abieos_context* context, uint64_t* hits, uint64_t* misses, uint64_t* entries,
+                                        uint64_t* bytes);
+
+// Turn collection of performance counters on or off; it starts off. While on, the conversion functions count calls,
+// input and output bytes and errors for each contract, type and function. About one call in 32 is also timed, into
+// "nanoseconds" and a latency histogram, since reading the clock costs as much as a small conversion. Counting adds
+// about 10 ns to a call: a few percent of a conversion, but 10-20% of abieos_validate_bin on a small struct. Fails
+// when abieos was built with ABIEOS_NO_STATS, which leaves the counters out.
+abieos_bool abieos_set_stats_enabled(abieos_context* context, abieos_bool enabled);
+
+// Get the counters as a json array with one object per contract, type and function. "nanoseconds" is the total of the
+// "timed_calls" and "latency" holds their [bucket start in ns, count] pairs for the non-empty buckets; a bucket is at
+// most 25% wide. Calls whose contract or type wasn't found are counted together for each function, under an empty
+// contract and type. The context owns the returned string. Returns null on error.
+const char* abieos_get_stats_json(abieos_context* context);
+
+// Clear the counters. Returns false on error.
+abieos_bool abieos_reset_stats(abieos_context* context);
+
+// A type handle for the abieos_get_field_* functions. It stays valid until its contract is deleted.
+typedef struct abieos_type_s abieos_type;
+
+// Look up a type handle. Returns null on error; use abieos_get_error to retrieve error.
+const abieos_type* abieos_get_type(abieos_context* context, uint64_t contract, const char* type);
+
+// Read the unsigned integer, name, symbol, bool or timestamp at path (e.g. "act.name" or "actions.0.account") in data
+// without decoding the rest of it. Optionals and variants along the path are entered; a null optional is an error.
+// Returns 0 on error; use abieos_get_error to retrieve error.
+uint64_t abieos_get_field_u64(abieos_context* context, const abieos_type* handle, const char* path, const char* data,
+                              size_t size);
+
+// Like abieos_get_field_u64 for several paths into the same data. Positions found while locating earlier paths are
+// reused by later ones. Stores the results in values[0..count). Returns false on error.
+abieos_bool abieos_get_fields_u64(abieos_context* context, const abieos_type* handle, const char* const* paths,
+                                  size_t count, const char* data, size_t size, uint64_t* values);
+
+// Callbacks for abieos_bin_to_visitor. Each receives the user pointer given to abieos_bin_to_visitor and returns false
+// to abort. Null callbacks are skipped. Variants arrive as start_variant(alternative name), value, end_variant. Types
+// without a scalar form (asset, public_key, time_point, checksum256, ...) arrive through string in their json string
+// form. Strings passed to callbacks are only valid for the duration of the call.
+typedef struct abieos_visitor_s {
+    abieos_bool (*null_value)(void* user);
+    abieos_bool (*bool_value)(void* user, abieos_bool value);
+    abieos_bool (*int64_value)(void* user, int64_t value);
+    abieos_bool (*uint64_value)(void* user, uint64_t value);
+    abieos_bool (*double_value)(void* user, double value);
+    abieos_bool (*name_value)(void* user, uint64_t value);
+    abieos_bool (*string_value)(void* user, const char* data, size_t size);
+    abieos_bool (*bytes_value)(void* user, const char* data, size_t size);
+    abieos_bool (*start_object)(void* user);
+    abieos_bool (*key)(void* user, const char* data, size_t size);
+    abieos_bool (*end_object)(void* user);
+    abieos_bool (*start_array)(void* user, uint32_t size);
+    abieos_bool (*end_array)(void* user);
+    abieos_bool (*start_variant)(void* user, const char* alternative, size_t size);
+    abieos_bool (*end_variant)(void* user);
+} abieos_visitor;
+
+// Decode binary and report the values to visitor instead of producing json. Returns false on error, including when a
+// callback aborts.
+abieos_bool abieos_bin_to_visitor(abieos_context* context, uint64_t contract, const char* type, const char* data,
+                                  size_t size, const abieos_visitor* visitor, void* user);
+
 #ifdef __cplusplus
 }
 #endif
@@ -8,6 +8,7 @@
 #include <eosio/reflection.hpp>
 #include <eosio/to_bin.hpp>
 #include <eosio/to_json.hpp>
+#include <eosio/to_key.hpp>
 #include <eosio/abi.hpp>
 #include <eosio/operators.hpp>
 #include <eosio/bytes.hpp>
@@ -19,6 +20,7 @@
 #include <eosio/float.hpp>
 #include <eosio/varint.hpp>
 #include <eosio/bitset.hpp>
+#include <eosio/validate_bin.hpp>
 
 #ifdef __eosio_cdt__
 #include <cwchar>
@@ -272,6 +274,107 @@ struct json_to_bin_state : eosio::json_token_stream {
 
     explicit json_to_bin_state(char* in, eosio::vector_stream& out)
       : eosio::json_token_stream(in), writer(out) {}
+
+    // Starts a new conversion, keeping what the stacks have allocated
+    void reset(char* in) {
+        json_token_stream::reset(in);
+        size_insertions.clear();
+        stack.clear();
+        skipped_extension = false;
+    }
+};
+
+// Temporaries of json_to_bin and bin_to_json. Conversions given the same conversion_scratch reuse its buffers and
+// states, so once they have grown to fit the largest value converting doesn't allocate. abieos_context owns one.
+struct conversion_scratch {
+    std::vector<char> json{};
+    std::vector<char> out_buf{};
+    std::vector<char> hex_data{};
+    eosio::vector_stream out{out_buf};
+    json_to_bin_state json_state{nullptr, out};
+    std::vector<bin_to_json_stack_entry> bin_to_json_stack{};
+
+    conversion_scratch() = default;
+    conversion_scratch(const conversion_scratch&) = delete;
+    conversion_scratch& operator=(const conversion_scratch&) = delete;
+};
+
+// Lends an emptied scratch vector to a conversion state and takes it back, with the capacity it grew to, when the
+// conversion ends
+template <typename T>
+struct scratch_loan {
+    std::vector<T>& scratch;
+    std::vector<T>& borrower;
+
+    scratch_loan(std::vector<T>& scratch, std::vector<T>& borrower) : scratch{scratch}, borrower{borrower} {
+        scratch.clear();
+        borrower.swap(scratch);
+    }
+    ~scratch_loan() { borrower.swap(scratch); }
+    scratch_loan(const scratch_loan&) = delete;
+    scratch_loan& operator=(const scratch_loan&) = delete;
+};
+
+// Returns the json form of v with the surrounding quotes removed. buffer holds the storage.
+template <typename T>
+std::string_view json_string_form(const T& v, std::vector<char>& buffer) {
+    eosio::vector_stream writer{buffer};
+    to_json(v, writer);
+    std::string_view s{buffer.data(), buffer.size()};
+    if (s.size() >= 2 && s.front() == '"' && s.back() == '"')
+        s = s.substr(1, s.size() - 2);
+    return s;
+}
+
+// Receives typed values from bin_to_visitor in place of json text. Variants are reported as
+// start_variant(alternative name), value, end_variant. Types without a natural scalar form (asset, public_key,
+// time_point, checksum256, ...) arrive through string() in their json string form. Returning false aborts.
+// bin_to_visitor takes any handler with these member functions and calls them directly; bin_visitor is the
+// type-erased form, for handlers chosen at run time such as the C API's callbacks.
+struct bin_visitor {
+    virtual ~bin_visitor() = default;
+    virtual bool null() = 0;
+    virtual bool boolean(bool value) = 0;
+    virtual bool int64(int64_t value) = 0;
+    virtual bool uint64(uint64_t value) = 0;
+    virtual bool float64(double value) = 0;
+    virtual bool name(uint64_t value) = 0;
+    virtual bool string(std::string_view value) = 0;
+    virtual bool bytes(std::string_view value) = 0;
+    virtual bool start_object() = 0;
+    virtual bool key(std::string_view key) = 0;
+    virtual bool end_object() = 0;
+    virtual bool start_array(uint32_t size) = 0;
+    virtual bool end_array() = 0;
+    virtual bool start_variant(std::string_view alternative) = 0;
+    virtual bool end_variant() = 0;
+
+    // Structured forms of values that otherwise arrive through string(). By default they forward the string form.
+    virtual bool asset(const eosio::asset& value) {
+        std::vector<char> buffer;
+        return string(json_string_form(value, buffer));
+    }
+    virtual bool checksum(std::string_view raw) {
+        std::vector<char> buffer;
+        eosio::vector_stream writer{buffer};
+        eosio::to_json_hex(raw.data(), raw.size(), writer);
+        return string({buffer.data() + 1, buffer.size() - 2});
+    }
+};
+
+inline void check_visit(bool ok) { eosio::check(ok, "bin_visitor aborted"); }
+
+// A value of a builtin type, decoded by abi_serializer::bin_to_value. kind selects the member holding it: uint64 for
+// boolean, uint64 and name; text for string, bytes and the raw bytes of a checksum, which may point into the input.
+struct bin_value {
+    enum class kind_t : uint8_t { boolean, int64, uint64, float64, name, string, bytes, asset, checksum };
+
+    kind_t kind = kind_t::boolean;
+    uint64_t uint64 = 0;
+    int64_t int64 = 0;
+    double float64 = 0;
+    std::string_view text{};
+    eosio::asset asset{};
 };
 
 struct bin_to_json_state {
@@ -284,6 +387,82 @@ struct bin_to_json_state {
         : bin{bin}, writer{writer} {}
 };
 
+enum class builder_value_kind {
+    none,
+    null,
+    boolean,
+    int64,
+    uint64,
+    float64,
+    name,
+    string,
+    bytes,
+};
+
+struct bin_builder_stack_entry {
+    const abi_type* type = nullptr;
+    bool allow_extensions = false;
+    int position = -1;
+    size_t size_insertion_index = 0;
+};
+
+// Builds binary directly from typed values pushed by the caller, validating each one against the abi_type graph.
+// The pushed value is held in the value_* members while it is being serialized; get_* expose it to from_json.
+struct bin_builder_state {
+    const abi_type* root;
+    std::vector<char> out_buf{};
+    eosio::vector_stream writer{out_buf};
+    std::vector<size_insertion> size_insertions{};
+    std::vector<bin_builder_stack_entry> stack{};
+    bool root_started = false;
+
+    builder_value_kind kind = builder_value_kind::none;
+    bool value_bool = false;
+    int64_t value_int64 = 0;
+    uint64_t value_uint64 = 0;
+    double value_double = 0;
+    std::string_view value_string{};
+
+    explicit bin_builder_state(const abi_type* root) : root{root} {}
+    bin_builder_state(const bin_builder_state&) = delete;
+    bin_builder_state& operator=(const bin_builder_state&) = delete;
+
+    bool get_null_pred() const { return kind == builder_value_kind::null; }
+    void get_null() const {
+        eosio::check(kind == builder_value_kind::null, eosio::convert_json_error(eosio::from_json_error::expected_null));
+    }
+    bool get_bool() const {
+        eosio::check(kind == builder_value_kind::boolean,
+                     eosio::convert_json_error(eosio::from_json_error::expected_bool));
+        return value_bool;
+    }
+    std::string_view get_string() const {
+        eosio::check(kind == builder_value_kind::string,
+                     eosio::convert_json_error(eosio::from_json_error::expected_string));
+        return value_string;
+    }
+};
+
+// The error validate_bin found: the stream error from_bin would have thrown, or the abi error bin_to_json would have
+// thrown. Converts to true when there is one.
+struct bin_error {
+    eosio::stream_error stream = eosio::stream_error::no_error;
+    eosio::abi_error abi = eosio::abi_error::no_error;
+
+    bin_error() = default;
+    bin_error(eosio::stream_error stream) : stream{stream} {}
+    bin_error(eosio::abi_error abi) : abi{abi} {}
+
+    explicit operator bool() const {
+        return stream != eosio::stream_error::no_error || abi != eosio::abi_error::no_error;
+    }
+
+    // Null-terminated message with static storage
+    std::string_view message() const {
+        return abi != eosio::abi_error::no_error ? eosio::convert_abi_error(abi) : eosio::convert_stream_error(stream);
+    }
+};
+
 }
 
 namespace eosio {
@@ -295,6 +474,14 @@ struct abi_serializer {
                                           bool start) const = 0;
   virtual void bin_to_json(::abieos::bin_to_json_state& state, bool allow_extensions, const abi_type* type,
                                           bool start) const = 0;
+  virtual void json_to_bin(::abieos::bin_builder_state& state, bool allow_extensions, const abi_type* type,
+                                          bool start) const = 0;
+  virtual void skip_bin(eosio::input_stream& bin, bool allow_extensions, const abi_type* type, int depth) const = 0;
+  virtual void bin_to_key(eosio::input_stream& bin, eosio::vector_stream& writer, bool allow_extensions,
+                          const abi_type* type, int depth) const = 0;
+  virtual ::abieos::bin_error validate_bin(eosio::input_stream& bin, bool allow_extensions, const abi_type* type,
+                                           int depth) const = 0;
+  virtual void bin_to_value(eosio::input_stream& bin, ::abieos::bin_value& value, std::vector<char>& buffer) const = 0;
 };
 
 }
@@ -332,6 +519,47 @@ void json_to_bin(pseudo_array*, json_to_bin_state& state, bool allow_extensions,
 void json_to_bin(pseudo_variant*, json_to_bin_state& state, bool allow_extensions,
                                 const abi_type* type, bool start);
 
+void json_to_bin(pseudo_object*, bin_builder_state& state, bool allow_extensions, const abi_type* type,
+                                bool start);
+void json_to_bin(pseudo_array*, bin_builder_state& state, bool allow_extensions, const abi_type* type,
+                                bool start);
+void json_to_bin(pseudo_variant*, bin_builder_state& state, bool allow_extensions,
+                                const abi_type* type, bool start);
+
+void skip_bin(pseudo_optional*, eosio::input_stream& bin, bool allow_extensions, const abi_type* type, int depth);
+void skip_bin(pseudo_extension*, eosio::input_stream& bin, bool allow_extensions, const abi_type* type, int depth);
+void skip_bin(pseudo_object*, eosio::input_stream& bin, bool allow_extensions, const abi_type* type, int depth);
+void skip_bin(pseudo_array*, eosio::input_stream& bin, bool allow_extensions, const abi_type* type, int depth);
+void skip_bin(pseudo_variant*, eosio::input_stream& bin, bool allow_extensions, const abi_type* type, int depth);
+
+void bin_to_key(pseudo_optional*, eosio::input_stream& bin, eosio::vector_stream& writer, bool allow_extensions,
+                const abi_type* type, int depth);
+void bin_to_key(pseudo_extension*, eosio::input_stream& bin, eosio::vector_stream& writer, bool allow_extensions,
+                const abi_type* type, int depth);
+void bin_to_key(pseudo_object*, eosio::input_stream& bin, eosio::vector_stream& writer, bool allow_extensions,
+                const abi_type* type, int depth);
+void bin_to_key(pseudo_array*, eosio::input_stream& bin, eosio::vector_stream& writer, bool allow_extensions,
+                const abi_type* type, int depth);
+void bin_to_key(pseudo_variant*, eosio::input_stream& bin, eosio::vector_stream& writer, bool allow_extensions,
+                const abi_type* type, int depth);
+
+bin_error validate_bin(pseudo_optional*, eosio::input_stream& bin, bool allow_extensions, const abi_type* type,
+                       int depth);
+bin_error validate_bin(pseudo_extension*, eosio::input_stream& bin, bool allow_extensions, const abi_type* type,
+                       int depth);
+bin_error validate_bin(pseudo_object*, eosio::input_stream& bin, bool allow_extensions, const abi_type* type,
+                       int depth);
+bin_error validate_bin(pseudo_array*, eosio::input_stream& bin, bool allow_extensions, const abi_type* type,
+                       int depth);
+bin_error validate_bin(pseudo_variant*, eosio::input_stream& bin, bool allow_extensions, const abi_type* type,
+                       int depth);
+
+void bin_to_value(pseudo_optional*, eosio::input_stream& bin, bin_value& value, std::vector<char>& buffer);
+void bin_to_value(pseudo_extension*, eosio::input_stream& bin, bin_value& value, std::vector<char>& buffer);
+void bin_to_value(pseudo_object*, eosio::input_stream& bin, bin_value& value, std::vector<char>& buffer);
+void bin_to_value(pseudo_array*, eosio::input_stream& bin, bin_value& value, std::vector<char>& buffer);
+void bin_to_value(pseudo_variant*, eosio::input_stream& bin, bin_value& value, std::vector<char>& buffer);
+
 void bin_to_json(pseudo_optional*, bin_to_json_state& state, bool allow_extensions,
                                 const abi_type* type, bool start);
 void bin_to_json(pseudo_extension*, bin_to_json_state& state, bool allow_extensions,
@@ -361,6 +589,13 @@ void json_to_bin(bytes*, State& state, bool, const abi_type*, bool start) {
         eosio::convert_json_error(eosio::from_json_error::expected_hex_string));
 }
 
+inline void json_to_bin(bytes*, bin_builder_state& state, bool, const abi_type*, bool start) {
+    if (state.kind != builder_value_kind::bytes)
+        return json_to_bin<bin_builder_state>((bytes*)nullptr, state, false, nullptr, start);
+    eosio::varuint32_to_bin(state.value_string.size(), state.writer);
+    state.writer.write(state.value_string.data(), state.value_string.size());
+}
+
 inline void bin_to_json(bytes*, bin_to_json_state& state, bool, const abi_type*, bool start) {
     uint64_t size;
     varuint64_from_bin(size, state.bin);
@@ -458,8 +693,9 @@ void to_json(const int128& obj, S& stream) {
 using extensions_type = std::vector<std::pair<uint16_t, bytes>>;
 
 using eosio::abi_def;
+using eosio::abi_def_view;
 
-ABIEOS_NODISCARD inline bool check_abi_version(const std::string& s, std::string& error) {
+ABIEOS_NODISCARD inline bool check_abi_version(std::string_view s, std::string& error) {
    if (auto prefix = s.substr(0, 13); prefix != "eosio::abi/1." && prefix != "eosio::abi/2.")
         return set_error(error, "unsupported abi version");
     return true;
@@ -740,14 +976,15 @@ inline void json_to_bin(std::string*, State& state, bool, const abi_type*,
 ///////////////////////////////////////////////////////////////////////////////
 
 template<typename F>
-inline void json_to_bin(std::vector<char>& bin, const abi_type* type, std::string_view json, F&& f) {
-    std::string mutable_json{json};
-    mutable_json.push_back(0);
-    mutable_json.push_back(0);
-    mutable_json.push_back(0);
-    std::vector<char> out_buf;
-    eosio::vector_stream out(out_buf);
-    json_to_bin_state state(mutable_json.data(), out);
+inline void json_to_bin(std::vector<char>& bin, const abi_type* type, std::string_view json, F&& f,
+                        conversion_scratch& scratch) {
+    auto& mutable_json = scratch.json;
+    mutable_json.assign(json.begin(), json.end());
+    mutable_json.insert(mutable_json.end(), 3, 0);
+    auto& out_buf = scratch.out_buf;
+    out_buf.clear();
+    auto& state = scratch.json_state;
+    state.reset(mutable_json.data());
 
     type->ser->json_to_bin(state, true, type, true);
     while(!state.stack.empty()) {
@@ -770,6 +1007,12 @@ inline void json_to_bin(std::vector<char>& bin, const abi_type* type, std::strin
     bin.insert(bin.end(), out_buf.begin() + pos, out_buf.end());
 }
 
+template<typename F>
+inline void json_to_bin(std::vector<char>& bin, const abi_type* type, std::string_view json, F&& f) {
+    conversion_scratch scratch;
+    json_to_bin(bin, type, json, f, scratch);
+}
+
 inline void json_to_bin(pseudo_object*, json_to_bin_state& state, bool allow_extensions,
                                        const abi_type* type, bool start) {
     if (start) {
@@ -880,16 +1123,475 @@ inline void json_to_bin(pseudo_variant*, json_to_bin_state& state, bool allow_ex
     }
 }
 
+///////////////////////////////////////////////////////////////////////////////
+// bin_builder
+///////////////////////////////////////////////////////////////////////////////
+
+template <typename T>
+T builder_to_integer(const bin_builder_state& state) {
+    constexpr bool is_signed = std::is_signed_v<T>;
+    if (state.kind == builder_value_kind::int64) {
+        auto v = state.value_int64;
+        if constexpr (sizeof(T) < 8 || !is_signed) {
+            if (v < 0) {
+                eosio::check(is_signed && v >= int64_t(std::numeric_limits<T>::min()),
+                             eosio::convert_json_error(eosio::from_json_error::number_out_of_range));
+            } else if constexpr (sizeof(T) < 8) {
+                eosio::check(uint64_t(v) <= uint64_t(std::numeric_limits<T>::max()),
+                             eosio::convert_json_error(eosio::from_json_error::number_out_of_range));
+            }
+        }
+        return T(v);
+    } else if (state.kind == builder_value_kind::uint64) {
+        auto v = state.value_uint64;
+        if constexpr (sizeof(T) <= 8)
+            eosio::check(v <= uint64_t(std::numeric_limits<T>::max()),
+                         eosio::convert_json_error(eosio::from_json_error::number_out_of_range));
+        return T(v);
+    }
+    T result;
+    eosio::from_json(result, state);
+    return result;
+}
+
+template <typename T>
+auto json_to_bin(T*, bin_builder_state& state, bool, const abi_type*, bool)
+    -> std::enable_if_t<eosio::is_basic_abi_type<T> && !std::is_same_v<T, bytes> && !std::is_same_v<T, std::string>> {
+    using eosio::from_json;
+    if constexpr (std::is_integral_v<T> && !std::is_same_v<T, bool>) {
+        return to_bin(builder_to_integer<T>(state), state.writer);
+    } else if constexpr (std::is_same_v<T, varuint32>) {
+        return to_bin(varuint32{builder_to_integer<uint32_t>(state)}, state.writer);
+    } else if constexpr (std::is_same_v<T, varint32>) {
+        return to_bin(varint32{builder_to_integer<int32_t>(state)}, state.writer);
+    } else if constexpr (std::is_floating_point_v<T>) {
+        if (state.kind == builder_value_kind::float64)
+            return to_bin(T(state.value_double), state.writer);
+        if (state.kind == builder_value_kind::int64)
+            return to_bin(T(state.value_int64), state.writer);
+        if (state.kind == builder_value_kind::uint64)
+            return to_bin(T(state.value_uint64), state.writer);
+    } else if constexpr (std::is_same_v<T, name>) {
+        if (state.kind == builder_value_kind::name)
+            return to_bin(state.value_uint64, state.writer);
+    }
+    T x;
+    from_json(x, state);
+    return to_bin(x, state.writer);
+}
+
+inline void json_to_bin(pseudo_object*, bin_builder_state&, bool, const abi_type*, bool) {
+    eosio::check(false, eosio::convert_json_error(eosio::from_json_error::expected_start_object));
+}
+
+inline void json_to_bin(pseudo_array*, bin_builder_state&, bool, const abi_type*, bool) {
+    eosio::check(false, eosio::convert_json_error(eosio::from_json_error::expected_start_array));
+}
+
+inline void json_to_bin(pseudo_variant*, bin_builder_state&, bool, const abi_type*, bool) {
+    eosio::check(false, eosio::convert_json_error(eosio::from_json_error::expected_variant));
+}
+
+// Returns the type of the next value and moves past it
+inline const abi_type* bin_builder_next(bin_builder_state& state, bool& allow_extensions) {
+    if (state.stack.empty()) {
+        eosio::check(!state.root_started, eosio::convert_json_error(eosio::from_json_error::expected_end));
+        state.root_started = true;
+        allow_extensions = true;
+        return state.root;
+    }
+    auto& entry = state.stack.back();
+    if (auto* s = entry.type->as_struct()) {
+        eosio::check(++entry.position < (int)s->fields.size(),
+                     eosio::convert_json_error(eosio::from_json_error::unexpected_field));
+        allow_extensions = entry.allow_extensions && entry.position + 1 == (int)s->fields.size();
+        return s->fields[entry.position].type;
+    } else if (auto* t = entry.type->array_of()) {
+        ++entry.position;
+        allow_extensions = false;
+        return t;
+    } else {
+        // variants: begin_variant selects the alternative and stores its index in size_insertion_index
+        eosio::check(++entry.position == 0, eosio::convert_json_error(eosio::from_json_error::expected_variant));
+        allow_extensions = entry.allow_extensions;
+        return (*entry.type->as_variant())[entry.size_insertion_index].type;
+    }
+}
+
+// Writes the presence flags of any optional wrappers and returns the wrapped type
+inline const abi_type* bin_builder_unwrap(bin_builder_state& state, const abi_type* type) {
+    while (true) {
+        if (auto* t = type->optional_of()) {
+            state.writer.write(char(1));
+            type = t;
+        } else if (auto* t = type->extension_of()) {
+            type = t;
+        } else {
+            return type;
+        }
+    }
+}
+
+inline void bin_builder_push(bin_builder_state& state) {
+    bool allow_extensions;
+    auto* type = bin_builder_next(state, allow_extensions);
+    type->ser->json_to_bin(state, allow_extensions, type, true);
+    state.kind = builder_value_kind::none;
+}
+
+inline void bin_builder_begin_struct(bin_builder_state& state) {
+    bool allow_extensions;
+    auto* type = bin_builder_unwrap(state, bin_builder_next(state, allow_extensions));
+    eosio::check(type->as_struct(), eosio::convert_json_error(eosio::from_json_error::expected_start_object));
+    eosio::check(state.stack.size() < max_stack_size,
+                 eosio::convert_abi_error(eosio::abi_error::recursion_limit_reached));
+    state.stack.push_back({type, allow_extensions});
+}
+
+inline void bin_builder_end_struct(bin_builder_state& state) {
+    eosio::check(!state.stack.empty() && state.stack.back().type->as_struct(),
+                 eosio::convert_json_error(eosio::from_json_error::expected_end_object));
+    auto& entry = state.stack.back();
+    auto& fields = entry.type->as_struct()->fields;
+    if (entry.position + 1 != (int)fields.size()) {
+        // trailing binary extensions may be omitted, but nothing else
+        eosio::check(entry.allow_extensions && fields.back().type->extension_of(),
+                     eosio::convert_json_error(eosio::from_json_error::expected_field));
+        for (auto i = entry.position + 1; i < (int)fields.size(); ++i)
+            eosio::check(fields[i].type->extension_of(),
+                         eosio::convert_json_error(eosio::from_json_error::expected_field));
+    }
+    state.stack.pop_back();
+}
+
+inline void bin_builder_begin_array(bin_builder_state& state) {
+    bool allow_extensions;
+    auto* type = bin_builder_unwrap(state, bin_builder_next(state, allow_extensions));
+    eosio::check(type->array_of(), eosio::convert_json_error(eosio::from_json_error::expected_start_array));
+    eosio::check(state.stack.size() < max_stack_size,
+                 eosio::convert_abi_error(eosio::abi_error::recursion_limit_reached));
+    state.stack.push_back({type, false, -1, state.size_insertions.size()});
+    state.size_insertions.push_back({state.writer.data.size()});
+}
+
+inline void bin_builder_end_array(bin_builder_state& state) {
+    eosio::check(!state.stack.empty() && state.stack.back().type->array_of(),
+                 eosio::convert_json_error(eosio::from_json_error::expected_end_array));
+    auto& entry = state.stack.back();
+    state.size_insertions[entry.size_insertion_index].size = entry.position + 1;
+    state.stack.pop_back();
+}
+
+inline void bin_builder_begin_variant(bin_builder_state& state, std::string_view alternative) {
+    bool allow_extensions;
+    auto* type = bin_builder_unwrap(state, bin_builder_next(state, allow_extensions));
+    eosio::check(type->as_variant(), eosio::convert_json_error(eosio::from_json_error::expected_variant));
+    eosio::check(state.stack.size() < max_stack_size,
+                 eosio::convert_abi_error(eosio::abi_error::recursion_limit_reached));
+    auto& fields = *type->as_variant();
+    auto it = std::find_if(fields.begin(), fields.end(), [&](auto& field) { return field.name == alternative; });
+    eosio::check(it != fields.end(), eosio::convert_json_error(eosio::from_json_error::invalid_type_for_variant));
+    size_t index = it - fields.begin();
+    eosio::varuint32_to_bin(index, state.writer);
+    state.stack.push_back({type, allow_extensions, -1, index});
+}
+
+inline void bin_builder_end_variant(bin_builder_state& state) {
+    eosio::check(!state.stack.empty() && state.stack.back().type->as_variant() && state.stack.back().position == 0,
+                 eosio::convert_json_error(eosio::from_json_error::expected_variant));
+    state.stack.pop_back();
+}
+
+inline void bin_builder_finish(bin_builder_state& state, std::vector<char>& bin) {
+    eosio::check(state.root_started && state.stack.empty(),
+                 eosio::convert_json_error(eosio::from_json_error::expected_end));
+    size_t pos = 0;
+    for (auto& insertion : state.size_insertions) {
+        bin.insert(bin.end(), state.out_buf.begin() + pos, state.out_buf.begin() + insertion.position);
+        eosio::push_varuint32(bin, insertion.size);
+        pos = insertion.position;
+    }
+    bin.insert(bin.end(), state.out_buf.begin() + pos, state.out_buf.end());
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// skip_bin
+///////////////////////////////////////////////////////////////////////////////
+
+// Binary size of types whose encoding has a fixed length; 0 for the rest
+template <typename T>
+constexpr size_t fixed_bin_size() {
+    if constexpr (std::is_same_v<T, float128> || std::is_same_v<T, int128> || std::is_same_v<T, uint128>)
+        return 16;
+    else if constexpr (std::is_arithmetic_v<T>)
+        return sizeof(T);
+    else if constexpr (std::is_same_v<T, name> || std::is_same_v<T, symbol> || std::is_same_v<T, symbol_code> ||
+                       std::is_same_v<T, time_point>)
+        return 8;
+    else if constexpr (std::is_same_v<T, time_point_sec> || std::is_same_v<T, block_timestamp>)
+        return 4;
+    else if constexpr (std::is_same_v<T, asset>)
+        return 16;
+    else if constexpr (std::is_same_v<T, checksum160>)
+        return 20;
+    else if constexpr (std::is_same_v<T, checksum256>)
+        return 32;
+    else if constexpr (std::is_same_v<T, checksum512>)
+        return 64;
+    else
+        return 0;
+}
+
+// Moves bin past a value of type without decoding it
+inline void skip_bin(eosio::input_stream& bin, bool allow_extensions, const abi_type* type, int depth = 0) {
+    eosio::check(depth < (int)max_stack_size, eosio::convert_abi_error(eosio::abi_error::recursion_limit_reached));
+    type->ser->skip_bin(bin, allow_extensions, type, depth);
+}
+
+inline void skip_bin(pseudo_optional*, eosio::input_stream& bin, bool allow_extensions, const abi_type* type,
+                     int depth) {
+    bool present;
+    from_bin(present, bin);
+    if (present)
+        skip_bin(bin, allow_extensions, type->optional_of(), depth + 1);
+}
+
+inline void skip_bin(pseudo_extension*, eosio::input_stream& bin, bool allow_extensions, const abi_type* type,
+                     int depth) {
+    skip_bin(bin, allow_extensions, type->extension_of(), depth + 1);
+}
+
+inline void skip_bin(pseudo_object*, eosio::input_stream& bin, bool allow_extensions, const abi_type* type,
+                     int depth) {
+    const std::vector<eosio::abi_field>& fields = type->as_struct()->fields;
+    for (auto& field : fields) {
+        if (bin.pos == bin.end && field.type->extension_of() && allow_extensions)
+            continue;
+        skip_bin(bin, allow_extensions && &field == &fields.back(), field.type, depth + 1);
+    }
+}
+
+inline void skip_bin(pseudo_array*, eosio::input_stream& bin, bool, const abi_type* type, int depth) {
+    uint32_t size;
+    varuint32_from_bin(size, bin);
+    for (uint32_t i = 0; i < size; ++i)
+        skip_bin(bin, false, type->array_of(), depth + 1);
+}
+
+inline void skip_bin(pseudo_variant*, eosio::input_stream& bin, bool allow_extensions, const abi_type* type,
+                     int depth) {
+    uint32_t index;
+    varuint32_from_bin(index, bin);
+    const std::vector<eosio::abi_field>& fields = *type->as_variant();
+    eosio::check(index < fields.size(), eosio::convert_stream_error(eosio::stream_error::bad_variant_index));
+    skip_bin(bin, allow_extensions, fields[index].type, depth + 1);
+}
+
+template <typename T>
+void skip_bin(T*, eosio::input_stream& bin, bool, const abi_type*, int) {
+    if constexpr (fixed_bin_size<T>() != 0) {
+        bin.skip(fixed_bin_size<T>());
+    } else if constexpr (std::is_same_v<T, bytes> || std::is_same_v<T, std::string>) {
+        uint64_t size;
+        varuint64_from_bin(size, bin);
+        bin.skip(size);
+    } else {
+        T v;
+        from_bin(v, bin);
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// bin_to_key
+///////////////////////////////////////////////////////////////////////////////
+
+// Writes the eosio::to_key encoding of a value of type, read from bin, without decoding it into a C++ type. Structs,
+// arrays, optionals and variants produce the same bytes as to_key on the matching C++ types (std::tuple,
+// std::vector, std::optional, std::variant). Binary extensions ($) are keyed like optionals.
+inline void bin_to_key(eosio::input_stream& bin, eosio::vector_stream& writer, bool allow_extensions,
+                       const abi_type* type, int depth = 0) {
+    eosio::check(depth < (int)max_stack_size, eosio::convert_abi_error(eosio::abi_error::recursion_limit_reached));
+    type->ser->bin_to_key(bin, writer, allow_extensions, type, depth);
+}
+
+inline void bin_to_key(eosio::input_stream& bin, const abi_type* type, std::vector<char>& key) {
+    eosio::vector_stream writer{key};
+    bin_to_key(bin, writer, true, type);
+}
+
+// to_key_optional writes the one-byte keys of bool, int8 and uint8 escaped instead of behind a presence byte
+inline bool has_single_byte_key(const abi_type* type) {
+    return std::holds_alternative<abi_type::builtin>(type->_data) &&
+           (type->name == "bool" || type->name == "int8" || type->name == "uint8");
+}
+
+// One element of an array or the value of an optional, as to_key_optional writes it
+inline void element_to_key(eosio::input_stream& bin, eosio::vector_stream& writer, const abi_type* type, int depth) {
+    if (has_single_byte_key(type)) {
+        auto pos = writer.data.size();
+        bin_to_key(bin, writer, false, type, depth);
+        if (writer.data[pos] == '\0')
+            writer.write('\1');
+    } else {
+        writer.write('\1');
+        bin_to_key(bin, writer, false, type, depth);
+    }
+}
+
+inline void end_elements_to_key(eosio::vector_stream& writer, const abi_type* type) {
+    if (has_single_byte_key(type))
+        writer.write("\0", 2);
+    else
+        writer.write('\0');
+}
+
+inline void bin_to_key(pseudo_optional*, eosio::input_stream& bin, eosio::vector_stream& writer, bool,
+                       const abi_type* type, int depth) {
+    bool present;
+    from_bin(present, bin);
+    if (present)
+        element_to_key(bin, writer, type->optional_of(), depth + 1);
+    else
+        end_elements_to_key(writer, type->optional_of());
+}
+
+inline void bin_to_key(pseudo_extension*, eosio::input_stream& bin, eosio::vector_stream& writer, bool,
+                       const abi_type* type, int depth) {
+    element_to_key(bin, writer, type->extension_of(), depth + 1);
+}
+
+inline void bin_to_key(pseudo_object*, eosio::input_stream& bin, eosio::vector_stream& writer,
+                       bool allow_extensions, const abi_type* type, int depth) {
+    const std::vector<eosio::abi_field>& fields = type->as_struct()->fields;
+    for (auto& field : fields) {
+        if (bin.pos == bin.end && field.type->extension_of() && allow_extensions)
+            end_elements_to_key(writer, field.type->extension_of());
+        else
+            bin_to_key(bin, writer, allow_extensions && &field == &fields.back(), field.type, depth + 1);
+    }
+}
+
+inline void bin_to_key(pseudo_array*, eosio::input_stream& bin, eosio::vector_stream& writer, bool,
+                       const abi_type* type, int depth) {
+    uint32_t size;
+    varuint32_from_bin(size, bin);
+    for (uint32_t i = 0; i < size; ++i)
+        element_to_key(bin, writer, type->array_of(), depth + 1);
+    end_elements_to_key(writer, type->array_of());
+}
+
+inline void bin_to_key(pseudo_variant*, eosio::input_stream& bin, eosio::vector_stream& writer,
+                       bool allow_extensions, const abi_type* type, int depth) {
+    uint32_t index;
+    varuint32_from_bin(index, bin);
+    const std::vector<eosio::abi_field>& fields = *type->as_variant();
+    eosio::check(index < fields.size(), eosio::convert_stream_error(eosio::stream_error::bad_variant_index));
+    eosio::to_key_varuint32(index, writer);
+    bin_to_key(bin, writer, allow_extensions, fields[index].type, depth + 1);
+}
+
+template <typename T>
+void bin_to_key(T*, eosio::input_stream& bin, eosio::vector_stream& writer, bool, const abi_type*, int) {
+    if constexpr (std::is_same_v<T, varint32>) {
+        eosio::check(false, "varint32 has no key encoding");
+    } else {
+        T v;
+        from_bin(v, bin);
+        to_key(v, writer);
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// validate_bin
+///////////////////////////////////////////////////////////////////////////////
+
+// Moves bin past a value of type like skip_bin, but returns the error bin_to_json would throw for malformed data
+// instead of throwing it. Rejecting bad input this way costs about as much as accepting good input. depth counts the
+// enclosing structs, arrays and variants, which is what bin_to_json limits to max_stack_size.
+inline bin_error validate_bin(eosio::input_stream& bin, bool allow_extensions, const abi_type* type, int depth = 0) {
+    return type->ser->validate_bin(bin, allow_extensions, type, depth);
+}
+
+inline bin_error validate_bin(pseudo_optional*, eosio::input_stream& bin, bool allow_extensions, const abi_type* type,
+                              int depth) {
+    if (bin.pos == bin.end)
+        return eosio::stream_error::overrun;
+    if (!*bin.pos++)
+        return {};
+    return validate_bin(bin, allow_extensions, type->optional_of(), depth);
+}
+
+inline bin_error validate_bin(pseudo_extension*, eosio::input_stream& bin, bool allow_extensions, const abi_type* type,
+                              int depth) {
+    return validate_bin(bin, allow_extensions, type->extension_of(), depth);
+}
+
+inline bin_error validate_bin(pseudo_object*, eosio::input_stream& bin, bool allow_extensions, const abi_type* type,
+                              int depth) {
+    if (depth >= (int)max_stack_size)
+        return eosio::abi_error::recursion_limit_reached;
+    const std::vector<eosio::abi_field>& fields = type->as_struct()->fields;
+    for (auto& field : fields) {
+        if (bin.pos == bin.end && field.type->extension_of() && allow_extensions)
+            continue;
+        if (auto error = validate_bin(bin, allow_extensions && &field == &fields.back(), field.type, depth + 1))
+            return error;
+    }
+    return {};
+}
+
+inline bin_error validate_bin(pseudo_array*, eosio::input_stream& bin, bool, const abi_type* type, int depth) {
+    if (depth >= (int)max_stack_size)
+        return eosio::abi_error::recursion_limit_reached;
+    uint32_t size;
+    if (auto error = eosio::try_varuint32_from_bin(size, bin); error != eosio::stream_error::no_error)
+        return error;
+    for (uint32_t i = 0; i < size; ++i)
+        if (auto error = validate_bin(bin, false, type->array_of(), depth + 1))
+            return error;
+    return {};
+}
+
+inline bin_error validate_bin(pseudo_variant*, eosio::input_stream& bin, bool allow_extensions, const abi_type* type,
+                              int depth) {
+    if (depth >= (int)max_stack_size)
+        return eosio::abi_error::recursion_limit_reached;
+    uint32_t index;
+    if (auto error = eosio::try_varuint32_from_bin(index, bin); error != eosio::stream_error::no_error)
+        return error;
+    const std::vector<eosio::abi_field>& fields = *type->as_variant();
+    if (index >= fields.size())
+        return eosio::stream_error::bad_variant_index;
+    return validate_bin(bin, allow_extensions, fields[index].type, depth + 1);
+}
+
+template <typename T>
+bin_error validate_bin(T*, eosio::input_stream& bin, bool, const abi_type*, int) {
+    if constexpr (fixed_bin_size<T>() != 0) {
+        return eosio::try_skip(bin, fixed_bin_size<T>());
+    } else if constexpr (std::is_same_v<T, bytes>) {
+        uint64_t size;
+        if (auto error = eosio::try_varuint64_from_bin(size, bin); error != eosio::stream_error::no_error)
+            return error;
+        return eosio::try_skip(bin, size);
+    } else {
+        return eosio::validate_bin((T*)nullptr, bin);
+    }
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 // bin_to_json
 ///////////////////////////////////////////////////////////////////////////////
 
 template<typename F>
-inline void bin_to_json(eosio::input_stream& bin, const abi_type* type, std::string& dest, F&& f) {
+inline void bin_to_json(eosio::input_stream& bin, const abi_type* type, std::string& dest, F&& f,
+                        conversion_scratch& scratch) {
     // FIXME: Write directly to the string instead of creating an additional buffer
-    std::vector<char> buffer;
+    auto& buffer = scratch.out_buf;
+    buffer.clear();
     eosio::vector_stream writer{buffer};
     bin_to_json_state state{bin, writer};
+    scratch_loan stack{scratch.bin_to_json_stack, state.stack};
     type->ser->bin_to_json(state, true, type, true);
     while (!state.stack.empty()) {
         f();
@@ -898,7 +1600,13 @@ inline void bin_to_json(eosio::input_stream& bin, const abi_type* type, std::str
         eosio::check(state.stack.size() <= max_stack_size,
             eosio::convert_abi_error(eosio::abi_error::recursion_limit_reached));
     }
-    dest = std::string_view(writer.data.data(), writer.data.size());
+    dest.assign(writer.data.data(), writer.data.size());
+}
+
+template<typename F>
+inline void bin_to_json(eosio::input_stream& bin, const abi_type* type, std::string& dest, F&& f) {
+    conversion_scratch scratch;
+    bin_to_json(bin, type, dest, f, scratch);
 }
 
 inline void bin_to_json(bin_to_json_state& state, bool allow_extensions, const abi_type* type, bool start) {
@@ -1010,4 +1718,266 @@ auto bin_to_json(T* t, bin_to_json_state& state, bool, const abi_type*, bool sta
     return to_json(v, state.writer);
 }
 
+///////////////////////////////////////////////////////////////////////////////
+// bin_to_visitor
+///////////////////////////////////////////////////////////////////////////////
+
+// Structs, arrays, optionals, binary extensions and variants are walked by bin_to_visitor, never decoded as one value
+inline void bin_to_value(pseudo_optional*, eosio::input_stream&, bin_value&, std::vector<char>&) {
+    eosio::check(false, eosio::convert_abi_error(eosio::abi_error::bad_abi));
+}
+inline void bin_to_value(pseudo_extension*, eosio::input_stream&, bin_value&, std::vector<char>&) {
+    eosio::check(false, eosio::convert_abi_error(eosio::abi_error::bad_abi));
+}
+inline void bin_to_value(pseudo_object*, eosio::input_stream&, bin_value&, std::vector<char>&) {
+    eosio::check(false, eosio::convert_abi_error(eosio::abi_error::bad_abi));
+}
+inline void bin_to_value(pseudo_array*, eosio::input_stream&, bin_value&, std::vector<char>&) {
+    eosio::check(false, eosio::convert_abi_error(eosio::abi_error::bad_abi));
+}
+inline void bin_to_value(pseudo_variant*, eosio::input_stream&, bin_value&, std::vector<char>&) {
+    eosio::check(false, eosio::convert_abi_error(eosio::abi_error::bad_abi));
+}
+
+// Strings and bytes are left in bin. Values without a scalar form are written to buffer in their json string form.
+template <typename T>
+void bin_to_value(T*, eosio::input_stream& bin, bin_value& value, std::vector<char>& buffer) {
+    using kind = bin_value::kind_t;
+    if constexpr (std::is_same_v<T, std::string>) {
+        value.kind = kind::string;
+        from_bin(value.text, bin);
+    } else if constexpr (std::is_same_v<T, bytes>) {
+        uint64_t size;
+        varuint64_from_bin(size, bin);
+        const char* data;
+        bin.read_reuse_storage(data, size);
+        value.kind = kind::bytes;
+        value.text = {data, size};
+    } else {
+        T v;
+        from_bin(v, bin);
+        if constexpr (std::is_same_v<T, bool>) {
+            value.kind = kind::boolean;
+            value.uint64 = v;
+        } else if constexpr (std::is_integral_v<T> && sizeof(T) <= 8 && std::is_signed_v<T>) {
+            value.kind = kind::int64;
+            value.int64 = v;
+        } else if constexpr (std::is_integral_v<T> && sizeof(T) <= 8) {
+            value.kind = kind::uint64;
+            value.uint64 = v;
+        } else if constexpr (std::is_floating_point_v<T>) {
+            value.kind = kind::float64;
+            value.float64 = v;
+        } else if constexpr (std::is_same_v<T, varuint32>) {
+            value.kind = kind::uint64;
+            value.uint64 = v.value;
+        } else if constexpr (std::is_same_v<T, varint32>) {
+            value.kind = kind::int64;
+            value.int64 = v.value;
+        } else if constexpr (std::is_same_v<T, name>) {
+            value.kind = kind::name;
+            value.uint64 = v.value;
+        } else if constexpr (std::is_same_v<T, asset>) {
+            value.kind = kind::asset;
+            value.asset = v;
+        } else if constexpr (std::is_same_v<T, checksum160> || std::is_same_v<T, checksum256> ||
+                             std::is_same_v<T, checksum512>) {
+            auto raw = v.extract_as_byte_array();
+            buffer.assign(raw.begin(), raw.end());
+            value.kind = kind::checksum;
+            value.text = {buffer.data(), buffer.size()};
+        } else {
+            value.kind = kind::string;
+            value.text = json_string_form(v, buffer);
+        }
+    }
+}
+
+template <typename Handler, typename = void>
+struct visits_asset : std::false_type {};
+template <typename Handler>
+struct visits_asset<Handler, std::void_t<decltype(std::declval<Handler&>().asset(std::declval<const asset&>()))>>
+    : std::true_type {};
+
+template <typename Handler, typename = void>
+struct visits_checksum : std::false_type {};
+template <typename Handler>
+struct visits_checksum<Handler,
+                       std::void_t<decltype(std::declval<Handler&>().checksum(std::declval<std::string_view>()))>>
+    : std::true_type {};
+
+// Reports value to handler. Handlers without asset() or checksum() get those values through string().
+template <typename Handler>
+bool visit_value(const bin_value& value, Handler& handler, std::vector<char>& buffer) {
+    using kind = bin_value::kind_t;
+    switch (value.kind) {
+    case kind::boolean: return handler.boolean(value.uint64);
+    case kind::int64: return handler.int64(value.int64);
+    case kind::uint64: return handler.uint64(value.uint64);
+    case kind::float64: return handler.float64(value.float64);
+    case kind::name: return handler.name(value.uint64);
+    case kind::string: return handler.string(value.text);
+    case kind::bytes: return handler.bytes(value.text);
+    case kind::asset:
+        if constexpr (visits_asset<Handler>::value) {
+            return handler.asset(value.asset);
+        } else {
+            buffer.clear();
+            return handler.string(json_string_form(value.asset, buffer));
+        }
+    case kind::checksum:
+        if constexpr (visits_checksum<Handler>::value) {
+            return handler.checksum(value.text);
+        } else {
+            std::vector<char> hex;
+            eosio::vector_stream writer{hex};
+            eosio::to_json_hex(value.text.data(), value.text.size(), writer);
+            return handler.string({hex.data() + 1, hex.size() - 2});
+        }
+    }
+    return true;
+}
+
+template <typename Handler>
+struct bin_to_visitor_state {
+    eosio::input_stream& bin;
+    Handler& handler;
+    bin_value value{};
+    std::vector<char> buffer{};
+};
+
+// Walks a value of type like skip_bin and reports it to state.handler. Calls to the handler are direct, so a
+// concrete handler's events inline into the walk. depth counts the enclosing structs, arrays and variants.
+template <typename Handler>
+void bin_to_visitor(bin_to_visitor_state<Handler>& state, bool allow_extensions, const abi_type* type, int depth) {
+    auto& handler = state.handler;
+    if (std::holds_alternative<abi_type::builtin>(type->_data)) {
+        state.buffer.clear();
+        type->ser->bin_to_value(state.bin, state.value, state.buffer);
+        return check_visit(visit_value(state.value, handler, state.buffer));
+    }
+    if (auto* t = type->optional_of()) {
+        bool present;
+        from_bin(present, state.bin);
+        if (!present)
+            return check_visit(handler.null());
+        return bin_to_visitor(state, allow_extensions, t, depth);
+    }
+    if (auto* t = type->extension_of())
+        return bin_to_visitor(state, allow_extensions, t, depth);
+
+    eosio::check(depth < (int)max_stack_size, eosio::convert_abi_error(eosio::abi_error::recursion_limit_reached));
+    if (auto* t = type->array_of()) {
+        uint32_t size;
+        varuint32_from_bin(size, state.bin);
+        check_visit(handler.start_array(size));
+        for (uint32_t i = 0; i < size; ++i)
+            bin_to_visitor(state, false, t, depth + 1);
+        return check_visit(handler.end_array());
+    }
+    if (auto* s = type->as_struct()) {
+        check_visit(handler.start_object());
+        for (auto& field : s->fields) {
+            if (state.bin.pos == state.bin.end && field.type->extension_of() && allow_extensions)
+                continue;
+            check_visit(handler.key(field.name));
+            bin_to_visitor(state, allow_extensions && &field == &s->fields.back(), field.type, depth + 1);
+        }
+        return check_visit(handler.end_object());
+    }
+    auto* fields = type->as_variant();
+    eosio::check(fields != nullptr, eosio::convert_abi_error(eosio::abi_error::bad_abi));
+    uint32_t index;
+    varuint32_from_bin(index, state.bin);
+    eosio::check(index < fields->size(), eosio::convert_stream_error(eosio::stream_error::bad_variant_index));
+    auto& field = (*fields)[index];
+    check_visit(handler.start_variant(field.name));
+    bin_to_visitor(state, allow_extensions, field.type, depth + 1);
+    check_visit(handler.end_variant());
+}
+
+// Decodes bin as type and reports the values to handler instead of producing json. handler is anything with
+// bin_visitor's member functions; it need not derive from bin_visitor.
+template <typename Handler>
+void bin_to_visitor(eosio::input_stream& bin, const abi_type* type, Handler& handler) {
+    bin_to_visitor_state<Handler> state{bin, handler};
+    bin_to_visitor(state, true, type, 0);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// bin_to_json over a compiled_abi
+///////////////////////////////////////////////////////////////////////////////
+
+// Produces the same json as bin_to_json, but walks the compiled form of the type. depth counts the enclosing structs,
+// arrays and variants, which is what bin_to_json limits to max_stack_size. The caller holds compiled.mutex, shared.
+inline void bin_to_json(const eosio::compiled_abi& compiled, uint32_t index, bin_to_json_state& state,
+                        bool allow_extensions, int depth) {
+    using eosio::compiled_abi;
+    auto& type = compiled.types[index];
+    if (type.kind == compiled_abi::builtin)
+        return type.source->ser->bin_to_json(state, allow_extensions, type.source, true);
+    if (type.kind == compiled_abi::optional) {
+        bool present;
+        from_bin(present, state.bin);
+        if (!present)
+            return state.writer.write("null", 4);
+        return bin_to_json(compiled, type.first, state, allow_extensions, depth);
+    }
+    if (type.kind == compiled_abi::extension)
+        return bin_to_json(compiled, type.first, state, allow_extensions, depth);
+
+    eosio::check(depth < (int)max_stack_size, eosio::convert_abi_error(eosio::abi_error::recursion_limit_reached));
+    if (type.kind == compiled_abi::array) {
+        uint32_t size;
+        varuint32_from_bin(size, state.bin);
+        state.writer.write('[');
+        for (uint32_t i = 0; i < size; ++i) {
+            if (i)
+                state.writer.write(',');
+            bin_to_json(compiled, type.first, state, false, depth + 1);
+        }
+        return state.writer.write(']');
+    }
+    if (type.kind == compiled_abi::object) {
+        state.writer.write('{');
+        auto* fields = compiled.fields.data() + type.first;
+        for (uint32_t i = 0; i < type.count; ++i) {
+            auto& field = fields[i];
+            if (state.bin.pos == state.bin.end && allow_extensions &&
+                compiled.types[field.type].kind == compiled_abi::extension) {
+                state.skipped_extension = true;
+                continue;
+            }
+            if (i)
+                state.writer.write(',');
+            auto name = compiled.name(field);
+            state.writer.write(name.data(), name.size());
+            bin_to_json(compiled, field.type, state, allow_extensions && i + 1 == type.count, depth + 1);
+        }
+        return state.writer.write('}');
+    }
+    uint32_t alternative;
+    varuint32_from_bin(alternative, state.bin);
+    eosio::check(alternative < type.count, eosio::convert_stream_error(eosio::stream_error::bad_variant_index));
+    auto& field = compiled.fields[type.first + alternative];
+    auto name = compiled.name(field);
+    state.writer.write('[');
+    state.writer.write(name.data(), name.size());
+    bin_to_json(compiled, field.type, state, allow_extensions, depth + 1);
+    state.writer.write(']');
+}
+
+inline void bin_to_json(eosio::input_stream& bin, const eosio::compiled_abi& compiled, uint32_t index,
+                        std::string& dest, conversion_scratch& scratch) {
+    auto& buffer = scratch.out_buf;
+    buffer.clear();
+    eosio::vector_stream writer{buffer};
+    bin_to_json_state state{bin, writer};
+    {
+        std::shared_lock<std::shared_mutex> lock{*compiled.mutex};
+        bin_to_json(compiled, index, state, true, 0);
+    }
+    dest.assign(writer.data.data(), writer.data.size());
+}
+
 } // namespace abieos
@@ -0,0 +1,303 @@
+// copyright defined in abieos/LICENSE.txt
+
+#pragma once
+
+#include "abieos.hpp"
+
+#include <algorithm>
+
+namespace abieos {
+
+// One column of a column_batch. Buffers follow the Arrow columnar format, so they can be handed to an Arrow
+// implementation through the C data interface without conversion:
+//
+// - validity: one bit per row, least significant bit first; 1 means present. Empty when null_count is 0.
+// - offsets:  num_rows + 1 entries for binary, utf8 and list columns; empty for the rest. For binary and utf8 they
+//             are byte offsets into values, for lists they are element offsets into values.
+// - values:   little-endian fixed-width values (width bytes each), bit-packed booleans, the concatenated bytes of
+//             binary and utf8 columns, or the concatenated elements of list columns.
+//
+// format is the Arrow C data interface format string ("L" uint64, "b" bool, "z" binary, "u" utf8, "w:32" fixed
+// binary, "tsu:" timestamp[us], "+l" list). List columns describe their elements with element_format and width.
+struct column {
+    std::string name;
+    std::string format;
+    std::string element_format;
+    uint32_t width = 0;
+    size_t null_count = 0;
+    std::vector<uint8_t> validity;
+    std::vector<int32_t> offsets;
+    std::vector<char> values;
+};
+
+struct column_batch {
+    size_t num_rows = 0;
+    std::vector<column> columns;
+};
+
+// Decodes batches of binary rows of a single abi_type into columns.
+//
+// Struct fields are flattened into one column per leaf, named by their dotted path (e.g. "quantity.amount"; a
+// non-struct root is named "value"). Optional and binary extension fields mark their rows null in every column
+// beneath them. Assets split into "amount" (int64) and "symbol" (uint64) columns. Arrays of fixed-width values become
+// list columns. Arrays of other types, variants, public keys, signatures and bitsets become binary columns that hold
+// the value's abi serialization.
+//
+// Rows whose leaves are all fixed-width and never null share one layout; those batches are decoded a column at a
+// time with a fixed stride instead of walking each row.
+class column_decoder {
+  public:
+    explicit column_decoder(const abi_type* type) {
+        compile(type, "", true, true, 0);
+        fixed_layout = std::all_of(steps.begin(), steps.end(), [](auto& s) { return s.kind == step::fixed; });
+        if (fixed_layout) {
+            for (auto& s : steps) {
+                s.row_offset = row_size;
+                row_size += s.width;
+            }
+        }
+    }
+
+    // Column names and formats, without data
+    const std::vector<column>& schema() const { return columns; }
+
+    void decode(const eosio::input_stream* rows, size_t num_rows, column_batch& batch) const {
+        batch.num_rows = num_rows;
+        batch.columns = columns;
+        for (size_t i = 0; i < columns.size(); ++i)
+            prepare(steps[column_step[i]], batch.columns[i], num_rows);
+        if (fixed_layout) {
+            for (size_t r = 0; r < num_rows; ++r)
+                rows[r].check_available(row_size);
+            for (auto& s : steps)
+                decode_fixed_column(s, rows, num_rows, batch.columns[s.column].values.data());
+        } else {
+            for (size_t r = 0; r < num_rows; ++r) {
+                eosio::input_stream bin = rows[r];
+                decode_row(bin, r, batch);
+            }
+        }
+        for (auto& c : batch.columns)
+            if (!c.null_count)
+                c.validity.clear();
+    }
+
+    void decode(const std::vector<eosio::input_stream>& rows, column_batch& batch) const {
+        decode(rows.data(), rows.size(), batch);
+    }
+
+  private:
+    struct step {
+        enum kind_t { fixed, boolean, varuint32, varint32, binary, list, raw, optional, extension } kind = fixed;
+        uint32_t column = 0;
+        uint32_t width = 0;
+        uint32_t end_step = 0;
+        uint32_t end_column = 0;
+        uint32_t row_offset = 0;
+        bool allow_extensions = false;
+        const abi_type* type = nullptr;
+    };
+
+    std::vector<column> columns;
+    std::vector<step> steps;
+    std::vector<uint32_t> column_step;
+    bool fixed_layout = false;
+    uint32_t row_size = 0;
+
+    static std::string join(const std::string& path, const std::string& name) {
+        return path.empty() ? name : path + "." + name;
+    }
+
+    void add_leaf(const std::string& name, const char* format, step::kind_t kind, uint32_t width,
+                  const abi_type* type = nullptr, bool allow_extensions = false, const char* element_format = "") {
+        column_step.push_back(steps.size());
+        auto& s = steps.emplace_back();
+        s.kind = kind;
+        s.column = uint32_t(columns.size());
+        s.width = width;
+        s.type = type;
+        s.allow_extensions = allow_extensions;
+        auto& c = columns.emplace_back();
+        c.name = name.empty() ? "value" : name;
+        c.format = format;
+        c.element_format = element_format;
+        c.width = width;
+    }
+
+    // Format and width of builtin types that decode to one fixed-width value
+    static bool fixed_format(const std::string& type, const char*& format, uint32_t& width) {
+        static const std::pair<const char*, std::pair<const char*, uint32_t>> formats[] = {
+            {"int8", {"c", 1}},           {"uint8", {"C", 1}},           {"int16", {"s", 2}},
+            {"uint16", {"S", 2}},         {"int32", {"i", 4}},           {"uint32", {"I", 4}},
+            {"int64", {"l", 8}},          {"uint64", {"L", 8}},          {"float32", {"f", 4}},
+            {"float64", {"g", 8}},        {"name", {"L", 8}},            {"symbol", {"L", 8}},
+            {"symbol_code", {"L", 8}},    {"time_point", {"tsu:", 8}},   {"time_point_sec", {"I", 4}},
+            {"block_timestamp_type", {"I", 4}}, {"checksum160", {"w:20", 20}}, {"checksum256", {"w:32", 32}},
+            {"checksum512", {"w:64", 64}}, {"int128", {"w:16", 16}},    {"uint128", {"w:16", 16}},
+            {"float128", {"w:16", 16}},
+        };
+        for (auto& [n, f] : formats) {
+            if (type == n) {
+                format = f.first;
+                width = f.second;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // may_be_absent is the enclosing struct's allow_extensions, which decides whether a binary extension field may be
+    // missing; allow_extensions is passed on to the field's own value as bin_to_json does
+    void compile(const abi_type* type, const std::string& name, bool allow_extensions, bool may_be_absent,
+                 int depth) {
+        eosio::check(depth < (int)max_stack_size,
+                     eosio::convert_abi_error(eosio::abi_error::recursion_limit_reached));
+        const char* format;
+        uint32_t width;
+        if (auto* inner = type->optional_of(); inner || type->extension_of()) {
+            size_t index = steps.size();
+            auto& s = steps.emplace_back();
+            s.kind = inner ? step::optional : step::extension;
+            s.column = uint32_t(columns.size());
+            s.allow_extensions = may_be_absent;
+            compile(inner ? inner : type->extension_of(), name, allow_extensions, allow_extensions, depth + 1);
+            steps[index].end_step = steps.size();
+            steps[index].end_column = columns.size();
+        } else if (auto* s = type->as_struct()) {
+            for (auto& field : s->fields)
+                compile(field.type, join(name, field.name), allow_extensions && &field == &s->fields.back(),
+                        allow_extensions, depth + 1);
+        } else if (auto* element = type->array_of()) {
+            if (fixed_format(element->name, format, width) && std::holds_alternative<abi_type::builtin>(element->_data))
+                add_leaf(name, "+l", step::list, width, nullptr, false, format);
+            else
+                add_leaf(name, "z", step::raw, 0, type, false);
+        } else if (!std::holds_alternative<abi_type::builtin>(type->_data)) {
+            add_leaf(name, "z", step::raw, 0, type, allow_extensions);
+        } else if (fixed_format(type->name, format, width)) {
+            add_leaf(name, format, step::fixed, width);
+        } else if (type->name == "asset") {
+            add_leaf(join(name, "amount"), "l", step::fixed, 8);
+            add_leaf(join(name, "symbol"), "L", step::fixed, 8);
+        } else if (type->name == "bool") {
+            add_leaf(name, "b", step::boolean, 0);
+        } else if (type->name == "varuint32") {
+            add_leaf(name, "I", step::varuint32, 4);
+        } else if (type->name == "varint32") {
+            add_leaf(name, "i", step::varint32, 4);
+        } else if (type->name == "string") {
+            add_leaf(name, "u", step::binary, 0);
+        } else if (type->name == "bytes") {
+            add_leaf(name, "z", step::binary, 0);
+        } else {
+            add_leaf(name, "z", step::raw, 0, type, allow_extensions);
+        }
+    }
+
+    static void prepare(const step& s, column& c, size_t num_rows) {
+        c.validity.assign((num_rows + 7) / 8, 0xff);
+        switch (s.kind) {
+        case step::fixed:
+        case step::varuint32:
+        case step::varint32: c.values.assign(num_rows * s.width, 0); break;
+        case step::boolean: c.values.assign((num_rows + 7) / 8, 0); break;
+        default:
+            c.offsets.reserve(num_rows + 1);
+            c.offsets.push_back(0);
+            break;
+        }
+    }
+
+    // Stride loop over one column of a batch whose rows all share the fixed layout
+    static void decode_fixed_column(const step& s, const eosio::input_stream* rows, size_t num_rows, char* dest) {
+        const uint32_t width = s.width;
+        const uint32_t offset = s.row_offset;
+        for (size_t r = 0; r < num_rows; ++r)
+            memcpy(dest + r * width, rows[r].pos + offset, width);
+    }
+
+    static void set_null(column& c, size_t row) {
+        c.validity[row / 8] &= ~(1 << (row % 8));
+        ++c.null_count;
+        if (!c.offsets.empty())
+            c.offsets.push_back(c.offsets.back());
+    }
+
+    static int32_t to_offset(size_t size) {
+        eosio::check(size <= size_t(INT32_MAX), "column is too large for 32-bit offsets");
+        return int32_t(size);
+    }
+
+    void decode_row(eosio::input_stream& bin, size_t row, column_batch& batch) const {
+        for (size_t i = 0; i < steps.size();) {
+            auto& s = steps[i];
+            if (s.kind == step::optional || s.kind == step::extension) {
+                bool present;
+                if (s.kind == step::optional)
+                    from_bin(present, bin);
+                else
+                    present = !(bin.pos == bin.end && s.allow_extensions);
+                if (present) {
+                    ++i;
+                } else {
+                    for (uint32_t col = s.column; col < s.end_column; ++col)
+                        set_null(batch.columns[col], row);
+                    i = s.end_step;
+                }
+                continue;
+            }
+            auto& c = batch.columns[s.column];
+            switch (s.kind) {
+            case step::fixed: bin.read(c.values.data() + row * s.width, s.width); break;
+            case step::boolean: {
+                bool value;
+                from_bin(value, bin);
+                if (value)
+                    c.values[row / 8] |= 1 << (row % 8);
+                break;
+            }
+            case step::varuint32: {
+                uint32_t value;
+                varuint32_from_bin(value, bin);
+                memcpy(c.values.data() + row * 4, &value, 4);
+                break;
+            }
+            case step::varint32: {
+                int32_t value;
+                varint32_from_bin(value, bin);
+                memcpy(c.values.data() + row * 4, &value, 4);
+                break;
+            }
+            case step::binary: {
+                uint64_t size;
+                varuint64_from_bin(size, bin);
+                const char* data;
+                bin.read_reuse_storage(data, size);
+                c.values.insert(c.values.end(), data, data + size);
+                c.offsets.push_back(to_offset(c.values.size()));
+                break;
+            }
+            case step::list: {
+                uint32_t size;
+                varuint32_from_bin(size, bin);
+                const char* data;
+                bin.read_reuse_storage(data, uint64_t(size) * s.width);
+                c.values.insert(c.values.end(), data, data + uint64_t(size) * s.width);
+                c.offsets.push_back(to_offset(c.values.size() / s.width));
+                break;
+            }
+            case step::raw: {
+                auto begin = bin.pos;
+                skip_bin(bin, s.allow_extensions, s.type);
+                c.values.insert(c.values.end(), begin, bin.pos);
+                c.offsets.push_back(to_offset(c.values.size()));
+                break;
+            }
+            default: break;
+            }
+            ++i;
+        }
+    }
+};
+
+} // namespace abieos
@@ -0,0 +1,240 @@
+// copyright defined in abieos/LICENSE.txt
+
+#pragma once
+
+#include "abieos.hpp"
+
+namespace abieos {
+
+struct compact_options {
+    // Write names as their string form instead of their uint64 value
+    bool names_as_strings = false;
+};
+
+// Big-endian integer output shared by the cbor and msgpack writers
+inline void write_be(std::vector<char>& out, uint64_t value, int size) {
+    for (int i = size - 1; i >= 0; --i)
+        out.push_back(char(value >> (i * 8)));
+}
+
+// Writes bin_visitor events as CBOR (RFC 8949). Structs become indefinite-length maps keyed by field name, arrays
+// become definite-length arrays and variants become [alternative, value]. bytes and checksums are byte strings and
+// assets are maps {amount, precision, symbol}. Other types without a native CBOR form use their json string form.
+struct cbor_writer final : bin_visitor {
+    std::vector<char>& out;
+    compact_options options;
+
+    cbor_writer(std::vector<char>& out, compact_options options = {}) : out{out}, options{options} {}
+
+    void head(uint8_t major, uint64_t value) {
+        major <<= 5;
+        if (value < 24) {
+            out.push_back(char(major | value));
+        } else if (value <= 0xff) {
+            out.push_back(char(major | 24));
+            write_be(out, value, 1);
+        } else if (value <= 0xffff) {
+            out.push_back(char(major | 25));
+            write_be(out, value, 2);
+        } else if (value <= 0xffff'ffff) {
+            out.push_back(char(major | 26));
+            write_be(out, value, 4);
+        } else {
+            out.push_back(char(major | 27));
+            write_be(out, value, 8);
+        }
+    }
+    void text(std::string_view s) {
+        head(3, s.size());
+        out.insert(out.end(), s.begin(), s.end());
+    }
+
+    bool null() override { return out.push_back(char(0xf6)), true; }
+    bool boolean(bool value) override { return out.push_back(char(value ? 0xf5 : 0xf4)), true; }
+    bool int64(int64_t value) override {
+        if (value >= 0)
+            head(0, value);
+        else
+            head(1, ~uint64_t(value));
+        return true;
+    }
+    bool uint64(uint64_t value) override { return head(0, value), true; }
+    bool float64(double value) override {
+        uint64_t bits;
+        memcpy(&bits, &value, sizeof(bits));
+        out.push_back(char(0xfb));
+        write_be(out, bits, 8);
+        return true;
+    }
+    bool name(uint64_t value) override {
+        if (options.names_as_strings)
+            return text(eosio::name_to_string(value)), true;
+        return uint64(value);
+    }
+    bool string(std::string_view value) override { return text(value), true; }
+    bool bytes(std::string_view value) override {
+        head(2, value.size());
+        out.insert(out.end(), value.begin(), value.end());
+        return true;
+    }
+    bool checksum(std::string_view raw) override { return bytes(raw); }
+    bool asset(const eosio::asset& value) override {
+        head(5, 3);
+        text("amount");
+        int64(value.amount);
+        text("precision");
+        uint64(value.symbol.precision());
+        text("symbol");
+        text(value.symbol.code().to_string());
+        return true;
+    }
+    bool start_object() override { return out.push_back(char(0xbf)), true; }
+    bool key(std::string_view key) override { return text(key), true; }
+    bool end_object() override { return out.push_back(char(0xff)), true; }
+    bool start_array(uint32_t size) override { return head(4, size), true; }
+    bool end_array() override { return true; }
+    bool start_variant(std::string_view alternative) override {
+        head(4, 2);
+        return text(alternative), true;
+    }
+    bool end_variant() override { return true; }
+};
+
+// Writes bin_visitor events as MessagePack, using the same mapping as cbor_writer. Struct maps always use the map16
+// header so the field count can be filled in once the struct ends.
+struct msgpack_writer final : bin_visitor {
+    std::vector<char>& out;
+    compact_options options;
+    std::vector<std::pair<size_t, uint32_t>> maps{};
+
+    msgpack_writer(std::vector<char>& out, compact_options options = {}) : out{out}, options{options} {}
+
+    // Writes a length header; code8 is 0 for formats without an 8-bit length
+    void head(uint8_t fix, uint8_t fix_limit, uint8_t code8, uint8_t code16, uint64_t size) {
+        if (size < fix_limit) {
+            out.push_back(char(fix | size));
+        } else if (code8 && size <= 0xff) {
+            out.push_back(char(code8));
+            write_be(out, size, 1);
+        } else if (size <= 0xffff) {
+            out.push_back(char(code16));
+            write_be(out, size, 2);
+        } else {
+            eosio::check(size <= 0xffff'ffff, "msgpack length is too large");
+            out.push_back(char(code16 + 1));
+            write_be(out, size, 4);
+        }
+    }
+    void text(std::string_view s) {
+        head(0xa0, 32, 0xd9, 0xda, s.size());
+        out.insert(out.end(), s.begin(), s.end());
+    }
+
+    bool null() override { return out.push_back(char(0xc0)), true; }
+    bool boolean(bool value) override { return out.push_back(char(value ? 0xc3 : 0xc2)), true; }
+    bool int64(int64_t value) override {
+        if (value >= 0)
+            return uint64(value);
+        if (value >= -32) {
+            out.push_back(char(value));
+        } else if (value >= INT8_MIN) {
+            out.push_back(char(0xd0));
+            write_be(out, value, 1);
+        } else if (value >= INT16_MIN) {
+            out.push_back(char(0xd1));
+            write_be(out, value, 2);
+        } else if (value >= INT32_MIN) {
+            out.push_back(char(0xd2));
+            write_be(out, value, 4);
+        } else {
+            out.push_back(char(0xd3));
+            write_be(out, value, 8);
+        }
+        return true;
+    }
+    bool uint64(uint64_t value) override {
+        if (value < 0x80) {
+            out.push_back(char(value));
+        } else if (value <= 0xff) {
+            out.push_back(char(0xcc));
+            write_be(out, value, 1);
+        } else if (value <= 0xffff) {
+            out.push_back(char(0xcd));
+            write_be(out, value, 2);
+        } else if (value <= 0xffff'ffff) {
+            out.push_back(char(0xce));
+            write_be(out, value, 4);
+        } else {
+            out.push_back(char(0xcf));
+            write_be(out, value, 8);
+        }
+        return true;
+    }
+    bool float64(double value) override {
+        uint64_t bits;
+        memcpy(&bits, &value, sizeof(bits));
+        out.push_back(char(0xcb));
+        write_be(out, bits, 8);
+        return true;
+    }
+    bool name(uint64_t value) override {
+        if (options.names_as_strings)
+            return text(eosio::name_to_string(value)), true;
+        return uint64(value);
+    }
+    bool string(std::string_view value) override { return text(value), true; }
+    bool bytes(std::string_view value) override {
+        head(0, 0, 0xc4, 0xc5, value.size());
+        out.insert(out.end(), value.begin(), value.end());
+        return true;
+    }
+    bool checksum(std::string_view raw) override { return bytes(raw); }
+    bool asset(const eosio::asset& value) override {
+        out.push_back(char(0x83));
+        text("amount");
+        int64(value.amount);
+        text("precision");
+        uint64(value.symbol.precision());
+        text("symbol");
+        text(value.symbol.code().to_string());
+        return true;
+    }
+    bool start_object() override {
+        maps.push_back({out.size(), 0});
+        out.insert(out.end(), {char(0xde), 0, 0});
+        return true;
+    }
+    bool key(std::string_view key) override {
+        ++maps.back().second;
+        return text(key), true;
+    }
+    bool end_object() override {
+        auto [pos, count] = maps.back();
+        maps.pop_back();
+        eosio::check(count <= 0xffff, "msgpack map is too large");
+        out[pos + 1] = char(count >> 8);
+        out[pos + 2] = char(count);
+        return true;
+    }
+    bool start_array(uint32_t size) override { return head(0x90, 16, 0, 0xdc, size), true; }
+    bool end_array() override { return true; }
+    bool start_variant(std::string_view alternative) override {
+        out.push_back(char(0x92));
+        return text(alternative), true;
+    }
+    bool end_variant() override { return true; }
+};
+
+inline void bin_to_cbor(eosio::input_stream& bin, const abi_type* type, std::vector<char>& out,
+                        compact_options options = {}) {
+    cbor_writer writer{out, options};
+    bin_to_visitor(bin, type, writer);
+}
+
+inline void bin_to_msgpack(eosio::input_stream& bin, const abi_type* type, std::vector<char>& out,
+                           compact_options options = {}) {
+    msgpack_writer writer{out, options};
+    bin_to_visitor(bin, type, writer);
+}
+
+} // namespace abieos
@@ -0,0 +1,133 @@
+// copyright defined in abieos/LICENSE.txt
+
+#pragma once
+
+#include "abieos.hpp"
+
+#include <cstring>
+#include <list>
+#include <unordered_map>
+
+namespace abieos {
+
+// A fast 64-bit hash of data, 8 bytes at a time. It isn't resistant to crafted collisions, so users compare the bytes
+// as well.
+inline uint64_t hash_bytes(const char* data, size_t size, uint64_t seed) {
+    constexpr uint64_t mul = 0x9e37'79b9'7f4a'7c15;
+    uint64_t h = seed ^ (size * mul);
+    auto mix = [&](uint64_t v) {
+        h ^= v * mul;
+        h = ((h << 31) | (h >> 33)) * mul;
+    };
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8) {
+        uint64_t v;
+        memcpy(&v, data + i, 8);
+        mix(v);
+    }
+    if (i < size) {
+        uint64_t v = 0;
+        memcpy(&v, data + i, size - i);
+        mix(v);
+    }
+    h ^= h >> 33;
+    h *= 0xff51'afd7'ed55'8ccd;
+    h ^= h >> 33;
+    h *= 0xc4ce'b9fe'1a85'ec53;
+    h ^= h >> 33;
+    return h;
+}
+
+// Remembers the json bin_to_json produced for recent inputs, so that converting byte-identical data again costs a
+// hash, a comparison and a copy. Entries are keyed by contract, type and data. Once the data and json held pass
+// max_bytes, the least recently used entries are dropped. The cache is off while max_bytes is 0.
+//
+// Types are identified by address, so the cache must be cleared when a contract is deleted.
+class bin_to_json_cache {
+  public:
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+
+    bool enabled() const { return max_bytes; }
+    size_t size() const { return entries.size(); }
+    size_t bytes() const { return total_bytes; }
+
+    static uint64_t key_hash(name contract, const abi_type* type, std::string_view data) {
+        return hash_bytes(data.data(), data.size(), contract.value ^ uint64_t(reinterpret_cast<uintptr_t>(type)));
+    }
+
+    // Copies the json for data into dest. Returns false if it isn't cached.
+    bool find(uint64_t hash, name contract, const abi_type* type, std::string_view data, std::string& dest) {
+        auto it = index.find(hash);
+        if (it == index.end() || !it->second->matches(contract, type, data)) {
+            ++misses;
+            return false;
+        }
+        ++hits;
+        entries.splice(entries.begin(), entries, it->second);
+        dest.assign(it->second->json);
+        return true;
+    }
+
+    void insert(uint64_t hash, name contract, const abi_type* type, std::string_view data, std::string_view json) {
+        size_t cost = entry_cost(data, json);
+        if (cost > max_entry_bytes || cost > max_bytes)
+            return;
+        if (auto it = index.find(hash); it != index.end())
+            erase(it);
+        entries.push_front({hash, contract, type, std::string{data}, std::string{json}});
+        index.emplace(hash, entries.begin());
+        total_bytes += cost;
+        shrink();
+    }
+
+    // max_bytes of 0 turns the cache off and empties it
+    void set_limits(size_t max_bytes, size_t max_entry_bytes) {
+        this->max_bytes = max_bytes;
+        this->max_entry_bytes = max_entry_bytes;
+        shrink();
+    }
+
+    void clear() {
+        entries.clear();
+        index.clear();
+        total_bytes = 0;
+    }
+
+  private:
+    struct entry {
+        uint64_t hash;
+        name contract;
+        const abi_type* type;
+        std::string bin;
+        std::string json;
+
+        bool matches(name c, const abi_type* t, std::string_view data) const {
+            return c == contract && t == type && data == bin;
+        }
+    };
+
+    // What an entry holds, roughly counting the allocations around it
+    static size_t entry_cost(std::string_view data, std::string_view json) {
+        return data.size() + json.size() + sizeof(entry) + 64;
+    }
+
+    void erase(std::unordered_map<uint64_t, std::list<entry>::iterator>::iterator it) {
+        total_bytes -= entry_cost(it->second->bin, it->second->json);
+        entries.erase(it->second);
+        index.erase(it);
+    }
+
+    void shrink() {
+        while (total_bytes > max_bytes)
+            erase(index.find(entries.back().hash));
+    }
+
+    size_t max_bytes = 0;
+    size_t max_entry_bytes = 0;
+    size_t total_bytes = 0;
+    std::list<entry> entries; // most recently used first
+    std::unordered_map<uint64_t, std::list<entry>::iterator> index;
+};
+
+} // namespace abieos
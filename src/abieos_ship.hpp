@@ -0,0 +1,212 @@
+// copyright defined in abieos/LICENSE.txt
+
+#pragma once
+
+#include "abieos.hpp"
+
+#include <eosio/ship_pipeline.hpp>
+
+namespace abieos {
+
+// Keeps the abis of every contract up to date from a state-history stream and decodes action data and contract table
+// rows with them in the same pass.
+//
+// process() is given each block's transaction traces and table deltas in block order. eosio::setabi actions in
+// executed transactions install the new abi as soon as the action is reached, so later actions of the same block
+// already decode with it. Changes to the abi field of account deltas are applied before the block's contract rows are
+// decoded. Every abi a contract has had is kept with the block that installed it; a block number at or below one
+// already seen is a fork switch, and the versions installed by the forked-out blocks are dropped.
+class ship_abi_registry {
+  public:
+    struct abi_version {
+        uint32_t block_num = 0;
+        std::vector<char> raw;         // the abi as set on chain; empty when the contract has none
+        std::optional<eosio::abi> abi; // null when raw is empty or couldn't be parsed
+        std::string error;             // why raw couldn't be parsed
+    };
+
+    // An action trace with its data decoded by the account's abi
+    struct decoded_action {
+        const eosio::ship_protocol::action* act = nullptr;
+        name receiver;
+        uint32_t action_ordinal = 0;
+        const abi_type* type = nullptr; // null when the account has no abi for the action
+        std::string json;               // act->data as json when it decoded
+        std::string error;              // set when the data doesn't match type
+    };
+
+    // A contract table row with its value decoded by the code's abi
+    struct decoded_row {
+        bool present = false;
+        const eosio::ship_protocol::contract_row_v0* row = nullptr;
+        const abi_type* type = nullptr; // null when the code has no abi for the table
+        std::string json;               // row->value as json when it decoded
+        std::string error;              // set when the value doesn't match type
+    };
+
+    // Installs abi as contract's abi from block_num on. An empty abi removes the contract's abi.
+    void set_abi(name contract, uint32_t block_num, eosio::input_stream abi) {
+        auto& versions = contracts[contract];
+        if (!versions.empty() && versions.rbegin()->second.raw == std::vector<char>{abi.pos, abi.end})
+            return;
+        auto& v = versions[block_num];
+        v = abi_version{};
+        v.block_num = block_num;
+        v.raw.assign(abi.pos, abi.end);
+        if (abi.pos == abi.end)
+            return;
+        try {
+            abi_def_view def{};
+            auto bin = abi;
+            from_bin(def, bin);
+            if (!check_abi_version(def.version, v.error))
+                return;
+            convert(def, v.abi.emplace());
+        } catch (std::exception& e) {
+            v.abi.reset();
+            v.error = e.what();
+        }
+    }
+
+    // The abi version in effect for contract at block_num, or null if there is none
+    const abi_version* get(name contract, uint32_t block_num = UINT32_MAX) const {
+        return find(contracts, contract, block_num);
+    }
+
+    // As above, for decoding: abi::get_type adds the optional, array and extension types it is asked for
+    abi_version* get(name contract, uint32_t block_num = UINT32_MAX) { return find(contracts, contract, block_num); }
+
+    // Drops versions that can no longer be needed once irreversible_block is irreversible, keeping the version in
+    // effect at irreversible_block and everything after it
+    void prune(uint32_t irreversible_block) {
+        for (auto& [_, versions] : contracts) {
+            auto v = versions.upper_bound(irreversible_block);
+            if (v != versions.begin())
+                versions.erase(versions.begin(), --v);
+        }
+    }
+
+    // Applies the abi changes of one block and calls on_action(const decoded_action&) for each action trace of its
+    // executed transactions and on_row(const decoded_row&) for each contract_row delta
+    template <typename OnAction, typename OnRow>
+    void process(uint32_t block_num, const std::vector<eosio::ship_protocol::transaction_trace>& traces,
+                 const std::vector<eosio::ship_protocol::table_delta>& deltas, OnAction on_action, OnRow on_row) {
+        using namespace eosio::ship_protocol;
+        if (block_num <= last_block)
+            rollback(block_num);
+        last_block = block_num;
+
+        for (auto& trace : traces) {
+            auto& t = std::get<transaction_trace_v0>(trace);
+            if (t.status != transaction_status::executed)
+                continue;
+            for (auto& action_trace : t.action_traces) {
+                std::visit(
+                    [&](auto& at) {
+                        decoded_action d;
+                        d.act = &at.act;
+                        d.receiver = at.receiver;
+                        d.action_ordinal = at.action_ordinal.value;
+                        decode(d, block_num, at.act.account, at.act.data, &eosio::abi::action_types, at.act.name);
+                        on_action(static_cast<const decoded_action&>(d));
+                        if (at.receiver == eosio_account && at.act.account == eosio_account &&
+                            at.act.name == setabi_action) {
+                            auto data = at.act.data;
+                            name account;
+                            eosio::input_stream abi;
+                            from_bin(account, data);
+                            from_bin(abi, data);
+                            set_abi(account, block_num, abi);
+                        }
+                    },
+                    action_trace);
+            }
+        }
+
+        for (auto& delta : deltas) {
+            auto& d = std::get<table_delta_v0>(delta);
+            if (d.name != "account")
+                continue;
+            for (auto& row : d.rows) {
+                auto data = row.data;
+                account a;
+                from_bin(a, data);
+                auto& acc = std::get<account_v0>(a);
+                set_abi(acc.name, block_num, row.present ? acc.abi : eosio::input_stream{});
+            }
+        }
+        for (auto& delta : deltas) {
+            auto& d = std::get<table_delta_v0>(delta);
+            if (d.name != "contract_row")
+                continue;
+            for (auto& row : d.rows) {
+                auto data = row.data;
+                contract_row r;
+                from_bin(r, data);
+                auto& cr = std::get<contract_row_v0>(r);
+                decoded_row dr;
+                dr.present = row.present;
+                dr.row = &cr;
+                decode(dr, block_num, cr.code, cr.value, &eosio::abi::table_types, cr.table);
+                on_row(static_cast<const decoded_row&>(dr));
+            }
+        }
+    }
+
+    // Processes a result returned by eosio::ship_protocol::block_decoder; results without a block are ignored
+    template <typename OnAction, typename OnRow>
+    void process(const eosio::ship_protocol::decoded_result& r, OnAction on_action, OnRow on_row) {
+        using namespace eosio::ship_protocol;
+        const get_blocks_result_v0* blocks = std::get_if<get_blocks_result_v0>(&r.result);
+        if (auto* v1 = std::get_if<get_blocks_result_v1>(&r.result))
+            blocks = v1;
+        if (blocks && blocks->this_block)
+            process(blocks->this_block->block_num, r.traces, r.deltas, on_action, on_row);
+    }
+
+  private:
+    static constexpr name eosio_account{"eosio"};
+    static constexpr name setabi_action{"setabi"};
+
+    std::map<name, std::map<uint32_t, abi_version>> contracts;
+    uint32_t last_block = 0;
+
+    // Shared by both overloads of get(); Contracts is contracts, const or not
+    template <typename Contracts>
+    static auto find(Contracts& contracts, name contract, uint32_t block_num)
+        -> decltype(&contracts.begin()->second.begin()->second) {
+        auto it = contracts.find(contract);
+        if (it == contracts.end())
+            return nullptr;
+        auto v = it->second.upper_bound(block_num);
+        if (v == it->second.begin())
+            return nullptr;
+        return &(--v)->second;
+    }
+
+    void rollback(uint32_t block_num) {
+        for (auto& [_, versions] : contracts)
+            versions.erase(versions.lower_bound(block_num), versions.end());
+    }
+
+    // Looks up the type for key in one of the abi's maps (action_types or table_types) and decodes bin with it
+    template <typename D>
+    void decode(D& d, uint32_t block_num, name contract, eosio::input_stream bin,
+                std::map<name, std::string> eosio::abi::*types, name key) {
+        auto* v = get(contract, block_num);
+        if (!v || !v->abi)
+            return;
+        auto& abi = *v->abi;
+        auto it = (abi.*types).find(key);
+        if (it == (abi.*types).end())
+            return;
+        try {
+            d.type = abi.get_type(it->second);
+            d.json = d.type->bin_to_json(bin);
+        } catch (std::exception& e) {
+            d.error = e.what();
+        }
+    }
+};
+
+} // namespace abieos
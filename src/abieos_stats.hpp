@@ -0,0 +1,246 @@
+// copyright defined in abieos/LICENSE.txt
+
+#pragma once
+
+#include "abieos.hpp"
+
+#include <array>
+#include <chrono>
+#include <map>
+#include <tuple>
+
+namespace abieos {
+
+// The C API calls which are counted
+enum class stats_operation : uint8_t {
+    json_to_bin,
+    bin_to_json,
+    bin_to_cbor,
+    bin_to_msgpack,
+    bin_to_key,
+    bin_to_visitor,
+    validate_bin,
+};
+
+#ifdef ABIEOS_NO_STATS
+
+// Built without stats: these do nothing and compile away
+struct stats_registry {
+    void forget_types() {}
+};
+
+struct stats_scope {
+    stats_scope(stats_registry&, stats_operation, uint64_t, size_t) {}
+    void set_type(const abi_type*) {}
+    void succeeded(size_t) {}
+};
+
+#else
+
+inline constexpr const char* stats_operation_names[] = {
+    "json_to_bin", "bin_to_json", "bin_to_cbor", "bin_to_msgpack", "bin_to_key", "bin_to_visitor", "validate_bin",
+};
+
+// Latencies are kept in a log-linear histogram: one bucket for each of 0-3 ns, then each power of two is split into 4
+// equal buckets, so a bucket is at most 25% wide. Latencies of 2^40 ns (18 minutes) and up share the last bucket.
+inline constexpr int latency_sub_bucket_bits = 2;
+inline constexpr int latency_max_exponent = 40;
+inline constexpr size_t num_latency_buckets = (latency_max_exponent - latency_sub_bucket_bits + 1)
+                                              << latency_sub_bucket_bits;
+
+inline size_t latency_bucket(uint64_t ns) {
+    constexpr uint64_t sub_buckets = 1 << latency_sub_bucket_bits;
+    if (ns < sub_buckets)
+        return ns;
+    int exponent = 63 - __builtin_clzll(ns);
+    if (exponent >= latency_max_exponent)
+        return num_latency_buckets - 1;
+    uint64_t sub_bucket = (ns >> (exponent - latency_sub_bucket_bits)) & (sub_buckets - 1);
+    return ((exponent - latency_sub_bucket_bits + 1) << latency_sub_bucket_bits) + sub_bucket;
+}
+
+// The smallest latency which falls in bucket
+inline uint64_t latency_bucket_start(size_t bucket) {
+    constexpr uint64_t sub_buckets = 1 << latency_sub_bucket_bits;
+    if (bucket < sub_buckets)
+        return bucket;
+    int exponent = (bucket >> latency_sub_bucket_bits) + latency_sub_bucket_bits - 1;
+    return (sub_buckets + (bucket & (sub_buckets - 1))) << (exponent - latency_sub_bucket_bits);
+}
+
+// Reading the clock costs as much as a small conversion, so only about one call in time_sample_interval is timed.
+// Every call is counted.
+inline constexpr uint32_t time_sample_interval = 32;
+
+// Counters for one operation on one type. nanoseconds and latency cover the timed calls.
+struct conversion_stats {
+    uint64_t calls = 0;
+    uint64_t input_bytes = 0;
+    uint64_t output_bytes = 0;
+    uint64_t errors = 0;
+    uint64_t timed_calls = 0;
+    uint64_t nanoseconds = 0;
+    std::array<uint64_t, num_latency_buckets> latency{};
+
+    void record(size_t input_size, size_t output_size, bool error) {
+        ++calls;
+        input_bytes += input_size;
+        output_bytes += output_size;
+        errors += error;
+    }
+
+    void record_time(uint64_t ns) {
+        ++timed_calls;
+        nanoseconds += ns;
+        ++latency[latency_bucket(ns)];
+    }
+};
+
+// The counters of a context, by contract, type and operation. Collection is off until enabled is set. A type is looked
+// up by name the first time it is seen and by its abi_type after that, so counting a call doesn't allocate. Calls whose
+// contract or type wasn't found share one entry per operation, with an empty contract and type, so that callers passing
+// arbitrary names can't grow the registry.
+class stats_registry {
+  public:
+    bool enabled = false;
+
+    conversion_stats& get(name contract, const abi_type* type, stats_operation op) {
+        if (!type)
+            return stats.try_emplace(key{name{}, std::string{}, op}).first->second;
+        if (type == last_type && op == last_op)
+            return *last;
+        auto it = by_type.find({type, op});
+        if (it != by_type.end())
+            return remember(type, op, *it->second);
+        auto& result = stats.try_emplace(key{contract, type->name, op}).first->second;
+        by_type.emplace(std::pair{type, op}, &result);
+        return remember(type, op, result);
+    }
+
+    // Picks the calls to time at random, so that calls which alternate in a fixed pattern are all sampled
+    bool should_time() {
+        sample_state ^= sample_state << 13;
+        sample_state ^= sample_state >> 17;
+        sample_state ^= sample_state << 5;
+        return sample_state % time_sample_interval == 0;
+    }
+
+    // Call when types are destroyed, since a new type may reuse the address of an old one
+    void forget_types() {
+        by_type.clear();
+        last_type = nullptr;
+    }
+
+    void reset() {
+        forget_types();
+        stats.clear();
+    }
+
+    void to_json(std::string& dest) const {
+        dest = "[";
+        for (auto& [k, s] : stats) {
+            if (dest.size() > 1)
+                dest += ',';
+            dest += R"({"contract":")" + eosio::name_to_string(k.contract.value) + R"(","type":)";
+            eosio::vector_stream type_json{json_buffer};
+            json_buffer.clear();
+            eosio::to_json(k.type, type_json);
+            dest.append(json_buffer.data(), json_buffer.size());
+            dest += R"(,"operation":")" + std::string{stats_operation_names[int(k.operation)]} + '"';
+            dest += ",\"calls\":" + std::to_string(s.calls);
+            dest += ",\"input_bytes\":" + std::to_string(s.input_bytes);
+            dest += ",\"output_bytes\":" + std::to_string(s.output_bytes);
+            dest += ",\"errors\":" + std::to_string(s.errors);
+            dest += ",\"timed_calls\":" + std::to_string(s.timed_calls);
+            dest += ",\"nanoseconds\":" + std::to_string(s.nanoseconds);
+            // [start of bucket in ns, count] for the buckets which aren't empty
+            dest += ",\"latency\":[";
+            bool first = true;
+            for (size_t b = 0; b < s.latency.size(); ++b) {
+                if (!s.latency[b])
+                    continue;
+                dest += first ? "[" : ",[";
+                dest += std::to_string(latency_bucket_start(b)) + ',' + std::to_string(s.latency[b]) + ']';
+                first = false;
+            }
+            dest += "]}";
+        }
+        dest += ']';
+    }
+
+  private:
+    struct key {
+        name contract;
+        std::string type;
+        stats_operation operation;
+
+        bool operator<(const key& rhs) const {
+            return std::tie(contract.value, type, operation) < std::tie(rhs.contract.value, rhs.type, rhs.operation);
+        }
+    };
+
+    conversion_stats& remember(const abi_type* type, stats_operation op, conversion_stats& s) {
+        last_type = type;
+        last_op = op;
+        last = &s;
+        return s;
+    }
+
+    std::map<key, conversion_stats> stats;
+    std::map<std::pair<const abi_type*, stats_operation>, conversion_stats*> by_type;
+    const abi_type* last_type = nullptr;
+    stats_operation last_op{};
+    conversion_stats* last = nullptr;
+    uint32_t sample_state = 1;
+    mutable std::vector<char> json_buffer;
+};
+
+// Times a C API call and counts it when it goes out of scope. A call which doesn't reach succeeded, including one
+// which throws, counts as an error.
+class stats_scope {
+  public:
+    stats_scope(stats_registry& registry, stats_operation op, uint64_t contract, size_t input_size)
+        : registry{registry}, op{op}, contract{contract}, input_size{input_size}, active{registry.enabled},
+          timed{active && registry.should_time()} {
+        if (timed)
+            start = std::chrono::steady_clock::now();
+    }
+
+    stats_scope(const stats_scope&) = delete;
+    stats_scope& operator=(const stats_scope&) = delete;
+
+    ~stats_scope() {
+        if (!active)
+            return;
+        try {
+            auto& s = registry.get(contract, type, op);
+            s.record(input_size, output_size, error);
+            if (timed)
+                s.record_time(std::chrono::nanoseconds{std::chrono::steady_clock::now() - start}.count());
+        } catch (...) {
+        }
+    }
+
+    void set_type(const abi_type* t) { type = t; }
+
+    void succeeded(size_t size) {
+        output_size = size;
+        error = false;
+    }
+
+  private:
+    stats_registry& registry;
+    stats_operation op;
+    name contract;
+    const abi_type* type = nullptr;
+    size_t input_size;
+    size_t output_size = 0;
+    bool error = true;
+    bool active;
+    bool timed;
+    std::chrono::steady_clock::time_point start;
+};
+
+#endif
+
+} // namespace abieos
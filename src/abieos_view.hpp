@@ -0,0 +1,195 @@
+// copyright defined in abieos/LICENSE.txt
+
+#pragma once
+
+#include "abieos.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <map>
+#include <optional>
+
+namespace abieos {
+
+// Locates values inside serialized data by path without decoding the rest of it. Lookups skip only the values in
+// front of the one requested, and the start positions found along the way are kept so that later lookups into the
+// same data start from them. This is the dynamic-abi counterpart of eosio::opaque<T>.
+//
+// A path is a list of field names and array indexes separated by '.', e.g. "act.name" or "actions.0.account".
+// Optionals and variants are entered transparently: a path into an action_trace resolves against whichever
+// alternative is present, and a null optional or missing binary extension makes the value absent.
+class bin_view {
+  public:
+    struct value {
+        const abi_type* type = nullptr; // null when the value is absent
+        eosio::input_stream bin;        // starts at the value
+    };
+
+    bin_view(const abi_type* type, eosio::input_stream bin) : type{type}, bin{bin} {}
+
+    value find(std::string_view path) {
+        const abi_type* t = type;
+        const char* pos = bin.pos;
+        bool allow_extensions = true;
+        bool may_be_absent = true;
+        for (int depth = 0;; ++depth) {
+            eosio::check(depth < (int)max_stack_size,
+                         eosio::convert_abi_error(eosio::abi_error::recursion_limit_reached));
+            if (!unwrap(t, pos, may_be_absent))
+                return {};
+            if (path.empty())
+                return {t, {pos, bin.end}};
+            auto dot = path.find('.');
+            auto segment = path.substr(0, dot);
+            path = dot == std::string_view::npos ? std::string_view{} : path.substr(dot + 1);
+            if (auto* s = t->as_struct()) {
+                auto& fields = s->fields;
+                auto it = std::find_if(fields.begin(), fields.end(), [&](auto& f) { return f.name == segment; });
+                eosio::check(it != fields.end(), "unknown field \"" + std::string{segment} + "\" in " + t->name);
+                size_t index = it - fields.begin();
+                auto& starts = known_starts(t, pos);
+                while (starts.size() <= index) {
+                    size_t i = starts.size() - 1;
+                    eosio::input_stream field_bin{starts.back(), bin.end};
+                    if (!(field_bin.pos == field_bin.end && fields[i].type->extension_of() && allow_extensions))
+                        skip_bin(field_bin, allow_extensions && i == fields.size() - 1, fields[i].type);
+                    starts.push_back(field_bin.pos);
+                }
+                pos = starts[index];
+                may_be_absent = allow_extensions;
+                allow_extensions = allow_extensions && index == fields.size() - 1;
+                t = it->type;
+            } else if (auto* element = t->array_of()) {
+                uint32_t index;
+                auto [_, ec] = std::from_chars(segment.data(), segment.data() + segment.size(), index);
+                eosio::check(ec == std::errc{} && !segment.empty(), "expected array index in path");
+                eosio::input_stream array_bin{pos, bin.end};
+                uint32_t size;
+                varuint32_from_bin(size, array_bin);
+                if (index >= size)
+                    return {};
+                auto& starts = known_starts(t, pos, array_bin.pos);
+                while (starts.size() <= index) {
+                    eosio::input_stream element_bin{starts.back(), bin.end};
+                    skip_bin(element_bin, false, element);
+                    starts.push_back(element_bin.pos);
+                }
+                pos = starts[index];
+                allow_extensions = may_be_absent = false;
+                t = element;
+            } else {
+                eosio::check(false, "path continues past " + t->name);
+            }
+        }
+    }
+
+    // Returns the value at path, or nullopt when it is absent. T must match the value's abi type.
+    template <typename T>
+    std::optional<T> get(std::string_view path) {
+        auto v = find(path);
+        if (!v.type)
+            return std::nullopt;
+        eosio::check(v.type->name == eosio::get_type_name((T*)nullptr),
+                     "field is " + v.type->name + ", not " + eosio::get_type_name((T*)nullptr));
+        T result;
+        from_bin(result, v.bin);
+        return result;
+    }
+
+    // Returns unsigned integers, names, symbols, bools and timestamps at path as uint64, or nullopt when absent
+    std::optional<uint64_t> get_u64(std::string_view path) {
+        auto v = find(path);
+        if (!v.type)
+            return std::nullopt;
+        auto& n = v.type->name;
+        if (n == "uint64" || n == "name" || n == "symbol" || n == "symbol_code")
+            return read_le<uint64_t>(v.bin);
+        if (n == "uint32" || n == "time_point_sec" || n == "block_timestamp_type")
+            return read_le<uint32_t>(v.bin);
+        if (n == "uint16")
+            return read_le<uint16_t>(v.bin);
+        if (n == "uint8" || n == "bool")
+            return read_le<uint8_t>(v.bin);
+        if (n == "varuint32") {
+            uint32_t result;
+            varuint32_from_bin(result, v.bin);
+            return result;
+        }
+        int64_t result;
+        if (n == "int64" || n == "time_point")
+            result = read_le<int64_t>(v.bin);
+        else if (n == "int32")
+            result = read_le<int32_t>(v.bin);
+        else if (n == "int16")
+            result = read_le<int16_t>(v.bin);
+        else if (n == "int8")
+            result = read_le<int8_t>(v.bin);
+        else if (n == "varint32") {
+            int32_t x;
+            varint32_from_bin(x, v.bin);
+            result = x;
+        } else
+            eosio::check(false, "field is " + n + ", not an integer");
+        eosio::check(result >= 0, "field is negative");
+        return result;
+    }
+
+    // Returns the json form of the value at path, or nullopt when absent
+    std::optional<std::string> get_json(std::string_view path) {
+        auto v = find(path);
+        if (!v.type)
+            return std::nullopt;
+        return v.type->bin_to_json(v.bin);
+    }
+
+  private:
+    const abi_type* type;
+    eosio::input_stream bin;
+    std::map<std::pair<const char*, const abi_type*>, std::vector<const char*>> starts;
+
+    // Start positions of a struct's fields or an array's elements found so far, beginning with the first one
+    std::vector<const char*>& known_starts(const abi_type* t, const char* pos, const char* first = nullptr) {
+        auto& result = starts[{pos, t}];
+        if (result.empty())
+            result.push_back(first ? first : pos);
+        return result;
+    }
+
+    template <typename T>
+    static T read_le(eosio::input_stream& s) {
+        T result;
+        s.read_raw(result);
+        return result;
+    }
+
+    // Steps into optionals, binary extensions and variants. Returns false when the value is absent.
+    bool unwrap(const abi_type*& t, const char*& pos, bool may_be_absent) {
+        for (;;) {
+            if (auto* inner = t->optional_of()) {
+                eosio::input_stream s{pos, bin.end};
+                bool present;
+                from_bin(present, s);
+                pos = s.pos;
+                if (!present)
+                    return false;
+                t = inner;
+            } else if (auto* inner = t->extension_of()) {
+                if (pos == bin.end && may_be_absent)
+                    return false;
+                t = inner;
+            } else if (auto* alternatives = t->as_variant()) {
+                eosio::input_stream s{pos, bin.end};
+                uint32_t index;
+                varuint32_from_bin(index, s);
+                eosio::check(index < alternatives->size(),
+                             eosio::convert_stream_error(eosio::stream_error::bad_variant_index));
+                pos = s.pos;
+                t = (*alternatives)[index].type;
+            } else {
+                return true;
+            }
+        }
+    }
+};
+
+} // namespace abieos
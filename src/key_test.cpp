@@ -1,4 +1,5 @@
 #include <eosio/to_key.hpp>
+#include <eosio/to_key_batch.hpp>
 #include "abieos.hpp"
 
 int error_count;
@@ -212,7 +213,162 @@ void test_compare() {
    test_key(struct_type{{0, 1, 2}, 0, {0}}, struct_type{{0, 1, 2}, 0, {0.0}});
 }
 
+// The keys of vectors and arrays as to_key_optional and to_key write their elements one at a time
+template<typename T>
+std::vector<char> reference_key(const std::vector<T>& v) {
+   std::vector<char> result;
+   eosio::vector_stream stream{result};
+   for (auto& elem : v) eosio::to_key_optional(&elem, stream);
+   eosio::to_key_optional((const T*)nullptr, stream);
+   return result;
+}
+
+template<typename T, std::size_t N>
+std::vector<char> reference_key(const std::array<T, N>& a) {
+   std::vector<char> result;
+   eosio::vector_stream stream{result};
+   for (auto& elem : a) to_key(elem, stream);
+   return result;
+}
+
+// Random values with many zeros and sign bits, which need escaping or special handling (-0.0)
+template<typename T>
+T random_span_value(uint64_t& x) {
+   x = x * 6364136223846793005 + 1442695040888963407;
+   uint64_t bits = x % 4 == 0 ? 0 : x % 4 == 1 ? uint64_t(1) << (sizeof(T) * 8 - 1) : x >> 8;
+   if constexpr (std::is_same_v<T, name>) {
+      return name{bits};
+   } else {
+      T result;
+      memcpy(&result, &bits, sizeof(T));
+      return result;
+   }
+}
+
+// Verifies that the span kernels produce the same keys as encoding the elements one at a time
+template<typename T>
+void test_key_span(uint64_t& x) {
+   for (std::size_t n : {0, 1, 3, 31, 32, 33, 100, 1000, 5000}) {
+      std::vector<T> v(n);
+      for (auto& elem : v) elem = random_span_value<T>(x);
+      CHECK(eosio::convert_to_key(v) == reference_key(v));
+      CHECK(key_size(v) == reference_key(v).size());
+   }
+   std::array<T, 77> a{};
+   for (auto& elem : a) elem = random_span_value<T>(x);
+   CHECK(eosio::convert_to_key(a) == reference_key(a));
+   CHECK(key_size(a) == reference_key(a).size());
+}
+
+// The portable kernels are only used on cpus without AVX2, so compare them directly
+template<typename U>
+void test_portable_key_kernels(uint64_t& x) {
+   std::vector<U> v(1000);
+   for (auto& elem : v) elem = random_span_value<U>(x);
+   std::vector<char> expected(v.size() * sizeof(U)), portable(v.size() * sizeof(U));
+   eosio::to_key_detail::integer_keys(v.data(), v.size(), U(5), expected.data());
+   eosio::to_key_detail::integer_keys_portable(v.data(), v.size(), U(5), portable.data());
+   CHECK(portable == expected);
+   if constexpr (sizeof(U) >= 4) {
+      eosio::to_key_detail::float_keys(v.data(), v.size(), expected.data());
+      eosio::to_key_detail::float_keys_portable(v.data(), v.size(), portable.data());
+      CHECK(portable == expected);
+   }
+   if constexpr (sizeof(U) == 1) {
+      expected.resize(2 * v.size());
+      portable.resize(2 * v.size());
+      auto size = eosio::to_key_detail::escaped_byte_keys(v.data(), v.size(), 0x80, expected.data());
+      CHECK(eosio::to_key_detail::escaped_byte_keys_portable(v.data(), v.size(), 0x80, portable.data()) == size);
+      CHECK(portable == expected);
+   }
+}
+
+void test_key_spans() {
+   uint64_t x = 1;
+   test_key_span<uint8_t>(x);
+   test_key_span<int8_t>(x);
+   test_key_span<char>(x);
+   test_key_span<enum_u8>(x);
+   test_key_span<enum_s8>(x);
+   test_key_span<uint16_t>(x);
+   test_key_span<int16_t>(x);
+   test_key_span<enum_s16>(x);
+   test_key_span<uint32_t>(x);
+   test_key_span<int32_t>(x);
+   test_key_span<uint64_t>(x);
+   test_key_span<int64_t>(x);
+   test_key_span<float>(x);
+   test_key_span<double>(x);
+   test_key_span<name>(x);
+   test_portable_key_kernels<uint8_t>(x);
+   test_portable_key_kernels<uint16_t>(x);
+   test_portable_key_kernels<uint32_t>(x);
+   test_portable_key_kernels<uint64_t>(x);
+}
+
+struct fixed_struct_type {
+   name     n;
+   uint32_t i;
+   enum_s8  e;
+};
+EOSIO_REFLECT(fixed_struct_type, n, i, e);
+EOSIO_COMPARE(fixed_struct_type);
+
+static_assert(eosio::fixed_key_size((uint64_t*)nullptr) == 8);
+static_assert(eosio::fixed_key_size((fixed_struct_type*)nullptr) == 13);
+static_assert(eosio::fixed_key_size((std::tuple<bool, double, checksum256>*)nullptr) == 41);
+static_assert(eosio::fixed_key_size((std::pair<int, varuint32>*)nullptr) == 0);
+static_assert(eosio::fixed_key_size((struct_type*)nullptr) == 0);
+static_assert(eosio::fixed_key_size((std::string*)nullptr) == 0);
+
+// Verifies that the keys of a batch match convert_to_key and that sorting them orders the objects
+template<typename T>
+void test_key_batch(const std::vector<T>& objects) {
+   auto batch = eosio::convert_to_keys(objects);
+   CHECK(batch.size() == objects.size());
+   CHECK(batch.offsets.empty() == (eosio::fixed_key_size((T*)nullptr) != 0));
+   for (size_t i = 0; i < objects.size(); ++i) {
+      auto key = eosio::convert_to_key(objects[i]);
+      CHECK(batch.key(i) == std::string_view(key.data(), key.size()));
+   }
+   std::vector<uint32_t> expected(objects.size());
+   std::iota(expected.begin(), expected.end(), 0);
+   std::stable_sort(expected.begin(), expected.end(), [&](uint32_t a, uint32_t b) { return objects[a] < objects[b]; });
+   CHECK(eosio::sort_keys(batch) == expected);
+   CHECK(eosio::sort_keys(batch, 4) == expected);
+}
+
+void test_key_batches() {
+   std::vector<uint64_t> ints;
+   std::vector<fixed_struct_type> structs;
+   std::vector<std::string> strings;
+   std::vector<struct_type> variable_structs;
+   uint64_t x = 1;
+   for (int i = 0; i < 5000; ++i) {
+      x = x * 6364136223846793005 + 1442695040888963407;
+      // few distinct values in the high bytes, so buckets have common prefixes and duplicates
+      ints.push_back(i % 3 ? x >> 48 : x);
+      structs.push_back({name{x % 7}, uint32_t(x >> 40) % 1000, enum_s8(x % 3)});
+      strings.push_back(std::string(x % 5, 'a') + std::string(1, char(x >> 56)) + std::string(x % 3, '\0'));
+      variable_structs.push_back({std::vector<int>(x % 4, int(x >> 60)), i % 2 ? std::optional<int>{} : int(x % 5), 0});
+   }
+   test_key_batch(ints);
+   test_key_batch(structs);
+   test_key_batch(strings);
+   test_key_batch(variable_structs);
+   test_key_batch(std::vector<uint64_t>(1000, 42));
+   test_key_batch(std::vector<std::string>{});
+
+   // each key is a prefix of the next, so every split only peels off one key
+   std::vector<std::string> nested;
+   for (int i = 8000; i > 0; --i)
+      nested.push_back(std::string(i, 'a'));
+   test_key_batch(nested);
+}
+
 int main() {
    test_compare();
+   test_key_spans();
+   test_key_batches();
    if(error_count) return 1;
 }
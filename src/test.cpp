@@ -2,17 +2,89 @@
 
 #include "abieos.h"
 #include "abieos.hpp"
+#include "abieos_columnar.hpp"
+#include "abieos_stats.hpp"
+#include "abieos_ship.hpp"
+#include "abieos_view.hpp"
 #include "fuzzer.hpp"
 #include "rapidjson/document.h"
 #include "rapidjson/stringbuffer.h"
 #include "rapidjson/writer.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <new>
+#include <random>
+#include <eosio/block_log.hpp>
+#include <eosio/ship_delta_filter.hpp>
+#include <eosio/ship_ids.hpp>
+#include <eosio/ship_lazy.hpp>
+#include <eosio/ship_log.hpp>
+#include <eosio/ship_merkle.hpp>
+#include <eosio/ship_pipeline.hpp>
+#include <eosio/ship_trace_filter.hpp>
+#include <eosio/ship_transaction.hpp>
+#ifdef ABIEOS_HAVE_ZLIB
+#include <eosio/zlib.hpp>
+#endif
 #include <stdexcept>
 #include <stdio.h>
 #include <string>
+#include <thread>
 #include <vector>
 
 extern const char* const state_history_plugin_abi;
 
+// Counts heap allocations so tests can check that conversions stop allocating once their buffers have grown. Every
+// form of operator new and delete is replaced so that they all pair malloc or posix_memalign with free.
+std::atomic<size_t> allocation_count{0};
+
+static void* counted_alloc(size_t size, size_t align = 0) noexcept {
+    ++allocation_count;
+    size = size ? size : 1;
+    if (align <= alignof(std::max_align_t))
+        return malloc(size);
+    void* p = nullptr;
+    return posix_memalign(&p, std::max(align, sizeof(void*)), size) ? nullptr : p;
+}
+
+static void* counted_new(size_t size, size_t align = 0) {
+    if (void* p = counted_alloc(size, align))
+        return p;
+    throw std::bad_alloc{};
+}
+
+void* operator new(size_t size) { return counted_new(size); }
+void* operator new[](size_t size) { return counted_new(size); }
+void* operator new(size_t size, std::align_val_t align) { return counted_new(size, size_t(align)); }
+void* operator new[](size_t size, std::align_val_t align) { return counted_new(size, size_t(align)); }
+void* operator new(size_t size, const std::nothrow_t&) noexcept { return counted_alloc(size); }
+void* operator new[](size_t size, const std::nothrow_t&) noexcept { return counted_alloc(size); }
+void* operator new(size_t size, std::align_val_t align, const std::nothrow_t&) noexcept {
+    return counted_alloc(size, size_t(align));
+}
+void* operator new[](size_t size, std::align_val_t align, const std::nothrow_t&) noexcept {
+    return counted_alloc(size, size_t(align));
+}
+
+void operator delete(void* p) noexcept { free(p); }
+void operator delete[](void* p) noexcept { free(p); }
+void operator delete(void* p, size_t) noexcept { free(p); }
+void operator delete[](void* p, size_t) noexcept { free(p); }
+void operator delete(void* p, std::align_val_t) noexcept { free(p); }
+void operator delete[](void* p, std::align_val_t) noexcept { free(p); }
+void operator delete(void* p, size_t, std::align_val_t) noexcept { free(p); }
+void operator delete[](void* p, size_t, std::align_val_t) noexcept { free(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { free(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { free(p); }
+void operator delete(void* p, std::align_val_t, const std::nothrow_t&) noexcept { free(p); }
+void operator delete[](void* p, std::align_val_t, const std::nothrow_t&) noexcept { free(p); }
+
 inline const bool generate_corpus = false;
 
 const char tokenHexAbi[] = "0e656f73696f3a3a6162692f312e30010c6163636f756e745f6e616d65046e61"
@@ -583,6 +655,509 @@ void check_error(abieos_context* context, const std::string& s, F f) {
     check_except(s, [&] { check_context(context, f()); });
 }
 
+// Verifies that the builder's last output matches the binary produced from json
+void check_builder_result(abieos_context* context, uint64_t contract, const char* type, const char* json) {
+    check_context(context, abieos_builder_finish(context));
+    std::string built_hex = check_context(context, abieos_get_bin_hex(context));
+    check_context(context, abieos_json_to_bin(context, contract, type, json));
+    std::string json_hex = check_context(context, abieos_get_bin_hex(context));
+    printf("builder %s %s %s\n", type, json, built_hex.c_str());
+    if (built_hex != json_hex)
+        throw std::runtime_error("builder mismatch: " + built_hex + " != " + json_hex);
+}
+
+void check_builder(abieos_context* context, uint64_t token, uint64_t testAbiName) {
+    check_context(context, abieos_builder_begin(context, token, "transfer"));
+    check_context(context, abieos_builder_begin_struct(context));
+    check_context(context, abieos_builder_push_name(context, abieos_string_to_name(context, "useraaaaaaaa")));
+    check_context(context, abieos_builder_push_string(context, "useraaaaaaab", 12));
+    check_context(context, abieos_builder_push_string(context, "0.0001 SYS", 10));
+    check_context(context, abieos_builder_push_string(context, "test memo", 9));
+    check_context(context, abieos_builder_end_struct(context));
+    check_builder_result(context, token, "transfer",
+                         R"({"from":"useraaaaaaaa","to":"useraaaaaaab","quantity":"0.0001 SYS","memo":"test memo"})");
+
+    check_context(context, abieos_builder_begin(context, 0, "transaction"));
+    check_context(context, abieos_builder_begin_struct(context));
+    check_context(context, abieos_builder_push_string(context, "2009-02-13T23:31:31.000", 23));
+    check_context(context, abieos_builder_push_uint64(context, 1234));
+    check_context(context, abieos_builder_push_int64(context, 5678));
+    check_context(context, abieos_builder_push_uint64(context, 0));
+    check_context(context, abieos_builder_push_uint64(context, 0));
+    check_context(context, abieos_builder_push_uint64(context, 0));
+    check_context(context, abieos_builder_begin_array(context));
+    check_context(context, abieos_builder_end_array(context));
+    check_context(context, abieos_builder_begin_array(context));
+    check_context(context, abieos_builder_begin_struct(context));
+    check_context(context, abieos_builder_push_name(context, abieos_string_to_name(context, "eosio.token")));
+    check_context(context, abieos_builder_push_name(context, abieos_string_to_name(context, "transfer")));
+    check_context(context, abieos_builder_begin_array(context));
+    check_context(context, abieos_builder_begin_struct(context));
+    check_context(context, abieos_builder_push_name(context, abieos_string_to_name(context, "useraaaaaaaa")));
+    check_context(context, abieos_builder_push_name(context, abieos_string_to_name(context, "active")));
+    check_context(context, abieos_builder_end_struct(context));
+    check_context(context, abieos_builder_end_array(context));
+    check_context(context, abieos_builder_push_bytes(context, "\x01\x02\xff", 3));
+    check_context(context, abieos_builder_end_struct(context));
+    check_context(context, abieos_builder_end_array(context));
+    check_context(context, abieos_builder_begin_array(context));
+    check_context(context, abieos_builder_end_array(context));
+    check_context(context, abieos_builder_end_struct(context));
+    check_builder_result(
+        context, 0, "transaction",
+        R"({"expiration":"2009-02-13T23:31:31.000","ref_block_num":1234,"ref_block_prefix":5678,"max_net_usage_words":0,"max_cpu_usage_ms":0,"delay_sec":0,"context_free_actions":[],"actions":[{"account":"eosio.token","name":"transfer","authorization":[{"actor":"useraaaaaaaa","permission":"active"}],"data":"0102FF"}],"transaction_extensions":[]})");
+
+    check_context(context, abieos_builder_begin(context, testAbiName, "s4"));
+    check_context(context, abieos_builder_begin_struct(context));
+    check_context(context, abieos_builder_end_struct(context));
+    check_builder_result(context, testAbiName, "s4", R"({})");
+
+    check_context(context, abieos_builder_begin(context, testAbiName, "s4"));
+    check_context(context, abieos_builder_begin_struct(context));
+    check_context(context, abieos_builder_push_null(context));
+    check_context(context, abieos_builder_end_struct(context));
+    check_builder_result(context, testAbiName, "s4", R"({"a1":null})");
+
+    check_context(context, abieos_builder_begin(context, testAbiName, "s4"));
+    check_context(context, abieos_builder_begin_struct(context));
+    check_context(context, abieos_builder_push_int64(context, -7));
+    check_context(context, abieos_builder_begin_array(context));
+    for (int i = 5; i <= 7; ++i)
+        check_context(context, abieos_builder_push_int64(context, i));
+    check_context(context, abieos_builder_end_array(context));
+    check_context(context, abieos_builder_end_struct(context));
+    check_builder_result(context, testAbiName, "s4", R"({"a1":-7,"b1":[5,6,7]})");
+
+    check_context(context, abieos_builder_begin(context, testAbiName, "v1"));
+    check_context(context, abieos_builder_begin_variant(context, "s1"));
+    check_context(context, abieos_builder_begin_struct(context));
+    check_context(context, abieos_builder_push_int64(context, 6));
+    check_context(context, abieos_builder_end_struct(context));
+    check_context(context, abieos_builder_end_variant(context));
+    check_builder_result(context, testAbiName, "v1", R"(["s1",{"x1":6}])");
+
+    check_context(context, abieos_builder_begin(context, 0, "int8"));
+    check_error(context, "number is out of range", [&] { return abieos_builder_push_int64(context, 128); });
+    check_error(context, "no builder in progress", [&] { return abieos_builder_push_int64(context, 1); });
+    check_context(context, abieos_builder_begin(context, 0, "uint64"));
+    check_error(context, "Expected string", [&] { return abieos_builder_push_bool(context, true); });
+    check_context(context, abieos_builder_begin(context, 0, "name"));
+    check_error(context, "Expected {", [&] { return abieos_builder_begin_struct(context); });
+    check_context(context, abieos_builder_begin(context, testAbiName, "s1"));
+    check_context(context, abieos_builder_begin_struct(context));
+    check_error(context, "Expected field", [&] { return abieos_builder_end_struct(context); });
+    check_context(context, abieos_builder_begin(context, testAbiName, "s1"));
+    check_context(context, abieos_builder_begin_struct(context));
+    check_error(context, "Expected end of json", [&] { return abieos_builder_finish(context); });
+    check_context(context, abieos_builder_begin(context, testAbiName, "v1"));
+    check_error(context, "Invalid type for variant", [&] { return abieos_builder_begin_variant(context, "s9"); });
+}
+
+// Records visitor events as compact text
+struct trace_handler {
+    std::string result;
+
+    bool null() { return result += "null ", true; }
+    bool boolean(bool value) { return result += value ? "true " : "false ", true; }
+    bool int64(int64_t value) { return result += "i" + std::to_string(value) + " ", true; }
+    bool uint64(uint64_t value) { return result += "u" + std::to_string(value) + " ", true; }
+    bool float64(double value) { return result += "d" + std::to_string(value) + " ", true; }
+    bool name(uint64_t value) { return result += "n" + eosio::name_to_string(value) + " ", true; }
+    bool string(std::string_view value) { return result += "s\"" + std::string{value} + "\" ", true; }
+    bool bytes(std::string_view value) { return result += "b" + std::to_string(value.size()) + " ", true; }
+    bool start_object() { return result += "{ ", true; }
+    bool key(std::string_view key) { return result += std::string{key} + ": ", true; }
+    bool end_object() { return result += "} ", true; }
+    bool start_array(uint32_t size) { return result += "[" + std::to_string(size) + " ", true; }
+    bool end_array() { return result += "] ", true; }
+    bool start_variant(std::string_view alternative) { return result += "<" + std::string{alternative} + " ", true; }
+    bool end_variant() { return result += "> ", true; }
+};
+
+abieos_visitor trace_callbacks() {
+    abieos_visitor v{};
+    v.null_value = [](void* u) { return abieos_bool(((trace_handler*)u)->null()); };
+    v.bool_value = [](void* u, abieos_bool value) { return abieos_bool(((trace_handler*)u)->boolean(value)); };
+    v.int64_value = [](void* u, int64_t value) { return abieos_bool(((trace_handler*)u)->int64(value)); };
+    v.uint64_value = [](void* u, uint64_t value) { return abieos_bool(((trace_handler*)u)->uint64(value)); };
+    v.double_value = [](void* u, double value) { return abieos_bool(((trace_handler*)u)->float64(value)); };
+    v.name_value = [](void* u, uint64_t value) { return abieos_bool(((trace_handler*)u)->name(value)); };
+    v.string_value = [](void* u, const char* data, size_t size) {
+        return abieos_bool(((trace_handler*)u)->string({data, size}));
+    };
+    v.bytes_value = [](void* u, const char* data, size_t size) {
+        return abieos_bool(((trace_handler*)u)->bytes({data, size}));
+    };
+    v.start_object = [](void* u) { return abieos_bool(((trace_handler*)u)->start_object()); };
+    v.key = [](void* u, const char* data, size_t size) { return abieos_bool(((trace_handler*)u)->key({data, size})); };
+    v.end_object = [](void* u) { return abieos_bool(((trace_handler*)u)->end_object()); };
+    v.start_array = [](void* u, uint32_t size) { return abieos_bool(((trace_handler*)u)->start_array(size)); };
+    v.end_array = [](void* u) { return abieos_bool(((trace_handler*)u)->end_array()); };
+    v.start_variant = [](void* u, const char* data, size_t size) {
+        return abieos_bool(((trace_handler*)u)->start_variant({data, size}));
+    };
+    v.end_variant = [](void* u) { return abieos_bool(((trace_handler*)u)->end_variant()); };
+    return v;
+}
+
+// Checks that the visitor interfaces produce the expected events for json's binary form
+void check_visitor(abieos_context* context, uint64_t contract, const char* type, const char* json,
+                   const std::string& expected) {
+    check_context(context, abieos_json_to_bin(context, contract, type, json));
+    std::vector<char> bin(abieos_get_bin_data(context), abieos_get_bin_data(context) + abieos_get_bin_size(context));
+
+    trace_handler c_trace;
+    auto callbacks = trace_callbacks();
+    check_context(context,
+                  abieos_bin_to_visitor(context, contract, type, bin.data(), bin.size(), &callbacks, &c_trace));
+
+    printf("visitor %s %s %s\n", type, json, c_trace.result.c_str());
+    if (c_trace.result != expected)
+        throw std::runtime_error("visitor mismatch: " + c_trace.result + " != " + expected);
+
+    // The C++ handler only needs the built-in types
+    if (contract == 0) {
+        trace_handler cpp_trace;
+        eosio::abi abi;
+        eosio::convert(eosio::abi_def{}, abi);
+        eosio::input_stream stream{bin.data(), bin.size()};
+        abieos::bin_to_visitor(stream, abi.get_type(type), cpp_trace);
+        if (cpp_trace.result != expected)
+            throw std::runtime_error("visitor mismatch: " + cpp_trace.result + " != " + expected);
+    }
+}
+
+void check_visitors(abieos_context* context, uint64_t token, uint64_t testAbiName) {
+    check_visitor(context, token, "transfer",
+                  R"({"from":"useraaaaaaaa","to":"useraaaaaaab","quantity":"0.0001 SYS","memo":"test memo"})",
+                  R"({ from: nuseraaaaaaaa to: nuseraaaaaaab quantity: s"0.0001 SYS" memo: s"test memo" } )");
+    check_visitor(context, testAbiName, "s4", R"({"a1":null,"b1":[5,6]})", R"({ a1: null b1: [2 i5 i6 ] } )");
+    check_visitor(context, testAbiName, "s4", R"({})", R"({ } )");
+    check_visitor(context, testAbiName, "v1", R"(["s1",{"x1":6}])", R"(<s1 { x1: i6 } > )");
+    check_visitor(context, 0, "bool", "true", "true ");
+    check_visitor(context, 0, "int8", "-5", "i-5 ");
+    check_visitor(context, 0, "uint64", R"("18446744073709551615")", "u18446744073709551615 ");
+    check_visitor(context, 0, "varuint32", "300", "u300 ");
+    check_visitor(context, 0, "float64", "1.5", "d1.500000 ");
+    check_visitor(context, 0, "bytes", R"("0102FF")", "b3 ");
+    check_visitor(context, 0, "string", R"("abc")", R"(s"abc" )");
+    check_visitor(context, 0, "int128", R"("-170141183460469231731687303715884105728")",
+                  R"(s"-170141183460469231731687303715884105728" )");
+    check_visitor(context, 0, "time_point_sec", R"("2009-02-13T23:31:31.000")", R"(s"2009-02-13T23:31:31.000" )");
+
+    abieos_visitor stop{};
+    stop.start_object = [](void*) { return abieos_bool(false); };
+    check_context(context, abieos_json_to_bin(context, testAbiName, "s4", "{}"));
+    std::vector<char> bin(abieos_get_bin_data(context), abieos_get_bin_data(context) + abieos_get_bin_size(context));
+    check_error(context, "bin_visitor aborted", [&] {
+        return abieos_bin_to_visitor(context, testAbiName, "s4", bin.data(), bin.size(), &stop, nullptr);
+    });
+    check_error(context, "visitor is null", [&] {
+        return abieos_bin_to_visitor(context, testAbiName, "s4", bin.data(), bin.size(), nullptr, nullptr);
+    });
+    check_error(context, "Stream overrun", [&] {
+        return abieos_bin_to_visitor(context, token, "transfer", bin.data(), bin.size(), &stop, nullptr);
+    });
+}
+
+void check_compact(abieos_context* context, uint64_t contract, const char* type, const char* json,
+                   abieos_bool names_as_strings, const std::string& cbor_hex, const std::string& msgpack_hex) {
+    check_context(context, abieos_json_to_bin(context, contract, type, json));
+    std::vector<char> bin(abieos_get_bin_data(context), abieos_get_bin_data(context) + abieos_get_bin_size(context));
+    check_context(context, abieos_bin_to_cbor(context, contract, type, bin.data(), bin.size(), names_as_strings));
+    std::string cbor = check_context(context, abieos_get_bin_hex(context));
+    check_context(context, abieos_bin_to_msgpack(context, contract, type, bin.data(), bin.size(), names_as_strings));
+    std::string msgpack = check_context(context, abieos_get_bin_hex(context));
+    printf("compact %s %s %s %s\n", type, json, cbor.c_str(), msgpack.c_str());
+    if (cbor != cbor_hex)
+        throw std::runtime_error("cbor mismatch: " + cbor + " != " + cbor_hex);
+    if (msgpack != msgpack_hex)
+        throw std::runtime_error("msgpack mismatch: " + msgpack + " != " + msgpack_hex);
+}
+
+void check_compact_formats(abieos_context* context, uint64_t token, uint64_t testAbiName) {
+    check_compact(context, 0, "bool", "true", false, "F5", "C3");
+    check_compact(context, 0, "int8", "-5", false, "24", "FB");
+    check_compact(context, 0, "int32", "-100", false, "3863", "D09C");
+    check_compact(context, 0, "uint16", "300", false, "19012C", "CD012C");
+    check_compact(context, 0, "uint64", R"("18446744073709551615")", false, "1BFFFFFFFFFFFFFFFF",
+                  "CFFFFFFFFFFFFFFFFF");
+    check_compact(context, 0, "float64", "1.5", false, "FB3FF8000000000000", "CB3FF8000000000000");
+    check_compact(context, 0, "bytes", R"("0102FF")", false, "430102FF", "C4030102FF");
+    check_compact(context, 0, "name", R"("eosio")", false, "1B5530EA0000000000", "CF5530EA0000000000");
+    check_compact(context, 0, "name", R"("eosio")", true, "65656F73696F", "A5656F73696F");
+    check_compact(context, 0, "checksum160", R"("0102030405060708090A0B0C0D0E0F1011121314")", false,
+                  "540102030405060708090A0B0C0D0E0F1011121314", "C4140102030405060708090A0B0C0D0E0F1011121314");
+    check_compact(context, 0, "symbol_code", R"("SYS")", false, "63535953", "A3535953");
+    check_compact(context, testAbiName, "v1", R"(["s1",{"x1":6}])", false, "82627331BF62783106FF",
+                  "92A27331DE0001A2783106");
+    check_compact(context, testAbiName, "s4", R"({"a1":null,"b1":[5,6]})", false, "BF626131F6626231820506FF",
+                  "DE0002A26131C0A26231920506");
+    check_compact(
+        context, token, "transfer",
+        R"({"from":"useraaaaaaaa","to":"useraaaaaaab","quantity":"0.0001 SYS","memo":"test memo"})", true,
+        "BF6466726F6D6C75736572616161616161616162746F6C757365726161616161616162687175616E74697479A366616D6F756E7401"
+        "69707265636973696F6E046673796D626F6C63535953646D656D6F6974657374206D656D6FFF",
+        "DE0004A466726F6DAC757365726161616161616161A2746FAC757365726161616161616162A87175616E7469747983A6616D6F756E"
+        "7401A9707265636973696F6E04A673796D626F6CA3535953A46D656D6FA974657374206D656D6F");
+}
+
+template <typename T>
+void check_key(abieos_context* context, uint64_t contract, const char* type, const char* json, const T& value) {
+    check_context(context, abieos_json_to_bin(context, contract, type, json));
+    std::vector<char> bin(abieos_get_bin_data(context), abieos_get_bin_data(context) + abieos_get_bin_size(context));
+    check_context(context, abieos_bin_to_key(context, contract, type, bin.data(), bin.size()));
+    std::vector<char> key(abieos_get_bin_data(context), abieos_get_bin_data(context) + abieos_get_bin_size(context));
+    if (key != eosio::convert_to_key(value))
+        throw std::runtime_error(std::string("bin_to_key mismatch: ") + type + " " + json);
+}
+
+// Once the buffers of a context have grown, converting with it doesn't allocate
+void check_steady_state_allocations(abieos_context* context, uint64_t token) {
+    const char* json = R"({"from":"useraaaaaaaa","to":"useraaaaaaab","quantity":"100.0000 SYS","memo":"hi there"})";
+    check_context(context, abieos_json_to_bin(context, token, "transfer", json));
+    std::string hex = check_context(context, abieos_get_bin_hex(context));
+    auto convert = [&] {
+        check_context(context, abieos_json_to_bin(context, token, "transfer", json));
+        check_context(context, abieos_bin_to_json(context, token, "transfer", abieos_get_bin_data(context),
+                                                  abieos_get_bin_size(context)));
+        check_context(context, abieos_hex_to_json(context, token, "transfer", hex.c_str()));
+    };
+    for (int i = 0; i < 3; ++i)
+        convert();
+    auto before = allocation_count.load();
+    for (int i = 0; i < 100; ++i)
+        convert();
+    if (allocation_count != before)
+        throw std::runtime_error("conversions allocated " + std::to_string(allocation_count - before) +
+                                 " times in steady state");
+}
+
+#ifndef ABIEOS_NO_STATS
+void check_contains(const std::string& s, const std::string& part) {
+    if (s.find(part) == std::string::npos)
+        throw std::runtime_error("expected " + part + " in " + s);
+}
+
+void check_stats(abieos_context* context, uint64_t token) {
+    const char* json = R"({"from":"useraaaaaaaa","to":"useraaaaaaab","quantity":"100.0000 SYS","memo":"hi there"})";
+    check_context(context, abieos_reset_stats(context));
+    check_context(context, abieos_set_stats_enabled(context, true));
+    for (int i = 0; i < 3; ++i) {
+        check_context(context, abieos_json_to_bin(context, token, "transfer", json));
+        check_context(context, abieos_bin_to_json(context, token, "transfer", abieos_get_bin_data(context),
+                                                  abieos_get_bin_size(context)));
+    }
+    std::vector<char> truncated{1, 2};
+    if (abieos_bin_to_json(context, token, "transfer", truncated.data(), truncated.size()) ||
+        abieos_bin_to_json(context, token, "no_such_type", truncated.data(), truncated.size()))
+        throw std::runtime_error("bin_to_json accepted bad input");
+
+    // Counting calls of types which were seen before doesn't allocate
+    auto before = allocation_count.load();
+    check_context(context, abieos_json_to_bin(context, token, "transfer", json));
+    if (allocation_count != before)
+        throw std::runtime_error("counting a call allocated");
+
+    std::string stats = check_context(context, abieos_get_stats_json(context));
+    printf("stats %s\n", stats.c_str());
+    check_contains(stats, R"({"contract":"eosio.token","type":"transfer","operation":"json_to_bin","calls":4,)"
+                          R"("input_bytes":)" + std::to_string(4 * strlen(json)) + R"(,"output_bytes":164,"errors":0,)");
+    check_contains(stats, R"("type":"transfer","operation":"bin_to_json","calls":4,"input_bytes":125,)");
+    check_contains(stats, R"("errors":1,)");
+    check_contains(stats, R"({"contract":"","type":"","operation":"bin_to_json","calls":1,"input_bytes":2,)"
+                          R"("output_bytes":0,"errors":1,)");
+    if (stats.find("no_such_type") != std::string::npos)
+        throw std::runtime_error("stats kept an entry for a type which wasn't found");
+
+    // Unknown contracts and types all share that entry
+    for (int i = 0; i < 10; ++i)
+        abieos_bin_to_json(context, token + 1 + i, ("missing" + std::to_string(i)).c_str(), truncated.data(),
+                           truncated.size());
+    stats = check_context(context, abieos_get_stats_json(context));
+    check_contains(stats, R"({"contract":"","type":"","operation":"bin_to_json","calls":11,"input_bytes":22,)");
+
+    // About one call in time_sample_interval is timed
+    for (uint32_t i = 0; i < 100 * abieos::time_sample_interval; ++i)
+        check_context(context, abieos_validate_bin(context, token, "transfer", abieos_get_bin_data(context),
+                                                   abieos_get_bin_size(context)));
+    stats = check_context(context, abieos_get_stats_json(context));
+    check_contains(stats, R"("operation":"validate_bin","calls":3200,"input_bytes":131200,"output_bytes":0,)"
+                          R"("errors":0,"timed_calls":)");
+    check_contains(stats, R"("latency":[[)");
+    for (uint64_t ns : {0, 1, 3, 4, 5, 7, 8, 9, 1000, 123456789, 1 << 30}) {
+        size_t bucket = abieos::latency_bucket(ns);
+        if (abieos::latency_bucket_start(bucket) > ns || abieos::latency_bucket_start(bucket + 1) <= ns)
+            throw std::runtime_error("latency " + std::to_string(ns) + " is in the wrong bucket");
+    }
+    if (abieos::latency_bucket(~uint64_t(0)) != abieos::num_latency_buckets - 1)
+        throw std::runtime_error("latency overflows the histogram");
+
+    check_context(context, abieos_set_stats_enabled(context, false));
+    check_context(context, abieos_json_to_bin(context, token, "transfer", json));
+    if (check_context(context, abieos_get_stats_json(context)) != stats)
+        throw std::runtime_error("stats changed while disabled");
+    check_context(context, abieos_reset_stats(context));
+    if (check_context(context, abieos_get_stats_json(context)) != std::string("[]"))
+        throw std::runtime_error("stats not reset");
+}
+#endif
+
+void check_json_cache_stats(abieos_context* context, uint64_t hits, uint64_t misses, uint64_t entries) {
+    uint64_t h, m, e, b;
+    check_context(context, abieos_get_json_cache_stats(context, &h, &m, &e, &b));
+    if (h != hits || m != misses || e != entries || (entries && !b))
+        throw std::runtime_error("json cache has " + std::to_string(h) + " hits, " + std::to_string(m) + " misses, " +
+                                 std::to_string(e) + " entries");
+}
+
+void check_json_cache(abieos_context* context, uint64_t token) {
+    auto to_bin = [&](const char* json) {
+        check_context(context, abieos_json_to_bin(context, token, "transfer", json));
+        return std::string(abieos_get_bin_data(context), abieos_get_bin_size(context));
+    };
+    auto to_json = [&](const std::string& bin, const char* type = "transfer") {
+        return std::string(check_context(context, abieos_bin_to_json(context, token, type, bin.data(), bin.size())));
+    };
+    auto a = to_bin(R"({"from":"useraaaaaaaa","to":"useraaaaaaab","quantity":"1.0000 SYS","memo":"mine"})");
+    auto b = to_bin(R"({"from":"useraaaaaaaa","to":"useraaaaaaab","quantity":"2.0000 SYS","memo":"mine"})");
+    auto a_json = to_json(a), b_json = to_json(b);
+
+    check_context(context, abieos_set_json_cache(context, 1 << 20, 1 << 16));
+    check_json_cache_stats(context, 0, 0, 0);
+    if (to_json(a) != a_json || to_json(a) != a_json || to_json(b) != b_json || to_json(a) != a_json)
+        throw std::runtime_error("json cache returned the wrong json");
+    check_json_cache_stats(context, 2, 2, 2);
+
+    // The same bytes as another type are a different entry; bad data isn't cached
+    to_json(a.substr(0, 8), "name");
+    std::string truncated = a.substr(0, 20);
+    for (int i = 0; i < 2; ++i)
+        if (abieos_bin_to_json(context, token, "transfer", truncated.data(), truncated.size()))
+            throw std::runtime_error("bin_to_json accepted a truncated transfer");
+    check_json_cache_stats(context, 2, 5, 3);
+
+    // A hit doesn't allocate
+    auto before = allocation_count.load();
+    check_context(context, abieos_bin_to_json(context, token, "transfer", a.data(), a.size()));
+    if (allocation_count != before)
+        throw std::runtime_error("json cache hit allocated");
+
+    // Room for one entry: a and b evict each other
+    check_context(context, abieos_set_json_cache(context, 400, 400));
+    check_json_cache_stats(context, 3, 5, 1);
+    to_json(b);
+    to_json(a);
+    check_json_cache_stats(context, 3, 7, 1);
+    check_context(context, abieos_set_json_cache(context, 1 << 20, 8));
+    to_json(b);
+    check_json_cache_stats(context, 3, 8, 1);
+
+    check_context(context, abieos_set_json_cache(context, 0, 0));
+    check_json_cache_stats(context, 3, 8, 0);
+    to_json(a);
+    check_json_cache_stats(context, 3, 8, 0);
+}
+
+void check_keys(abieos_context* context, uint64_t token, uint64_t testAbiName) {
+    using eosio::name;
+    check_key(context, 0, "bool", "true", true);
+    check_key(context, 0, "int8", "-5", int8_t(-5));
+    check_key(context, 0, "uint16", "300", uint16_t(300));
+    check_key(context, 0, "int32", "-100", int32_t(-100));
+    check_key(context, 0, "int64", R"("-9000000000")", int64_t(-9000000000));
+    check_key(context, 0, "uint64", R"("18446744073709551615")", ~uint64_t(0));
+    check_key(context, 0, "float64", "-1.5", -1.5);
+    check_key(context, 0, "varuint32", "300", eosio::varuint32{300});
+    check_key(context, 0, "string", R"("abc")", std::string("abc"));
+    check_key(context, 0, "bytes", R"("00FF01")", eosio::bytes{{0, char(0xff), 1}});
+    check_key(context, 0, "name", R"("eosio")", name{"eosio"});
+    check_key(context, 0, "asset", R"("-1.0000 SYS")", eosio::asset{-10000, eosio::symbol{"SYS", 4}});
+    check_key(context, 0, "symbol", R"("4,SYS")", eosio::symbol{"SYS", 4});
+    check_key(context, 0, "time_point", R"("2020-01-02T03:04:05.678")",
+              eosio::time_point{eosio::microseconds{1577934245678000}});
+    check_key(context, 0, "checksum256", R"("0102030405060708090A0B0C0D0E0F101112131415161718191A1B1C1D1E1F20")",
+              eosio::checksum256{std::array<uint8_t, 32>{1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17,
+                                                         18, 19, 20, 21, 22, 23, 24, 25, 26, 27, 28, 29, 30, 31, 32}});
+    check_key(context, 0, "int8[]", "[0,-1,5]", std::vector<int8_t>{0, -1, 5});
+    check_key(context, 0, "bool[]", "[false,true]", std::vector<bool>{false, true});
+    check_key(context, 0, "uint32[]", "[0,7]", std::vector<uint32_t>{0, 7});
+    check_key(context, 0, "string[]", R"(["a",""])", std::vector<std::string>{"a", ""});
+    check_key(context, 0, "string?", "null", std::optional<std::string>{});
+    check_key(context, 0, "uint8?", "0", std::optional<uint8_t>{0});
+    check_key(context, testAbiName, "v1", R"(["s1",{"x1":6}])",
+              std::variant<int8_t, std::tuple<int8_t>>{std::tuple<int8_t>{6}});
+    check_key(context, testAbiName, "s4", R"({"a1":null,"b1":[5,6]})",
+              std::tuple{std::optional<std::optional<int8_t>>{std::optional<int8_t>{}},
+                         std::optional<std::vector<int8_t>>{{5, 6}}});
+    check_key(context, testAbiName, "s4", R"({})",
+              std::tuple{std::optional<std::optional<int8_t>>{}, std::optional<std::vector<int8_t>>{}});
+    check_key(context, token, "transfer",
+              R"({"from":"useraaaaaaaa","to":"useraaaaaaab","quantity":"0.0001 SYS","memo":"test memo"})",
+              std::tuple{name{"useraaaaaaaa"}, name{"useraaaaaaab"}, eosio::asset{1, eosio::symbol{"SYS", 4}},
+                         std::string("test memo")});
+
+    std::vector<char> varint{1};
+    check_error(context, "varint32 has no key encoding",
+                [&] { return abieos_bin_to_key(context, 0, "varint32", varint.data(), varint.size()); });
+}
+
+// abieos_validate_bin rejects data with the error abieos_bin_to_json gives for it. Truncated data fails both; other
+// corruption may only fail in bin_to_json, when the value itself is invalid.
+void check_validate(abieos_context* context, uint64_t contract, const char* type, const char* json) {
+    check_context(context, abieos_json_to_bin(context, contract, type, json));
+    std::vector<char> bin(abieos_get_bin_data(context), abieos_get_bin_data(context) + abieos_get_bin_size(context));
+    auto compare = [&](const std::vector<char>& data, size_t size, bool exact) {
+        bool valid = abieos_validate_bin(context, contract, type, data.data(), size);
+        std::string error = valid ? "" : abieos_get_error(context);
+        bool converted = abieos_bin_to_json(context, contract, type, data.data(), size);
+        if (!valid && (converted || error != abieos_get_error(context)))
+            throw std::runtime_error(std::string("validate_bin rejected ") + type + " " + json + ": " + error);
+        if (exact && valid != converted)
+            throw std::runtime_error(std::string("validate_bin accepted ") + type + " " + json);
+    };
+    for (size_t size = 0; size <= bin.size(); ++size)
+        compare(bin, size, true);
+    for (size_t i = 0; i < bin.size(); ++i) {
+        for (char b : {char(0x80), char(0xff), char(0x7f), char(0x00)}) {
+            auto corrupt = bin;
+            corrupt[i] = b;
+            compare(corrupt, corrupt.size(), false);
+        }
+    }
+}
+
+void check_validate_bin(abieos_context* context, uint64_t token, uint64_t testAbiName) {
+    check_validate(context, token, "transfer",
+                   R"({"from":"useraaaaaaaa","to":"useraaaaaaab","quantity":"0.0001 SYS","memo":"test memo"})");
+    check_validate(context, 0, "uint8[][][]", R"([[[1,2,3],[4,5,6]],[[7,8,9],[]]])");
+    check_validate(context, 0, "string[]", R"(["a","","bcd"])");
+    check_validate(context, 0, "bytes", R"("00FF01")");
+    check_validate(context, 0, "bitset", R"("110001011")");
+    check_validate(context, 0, "varuint32", "4294967295");
+    check_validate(context, 0, "varint32", "-2147483648");
+    check_validate(context, 0, "uint8?", "7");
+    check_validate(context, 0, "public_key", R"("EOS11DsZ6Lyr1aXpm9aBqqgV4iFJpNbSw5eE9LLTwNAxqjJgmjgbT")");
+    check_validate(context, testAbiName, "v1", R"(["s1",{"x1":6}])");
+    check_validate(context, testAbiName, "s4", R"({"a1":null,"b1":[5,6]})");
+    check_validate(context, testAbiName, "s4", R"({})");
+
+    std::vector<char> bad_index{4};
+    check_error(context, "bad variant index",
+                [&] { return abieos_validate_bin(context, testAbiName, "v1", bad_index.data(), bad_index.size()); });
+    std::vector<char> bad_varuint(6, char(0x80));
+    check_error(context, "invalid varuint encoding",
+                [&] { return abieos_validate_bin(context, 0, "varuint32", bad_varuint.data(), bad_varuint.size()); });
+
+    // Rejecting malformed data neither throws nor allocates
+    auto before = allocation_count.load();
+    for (int i = 0; i < 100; ++i)
+        if (abieos_validate_bin(context, token, "transfer", bad_index.data(), bad_index.size()))
+            throw std::runtime_error("validate_bin accepted a truncated transfer");
+    if (allocation_count != before)
+        throw std::runtime_error("validate_bin allocated " + std::to_string(allocation_count - before) + " times");
+}
+
 void check_types() {
     auto context = check(abieos_create());
     auto token = check_context(context, abieos_string_to_name(context, "eosio.token"));
@@ -1262,13 +1837,1201 @@ void check_types() {
     check_type(context, 0, "bitset", R"("110001011011000110101011101001100110000110000000000000000001")");
     check_type(context, 0, "bitset", R"("110001011011000110101011101001100110000111111111111111111110")");
 
+    check_builder(context, token, testAbiName);
+    check_visitors(context, token, testAbiName);
+    check_compact_formats(context, token, testAbiName);
+    check_keys(context, token, testAbiName);
+    check_validate_bin(context, token, testAbiName);
+    check_steady_state_allocations(context, token);
+    check_json_cache(context, token);
+#ifndef ABIEOS_NO_STATS
+    check_stats(context, token);
+#endif
+
     abieos_destroy(context);
 }
 
+const char columnarAbi[] = R"({
+    "version": "eosio::abi/1.1",
+    "structs": [
+        {"name": "fixed_row", "base": "", "fields": [
+            {"name": "id", "type": "uint64"},
+            {"name": "owner", "type": "name"},
+            {"name": "balance", "type": "asset"},
+            {"name": "score", "type": "int16"}]},
+        {"name": "row", "base": "", "fields": [
+            {"name": "id", "type": "uint32"},
+            {"name": "flag", "type": "bool"},
+            {"name": "memo", "type": "string"},
+            {"name": "limit", "type": "uint16?"},
+            {"name": "tags", "type": "name[]"},
+            {"name": "inner", "type": "fixed_row?"},
+            {"name": "choice", "type": "choice"},
+            {"name": "count", "type": "varuint32"},
+            {"name": "extra", "type": "int8$"}]},
+        {"name": "ext_row", "base": "", "fields": [
+            {"name": "a", "type": "uint8"},
+            {"name": "b", "type": "uint16$"},
+            {"name": "c", "type": "uint8$"}]}
+    ],
+    "variants": [{"name": "choice", "types": ["uint8", "string"]}]
+})";
+
+template <typename T>
+T column_value(const abieos::column& c, size_t row) {
+    T result;
+    memcpy(&result, c.values.data() + row * sizeof(T), sizeof(T));
+    return result;
+}
+
+bool column_valid(const abieos::column& c, size_t row) {
+    return c.validity.empty() || (c.validity[row / 8] >> (row % 8)) & 1;
+}
+
+eosio::abi parse_abi(const char* json) {
+    abieos::abi_def def{};
+    std::string abi_copy{json};
+    eosio::json_token_stream stream(abi_copy.data());
+    from_json(def, stream);
+    eosio::abi abi;
+    convert(def, abi);
+    return abi;
+}
+
+const char compiledAbi[] = R"({
+    "version": "eosio::abi/1.1",
+    "types": [{"new_type_name": "account", "type": "name"}],
+    "structs": [
+        {"name": "base", "base": "", "fields": [
+            {"name": "id", "type": "uint64"},
+            {"name": "owner", "type": "account"}]},
+        {"name": "row", "base": "base", "fields": [
+            {"name": "memo", "type": "string"},
+            {"name": "limit", "type": "uint16?"},
+            {"name": "tags", "type": "account[]"},
+            {"name": "inner", "type": "base?"},
+            {"name": "choice", "type": "choice"},
+            {"name": "data", "type": "bytes"},
+            {"name": "extra", "type": "int8$"},
+            {"name": "more", "type": "base$"}]},
+        {"name": "tree", "base": "", "fields": [
+            {"name": "value", "type": "uint8"},
+            {"name": "children", "type": "tree[]"}]},
+        {"name": "ext", "base": "", "fields": [
+            {"name": "a", "type": "uint8"},
+            {"name": "b", "type": "uint8$"}]},
+        {"name": "outer", "base": "", "fields": [
+            {"name": "inner", "type": "ext"},
+            {"name": "last", "type": "ext$"}]}
+    ],
+    "variants": [{"name": "choice", "types": ["uint8", "base", "tree"]}]
+})";
+
+void check_compiled_abi() {
+    auto abi = parse_abi(compiledAbi);
+    auto& compiled = abi.compiled;
+
+    // Runs both walkers on data and returns the json, or the error
+    auto convert = [&](const abieos::abi_type* type, const std::vector<char>& data, size_t size) {
+        std::string expected, result;
+        try {
+            eosio::input_stream bin{data.data(), size};
+            expected = type->bin_to_json(bin);
+        } catch (std::exception& e) {
+            expected = std::string("error: ") + e.what();
+        }
+        try {
+            eosio::input_stream bin{data.data(), size};
+            abieos::conversion_scratch scratch;
+            abieos::bin_to_json(bin, compiled, compiled.index_of(type), result, scratch);
+        } catch (std::exception& e) {
+            result = std::string("error: ") + e.what();
+        }
+        if (result != expected)
+            throw std::runtime_error("compiled bin_to_json of " + type->name + ": " + result + " != " + expected);
+        return result;
+    };
+    auto check_value = [&](const char* type_name, const char* json) {
+        auto type = abi.get_type(type_name);
+        auto bin = type->json_to_bin(json);
+        for (size_t size = 0; size <= bin.size(); ++size)
+            convert(type, bin, size);
+    };
+    check_value("row", R"({"id":"1","owner":"alice","memo":"m","limit":null,"tags":[],"inner":null,)"
+                       R"("choice":["uint8",7],"data":""})");
+    check_value("row", R"({"id":"1","owner":"alice","memo":"\"quoted\"","limit":3,"tags":["bob","carol"],)"
+                       R"("inner":{"id":"2","owner":"dave"},"choice":["base",{"id":"3","owner":"erin"}],)"
+                       R"("data":"00FF","extra":-5,"more":{"id":"4","owner":"frank"}})");
+    check_value("choice", R"(["tree",{"value":1,"children":[{"value":2,"children":[]}]}])");
+    check_value("account[]?", R"(["alice"])");
+    check_value("int8$", "3");
+    check_value("outer", R"({"inner":{"a":1,"b":2},"last":{"a":3,"b":4}})");
+
+    // Types are compiled once and shared, and aliases resolve to their target
+    auto rows = compiled.types.size();
+    auto row = compiled.index_of(abi.get_type("row"));
+    if (compiled.index_of(abi.get_type("row")) != row || compiled.types.size() != rows)
+        throw std::runtime_error("compiled_abi compiled row twice");
+    if (compiled.index_of(abi.get_type("account")) != compiled.index_of(abi.get_type("name")))
+        throw std::runtime_error("compiled_abi didn't resolve an alias");
+    if (compiled.types[row].kind != eosio::compiled_abi::object || compiled.types[row].count != 10 ||
+        compiled.name(compiled.fields[compiled.types[row].first]) != R"("id":)")
+        throw std::runtime_error("compiled_abi flattened row incorrectly");
+
+    // Both walkers give up at the same depth
+    auto tree = abi.get_type("tree");
+    bool converted = false, limited = false;
+    for (int depth = 60; depth < 70; ++depth) {
+        std::vector<char> bin;
+        for (int i = 0; i < depth; ++i)
+            bin.insert(bin.end(), {char(i), char(i + 1 < depth)});
+        auto result = convert(tree, bin, bin.size());
+        converted |= result.rfind("error: ", 0) != 0;
+        limited |= result == "error: Recursion limit reached";
+    }
+    if (!converted || !limited)
+        throw std::runtime_error("compiled_abi recursion limit not reached");
+}
+
+void check_lazy_abi() {
+    auto eager = check(abieos_create());
+    auto lazy = check(abieos_create());
+    check_context(lazy, abieos_set_lazy_abis(lazy, true));
+    for (auto* context : {eager, lazy}) {
+        check_context(context, abieos_set_abi(context, 0, transactionAbi));
+        check_context(context, abieos_set_abi(context, 1, compiledAbi));
+    }
+
+    // Lazily loaded abis convert the same as eagerly loaded ones
+    auto compare = [&](uint64_t contract, const char* type, const char* json) {
+        check_context(eager, abieos_json_to_bin(eager, contract, type, json));
+        std::string expected = check_context(eager, abieos_get_bin_hex(eager));
+        check_context(lazy, abieos_json_to_bin(lazy, contract, type, json));
+        std::string bin = check_context(lazy, abieos_get_bin_hex(lazy));
+        if (bin != expected)
+            throw std::runtime_error(std::string("lazy abi json_to_bin of ") + type + ": " + bin + " != " + expected);
+        std::string round_trip = check_context(lazy, abieos_hex_to_json(lazy, contract, type, bin.c_str()));
+        if (round_trip != check_context(eager, abieos_hex_to_json(eager, contract, type, bin.c_str())))
+            throw std::runtime_error(std::string("lazy abi bin_to_json of ") + type + ": " + round_trip);
+    };
+    compare(1, "choice", R"(["tree",{"value":1,"children":[{"value":2,"children":[]}]}])");
+    compare(1, "row", R"({"id":"1","owner":"alice","memo":"m","limit":3,"tags":["bob"],"inner":{"id":"2","owner":"dave"},)"
+                      R"("choice":["base",{"id":"3","owner":"erin"}],"data":"00FF","extra":-5})");
+    compare(1, "outer", R"({"inner":{"a":1,"b":2}})");
+    compare(1, "extended_asset", R"({"quantity":"1.0000 SYS","contract":"eosio.token"})");
+    compare(0, "transaction",
+            R"({"expiration":"2009-02-13T23:31:31.000","ref_block_num":1234,"ref_block_prefix":5678,)"
+            R"("max_net_usage_words":0,"max_cpu_usage_ms":0,"delay_sec":0,"context_free_actions":[],"actions":[],)"
+            R"("transaction_extensions":[]})");
+
+    // Errors are reported when the broken type is first used, but definitions are still checked on load
+    const char* broken = R"({"version":"eosio::abi/1.1","structs":[)"
+                         R"({"name":"good","base":"","fields":[{"name":"a","type":"uint8"}]},)"
+                         R"({"name":"bad","base":"","fields":[{"name":"b","type":"missing"}]}]})";
+    check_error(eager, "Unknown type", [&] { return abieos_set_abi(eager, 2, broken); });
+    check_context(lazy, abieos_set_abi(lazy, 2, broken));
+    check_context(lazy, abieos_json_to_bin(lazy, 2, "good", R"({"a":7})"));
+    for (int i = 0; i < 2; ++i)
+        check_error(lazy, "Unknown type", [&] { return abieos_json_to_bin(lazy, 2, "bad", R"({"b":7})"); });
+    check_error(lazy, "Redefined type", [&] {
+        return abieos_set_abi(lazy, 3, R"({"version":"eosio::abi/1.1","structs":[{"name":"uint64","fields":[]}]})");
+    });
+    abieos_destroy(eager);
+    abieos_destroy(lazy);
+
+    // Threads which resolve and compile types at the same time get the same types, while converting with the ones
+    // already compiled
+    abieos::abi_def def{};
+    std::string abi_copy{compiledAbi};
+    eosio::json_token_stream stream(abi_copy.data());
+    from_json(def, stream);
+    eosio::abi abi;
+    convert_lazy(std::move(def), abi);
+    auto base = abi.get_type("base");
+    auto base_bin = base->json_to_bin(R"({"id":"1","owner":"alice"})");
+    auto base_index = abi.compiled.index_of(base);
+    const char* names[] = {"row", "choice", "tree[]", "outer", "account?", "base$"};
+    std::vector<std::vector<const abieos::abi_type*>> found(4);
+    std::vector<std::vector<uint32_t>> compiled(found.size());
+    std::atomic<bool> mismatch{false};
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < found.size(); ++i)
+        threads.emplace_back([&, i] {
+            abieos::conversion_scratch scratch;
+            std::string json;
+            for (auto* name : names) {
+                found[i].push_back(abi.get_type(name));
+                compiled[i].push_back(abi.compiled.index_of(found[i].back()));
+                eosio::input_stream bin{base_bin};
+                abieos::bin_to_json(bin, abi.compiled, base_index, json, scratch);
+                mismatch = mismatch || json != R"({"id":"1","owner":"alice"})";
+            }
+        });
+    for (auto& t : threads)
+        t.join();
+    for (size_t i = 0; i < found.size(); ++i)
+        if (found[i] != found[0] || compiled[i] != compiled[0])
+            throw std::runtime_error("lazy abi resolved or compiled a type twice");
+    if (mismatch)
+        throw std::runtime_error("compiled bin_to_json changed while other types were compiled");
+
+    // Definitions which were never used convert back to themselves
+    eosio::abi_def back;
+    convert(abi, back);
+    eosio::abi eager_abi;
+    convert(back, eager_abi);
+    auto bin = eager_abi.get_type("row")->json_to_bin(R"({"id":"1","owner":"a","memo":"","limit":null,"tags":[],)"
+                                                      R"("inner":null,"choice":["uint8",1],"data":""})");
+    if (bin != abi.get_type("row")->json_to_bin(R"({"id":"1","owner":"a","memo":"","limit":null,"tags":[],)"
+                                                R"("inner":null,"choice":["uint8",1],"data":""})"))
+        throw std::runtime_error("lazy abi didn't convert back to abi_def");
+}
+
+void check_abi_def_view() {
+    abieos::abi_def def{};
+    std::string abi_copy{compiledAbi};
+    eosio::json_token_stream json(abi_copy.data());
+    from_json(def, json);
+    def.actions.push_back({eosio::name{"act"}, "row", std::string(5000, 'r')});
+    def.tables.push_back({eosio::name{"rows"}, "i64", {"id"}, {"uint64"}, "row"});
+    def.ricardian_clauses.push_back({"clause", std::string(5000, 'c')});
+    def.error_messages.push_back({7, "error"});
+    def.abi_extensions.push_back({1, {'x', 'y'}});
+    def.action_results.value.push_back({eosio::name{"act"}, "base"});
+    auto bin = eosio::convert_to_bin(def);
+
+    // The view has the same definitions and skips what conversions don't use
+    eosio::abi_def_view view;
+    eosio::input_stream stream{bin};
+    from_bin(view, stream);
+    if (stream.remaining() || view.version != def.version || view.types.size() != def.types.size() ||
+        view.structs.size() != def.structs.size() || view.variants.size() != def.variants.value.size() ||
+        view.actions.size() != 1 || view.actions[0].type != "row" || view.tables.size() != 1 ||
+        view.tables[0].key_types != std::vector<std::string_view>{"uint64"} || view.action_results.size() != 1 ||
+        view.action_results[0].result_type != "base")
+        throw std::runtime_error("abi_def_view doesn't match abi_def");
+    for (size_t i = 0; i < def.structs.size(); ++i) {
+        auto& s = view.structs[i];
+        if (s.name != def.structs[i].name || s.fields.size() != def.structs[i].fields.size() ||
+            s.fields.back().type != def.structs[i].fields.back().type)
+            throw std::runtime_error("abi_def_view doesn't match abi_def struct " + def.structs[i].name);
+    }
+    if (view.structs[0].name.data() < bin.data() || view.structs[0].name.data() >= bin.data() + bin.size())
+        throw std::runtime_error("abi_def_view copied a name");
+
+    for (size_t size = 0; size < bin.size(); size += 97) {
+        eosio::abi_def_view truncated;
+        eosio::input_stream s{bin.data(), size};
+        check_except("stream overrun", [&] { from_bin(truncated, s); });
+    }
+
+    // Eager and lazy conversions of the binary agree with the json
+    auto check_abi = [&](bool lazy) {
+        auto context = check(abieos_create());
+        check_context(context, abieos_set_lazy_abis(context, lazy));
+        check_context(context, abieos_set_abi(context, 1, compiledAbi));
+        check_context(context, abieos_set_abi_bin(context, 2, bin.data(), bin.size()));
+        const char* json = R"({"id":"1","owner":"alice","memo":"m","limit":3,"tags":["bob"],"inner":null,)"
+                           R"("choice":["tree",{"value":1,"children":[]}],"data":"00FF","extra":1,)"
+                           R"("more":{"id":"2","owner":"b"}})";
+        check_context(context, abieos_json_to_bin(context, 1, "row", json));
+        std::string expected = check_context(context, abieos_get_bin_hex(context));
+        check_context(context, abieos_json_to_bin(context, 2, "row", json));
+        if (check_context(context, abieos_get_bin_hex(context)) != expected)
+            throw std::runtime_error("abi from abi_def_view converts differently");
+        std::string action_type =
+            check_context(context, abieos_get_type_for_action(context, 2, eosio::name{"act"}.value));
+        std::string table_type =
+            check_context(context, abieos_get_type_for_table(context, 2, eosio::name{"rows"}.value));
+        if (action_type != "row" || table_type != "row")
+            throw std::runtime_error("abi from abi_def_view lost an action or table");
+        abieos_destroy(context);
+    };
+    check_abi(false);
+    check_abi(true);
+}
+
+void check_columnar() {
+    auto abi = parse_abi(columnarAbi);
+
+    auto to_rows = [](const std::vector<std::vector<char>>& bins) {
+        std::vector<eosio::input_stream> rows;
+        for (auto& bin : bins)
+            rows.emplace_back(bin);
+        return rows;
+    };
+
+    auto fixed_type = abi.get_type("fixed_row");
+    std::vector<std::vector<char>> fixed_bins;
+    for (int i = 0; i < 20; ++i)
+        fixed_bins.push_back(fixed_type->json_to_bin(R"({"id":")" + std::to_string(i * 1000) +
+                                                     R"(","owner":"alice","balance":")" + std::to_string(i) +
+                                                     R"(.0000 SYS","score":)" + std::to_string(-i) + "}"));
+    abieos::column_decoder fixed_decoder{fixed_type};
+    abieos::column_batch batch;
+    fixed_decoder.decode(to_rows(fixed_bins), batch);
+    std::string names;
+    for (auto& c : batch.columns)
+        names += c.name + ":" + c.format + " ";
+    printf("columnar fixed_row %s\n", names.c_str());
+    if (names != "id:L owner:L balance.amount:l balance.symbol:L score:s ")
+        throw std::runtime_error("columnar fixed_row schema mismatch");
+    for (size_t r = 0; r < batch.num_rows; ++r) {
+        if (column_value<uint64_t>(batch.columns[0], r) != r * 1000 ||
+            column_value<uint64_t>(batch.columns[1], r) != abieos::name{"alice"}.value ||
+            column_value<int64_t>(batch.columns[2], r) != int64_t(r) * 10000 ||
+            column_value<uint64_t>(batch.columns[3], r) != eosio::symbol{"SYS", 4}.value ||
+            column_value<int16_t>(batch.columns[4], r) != -int16_t(r))
+            throw std::runtime_error("columnar fixed_row value mismatch");
+    }
+
+    auto row_type = abi.get_type("row");
+    std::vector<std::vector<char>> bins = {
+        row_type->json_to_bin(
+            R"({"id":1,"flag":true,"memo":"first","limit":7,"tags":["a","b"],"inner":null,"choice":["uint8",5],"count":300,"extra":-1})"),
+        row_type->json_to_bin(
+            R"({"id":2,"flag":false,"memo":"","limit":null,"tags":[],"inner":{"id":"9","owner":"bob","balance":"1.0000 EOS","score":3},"choice":["string","x"],"count":1})"),
+    };
+    abieos::column_decoder decoder{row_type};
+    decoder.decode(to_rows(bins), batch);
+    names.clear();
+    for (auto& c : batch.columns)
+        names += c.name + ":" + c.format + c.element_format + "/" + std::to_string(c.null_count) + " ";
+    printf("columnar row %s\n", names.c_str());
+    if (names != "id:I/0 flag:b/0 memo:u/0 limit:S/1 tags:+lL/0 inner.id:L/1 inner.owner:L/1 inner.balance.amount:l/1 "
+                 "inner.balance.symbol:L/1 inner.score:s/1 choice:z/0 count:I/0 extra:c/1 ")
+        throw std::runtime_error("columnar row schema mismatch");
+    auto& c = batch.columns;
+    if (column_value<uint32_t>(c[0], 1) != 2 || c[1].values[0] != 1 ||
+        std::string(c[2].values.begin(), c[2].values.end()) != "first" || c[2].offsets != std::vector<int32_t>{0, 5, 5} ||
+        !column_valid(c[3], 0) || column_valid(c[3], 1) || column_value<uint16_t>(c[3], 0) != 7 ||
+        c[4].offsets != std::vector<int32_t>{0, 2, 2} || column_valid(c[5], 0) || !column_valid(c[5], 1) ||
+        column_value<uint64_t>(c[5], 1) != 9 || c[10].offsets != std::vector<int32_t>{0, 2, 5} ||
+        column_value<uint32_t>(c[11], 0) != 300 || column_value<int8_t>(c[12], 0) != -1 || column_valid(c[12], 1))
+        throw std::runtime_error("columnar row value mismatch");
+
+    auto ext_type = abi.get_type("ext_row");
+    abieos::column_decoder{ext_type}.decode(
+        to_rows({ext_type->json_to_bin(R"({"a":1})"), ext_type->json_to_bin(R"({"a":2,"b":3,"c":4})")}), batch);
+    if (batch.columns[1].null_count != 1 || batch.columns[2].null_count != 1 ||
+        column_value<uint16_t>(batch.columns[1], 1) != 3 || column_value<uint8_t>(batch.columns[2], 1) != 4)
+        throw std::runtime_error("columnar ext_row value mismatch");
+
+    bins[1].resize(3);
+    bool failed = false;
+    try {
+        decoder.decode(to_rows(bins), batch);
+    } catch (std::exception& e) {
+        failed = true;
+    }
+    fixed_bins[3].pop_back();
+    try {
+        fixed_decoder.decode(to_rows(fixed_bins), batch);
+        failed = false;
+    } catch (std::exception& e) {
+    }
+    if (!failed)
+        throw std::runtime_error("columnar decode of truncated rows did not fail");
+}
+
+const char actionTraceJson[] =
+    R"(["action_trace_v1",{"action_ordinal":1,"creator_action_ordinal":0,"receipt":["action_receipt_v0",{"receiver":"eosio","act_digest":"F2FDEEFF77EFC899EED23EE05F9469357A096DC3083D493571CF68A422C69EFE","global_sequence":"11","recv_sequence":"11","auth_sequence":[{"account":"eosio","sequence":"11"}],"code_sequence":2,"abi_sequence":0}],"receiver":"eosio","act":{"account":"eosio.token","name":"transfer","authorization":[{"actor":"alice","permission":"active"}],"data":"0102"},"context_free":false,"elapsed":"83","console":"","account_ram_deltas":[{"account":"oracle.aml","delta":"2724"}],"except":null,"error_code":null,"return_value":""}])";
+
+void check_view() {
+    auto context = abieos_create();
+    check_context(context, abieos_set_abi(context, 2, state_history_plugin_abi));
+    check_context(context, abieos_json_to_bin(context, 2, "action_trace", actionTraceJson));
+    std::vector<char> bin(abieos_get_bin_data(context), abieos_get_bin_data(context) + abieos_get_bin_size(context));
+
+    auto handle = check_context(context, abieos_get_type(context, 2, "action_trace"));
+    if (abieos_get_field_u64(context, handle, "receiver", bin.data(), bin.size()) != eosio::name{"eosio"}.value ||
+        abieos_get_field_u64(context, handle, "act.name", bin.data(), bin.size()) != eosio::name{"transfer"}.value)
+        throw std::runtime_error("view field mismatch");
+
+    const char* paths[] = {"act.account", "receipt.global_sequence", "action_ordinal", "act.authorization.0.actor",
+                           "elapsed", "context_free"};
+    uint64_t values[6];
+    check_context(context, abieos_get_fields_u64(context, handle, paths, 6, bin.data(), bin.size(), values));
+    if (values[0] != eosio::name{"eosio.token"}.value || values[1] != 11 || values[2] != 1 ||
+        values[3] != eosio::name{"alice"}.value || values[4] != 83 || values[5] != 0)
+        throw std::runtime_error("view fields mismatch");
+
+    check_error(context, "field \"except\" is absent",
+                [&] { return abieos_get_field_u64(context, handle, "except", bin.data(), bin.size()); });
+    check_error(context, "field is bytes, not an integer",
+                [&] { return abieos_get_field_u64(context, handle, "act.data", bin.data(), bin.size()); });
+    check_error(context, "unknown field \"nope\" in action",
+                [&] { return abieos_get_field_u64(context, handle, "act.nope", bin.data(), bin.size()); });
+    check_error(context, "Stream overrun",
+                [&] { return abieos_get_field_u64(context, handle, "return_value", bin.data(), 40); });
+    abieos_destroy(context);
+
+    auto abi = parse_abi(state_history_plugin_abi);
+    abieos::bin_view view{abi.get_type("action_trace"), bin};
+    if (view.get<eosio::name>("act.authorization.0.permission") != eosio::name{"active"} ||
+        view.get_json("act.authorization") != R"([{"actor":"alice","permission":"active"}])" ||
+        view.get_json("receipt.auth_sequence.0.sequence") != R"("11")" || view.get_u64("error_code") ||
+        view.get_json("act.authorization.1") || view.get<std::string>("console") != "")
+        throw std::runtime_error("bin_view mismatch");
+}
+
+// A get_blocks_result_v1 whose parts record block_num, so the decoded output shows which message it came from
+std::vector<char> ship_blocks_message(uint32_t block_num, std::vector<std::vector<char>>& storage) {
+    using namespace eosio::ship_protocol;
+    auto part = [&](const auto& value) {
+        storage.push_back(eosio::convert_to_bin(value));
+        return eosio::input_stream{storage.back()};
+    };
+    signed_block block;
+    block.confirmed = block_num;
+    transaction_trace_v0 trace;
+    trace.cpu_usage_us = block_num;
+    table_delta_v0 delta{"contract_row", {{true, part(block_num)}}};
+    finality_data finality;
+    finality.latest_qc_claim_block_num = block_num;
+
+    get_blocks_result_v1 result;
+    result.this_block = block_position{block_num};
+    result.block = part(block);
+    result.traces = part(std::vector<transaction_trace>{trace});
+    result.deltas = part(std::vector<table_delta>{delta});
+    if (block_num % 2)
+        result.finality_data = part(finality);
+    return eosio::convert_to_bin(eosio::ship_protocol::result{result});
+}
+
+void check_ship_pipeline() {
+    using namespace eosio::ship_protocol;
+    std::vector<std::vector<char>> storage;
+    std::vector<std::vector<char>> messages;
+    for (uint32_t i = 0; i < 200; ++i) {
+        if (i % 50 == 7)
+            messages.push_back(eosio::convert_to_bin(result{get_status_result_v0{}}));
+        else
+            messages.push_back(ship_blocks_message(i, storage));
+    }
+    auto truncated = ship_blocks_message(1000, storage);
+    truncated.resize(truncated.size() - 20);
+
+    // a small max_in_flight keeps push() waiting on the consumer below
+    block_decoder decoder{4, 3};
+    std::thread reader{[&] {
+        for (auto& m : messages)
+            decoder.push(m);
+        decoder.push(truncated);
+        decoder.close();
+    }};
+    for (uint32_t i = 0; i < messages.size(); ++i) {
+        auto r = decoder.pop();
+        if (!r)
+            throw std::runtime_error("block_decoder ended early");
+        if (i % 50 == 7) {
+            if (!std::holds_alternative<get_status_result_v0>(r->result) || r->block)
+                throw std::runtime_error("block_decoder status mismatch");
+            continue;
+        }
+        auto& blocks = std::get<get_blocks_result_v1>(r->result);
+        uint32_t block_num;
+        auto row = std::get<table_delta_v0>(r->deltas.at(0)).rows.at(0).data;
+        eosio::from_bin(block_num, row);
+        if (blocks.this_block->block_num != i || r->block->confirmed != uint16_t(i) ||
+            std::get<transaction_trace_v0>(r->traces.at(0)).cpu_usage_us != i || block_num != i ||
+            r->finality.has_value() != bool(i % 2) || (r->finality && r->finality->latest_qc_claim_block_num != i))
+            throw std::runtime_error("block_decoder result mismatch");
+    }
+    check_except("Stream overrun", [&] { decoder.pop(); });
+    if (decoder.pop())
+        throw std::runtime_error("block_decoder did not end");
+    reader.join();
+
+    // close() wakes a push() waiting for space instead of letting it add to a closed decoder
+    {
+        block_decoder full{1, 1};
+        full.push(messages[0]);
+        std::atomic<bool> rejected{false};
+        std::thread producer{[&] {
+            try {
+                full.push(messages[1]);
+            } catch (std::exception&) {
+                rejected = true;
+            }
+        }};
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        full.close();
+        producer.join();
+        if (!rejected)
+            throw std::runtime_error("block_decoder accepted a push after close");
+    }
+
+    // destroying a decoder with messages still queued or being decoded doesn't wait for a consumer
+    {
+        block_decoder abandoned{1, 8};
+        for (uint32_t i = 0; i < 8; ++i)
+            abandoned.push(messages[i]);
+    }
+}
+
+void check_delta_filter() {
+    using namespace eosio::ship_protocol;
+    std::vector<std::vector<char>> storage;
+    auto row = [&](const auto& value) {
+        storage.push_back(eosio::convert_to_bin(value));
+        return row_v0{true, eosio::input_stream{storage.back()}};
+    };
+    auto contract_row = [&](const char* code, const char* table, uint64_t primary_key) {
+        return row(eosio::ship_protocol::contract_row{
+            contract_row_v0{eosio::name{code}, eosio::name{"alice"}, eosio::name{table}, primary_key}});
+    };
+    std::vector<table_delta> deltas{
+        table_delta_v0{"account", {row(uint32_t(1)), row(uint32_t(2))}},
+        table_delta_v0{"permission", {row(uint32_t(3))}},
+        table_delta_v0{"contract_row",
+                       {contract_row("eosio.token", "accounts", 1), contract_row("eosio.token", "stat", 2),
+                        contract_row("other", "accounts", 3), contract_row("dice", "games", 4)}},
+        table_delta_v0{"contract_table", {contract_row("other", "accounts", 0)}},
+    };
+    auto bin = eosio::convert_to_bin(deltas);
+
+    delta_filter filter{{"account"}, {{eosio::name{"eosio.token"}, eosio::name{"accounts"}}, {eosio::name{"dice"}, {}}}};
+    std::vector<table_delta> result;
+    filter_deltas(bin, filter, result);
+    if (result.size() != 2 || std::get<table_delta_v0>(result[0]).name != "account" ||
+        std::get<table_delta_v0>(result[0]).rows.size() != 2 || std::get<table_delta_v0>(result[1]).name != "contract_row")
+        throw std::runtime_error("filter_deltas mismatch");
+
+    std::vector<uint64_t> keys;
+    for_each_contract_row(bin, filter, [&](const row_v0&, const contract_row_v0& r) { keys.push_back(r.primary_key); });
+    if (keys != std::vector<uint64_t>{1, 4})
+        throw std::runtime_error("for_each_contract_row mismatch");
+
+    filter_deltas(bin, delta_filter{{}, {{eosio::name{"other"}, eosio::name{"accounts"}}}}, result);
+    if (result.size() != 2 || std::get<table_delta_v0>(result[1]).name != "contract_table")
+        throw std::runtime_error("filter_deltas contract_table mismatch");
+    filter_deltas(bin, delta_filter{}, result);
+    if (!result.empty())
+        throw std::runtime_error("empty delta_filter mismatch");
+}
+
+void check_trace_filter() {
+    using namespace eosio::ship_protocol;
+    using eosio::name;
+    std::vector<char> data(40, 'd');
+    auto fill = [&](auto& a, uint32_t ordinal, const char* receiver, const char* account, const char* action_name) {
+        a.action_ordinal = ordinal;
+        a.creator_action_ordinal = ordinal / 2;
+        if (ordinal % 2)
+            a.receipt = action_receipt_v0{name{receiver}, {}, ordinal, ordinal, {{name{account}, 7}}, 1, 2};
+        a.receiver = name{receiver};
+        a.act = {name{account}, name{action_name}, {{name{"alice"}, name{"active"}}}, {data.data(), data.size()}};
+        a.console = "console output";
+        a.account_ram_deltas = {{name{"alice"}, -5}};
+        if (ordinal == 3)
+            a.except = "assertion failure";
+        if (ordinal == 4)
+            a.error_code = 9;
+    };
+    auto action = [&](uint32_t ordinal, const char* receiver, const char* account, const char* action_name,
+                      bool v1) -> action_trace {
+        if (!v1) {
+            action_trace_v0 a;
+            fill(a, ordinal, receiver, account, action_name);
+            return a;
+        }
+        action_trace_v1 a;
+        fill(a, ordinal, receiver, account, action_name);
+        a.return_value = {data.data(), 4};
+        return a;
+    };
+    transaction_trace_v0 failed;
+    failed.action_traces = {action(1, "eosio.token", "eosio.token", "transfer", false)};
+
+    std::vector<transaction_trace> traces;
+    for (uint32_t t = 0; t < 4; ++t) {
+        transaction_trace_v0 trace;
+        trace.id = eosio::checksum256{std::array<uint8_t, 32>{uint8_t(t)}};
+        trace.net_usage_words = 300;
+        trace.action_traces = {action(1, "eosio.token", "eosio.token", "transfer", t % 2),
+                               action(2, "alice", "eosio.token", "transfer", false),
+                               action(3, "dice", "dice", "roll", true), action(4, "eosio", "eosio", "onblock", false)};
+        if (t == 1) {
+            trace.account_ram_delta = account_delta{name{"alice"}, 3};
+            trace.except = "failed";
+            trace.error_code = 4;
+            trace.failed_dtrx_trace = {recurse_transaction_trace{failed}};
+        }
+        if (t == 2) {
+            partial_transaction_v0 partial;
+            partial.delay_sec = 200;
+            partial.transaction_extensions = {{1, {data.data(), 3}}};
+            partial.signatures = {eosio::signature{std::in_place_index<0>, eosio::ecc_signature{}}};
+            partial.context_free_data = {{data.data(), 5}};
+            trace.partial = partial;
+        }
+        traces.push_back(trace);
+    }
+    auto bin = eosio::convert_to_bin(traces);
+
+    action_filter filter{{{name{}, name{"eosio.token"}, name{"transfer"}}, {name{"dice"}, name{}, name{}}}};
+    std::vector<action_match> matches;
+    scan_action_traces(bin, filter, [&](const action_match& m) { matches.push_back(m); });
+    if (matches.size() != 12)
+        throw std::runtime_error("scan_action_traces count mismatch");
+    for (size_t i = 0; i < matches.size(); ++i) {
+        auto& m = matches[i];
+        auto& expected = std::get<transaction_trace_v0>(traces[i / 3]).action_traces[i % 3];
+        auto decoded = eosio::convert_from_bin<action_trace>(std::vector<char>{m.trace.pos, m.trace.end});
+        if (m.transaction_id != std::get<transaction_trace_v0>(traces[i / 3]).id || m.action_ordinal != i % 3 + 1 ||
+            m.creator_action_ordinal != (i % 3 + 1) / 2 || decoded.index() != expected.index() ||
+            eosio::convert_to_bin(decoded) != eosio::convert_to_bin(expected) ||
+            m.receiver != std::visit([](auto& a) { return a.receiver; }, expected))
+            throw std::runtime_error("scan_action_traces mismatch");
+    }
+    check_except("Stream overrun", [&] {
+        scan_action_traces(eosio::input_stream{bin.data(), bin.size() - 1}, filter, [](auto&) {});
+    });
+}
+
+void check_ship_abi_registry() {
+    using namespace eosio::ship_protocol;
+    using eosio::name;
+    std::vector<char> token_abi;
+    std::string error;
+    if (!abieos::unhex(error, tokenHexAbi, tokenHexAbi + strlen(tokenHexAbi), std::back_inserter(token_abi)))
+        throw std::runtime_error(error);
+    std::vector<std::vector<char>> storage;
+    auto bin = [&](const auto&... values) {
+        storage.emplace_back();
+        eosio::vector_stream stream{storage.back()};
+        (to_bin(values, stream), ...);
+        return eosio::input_stream{storage.back()};
+    };
+    auto action = [&](const char* receiver, const char* account, const char* action_name, eosio::input_stream data) {
+        action_trace_v0 a;
+        a.receiver = name{receiver};
+        a.act = {name{account}, name{action_name}, {}, data};
+        return action_trace{a};
+    };
+    auto transfer = bin(name{"alice"}, name{"bob"}, eosio::asset{10000, eosio::symbol{"SYS", 4}}, std::string{"hi"});
+    auto account_delta = [&](bool present, eosio::input_stream abi) {
+        return table_delta{table_delta_v0{"account", {{present, bin(account{account_v0{name{"eosio.token"}, {}, abi}})}}}};
+    };
+    auto row_delta = [&](const char* table) {
+        return table_delta{table_delta_v0{
+            "contract_row",
+            {{true, bin(contract_row{contract_row_v0{name{"eosio.token"}, name{"alice"}, name{table}, 0,
+                                                     name{"alice"}, bin(eosio::asset{5, eosio::symbol{"SYS", 4}})}})}}}};
+    };
+    transaction_trace_v0 trace;
+    trace.action_traces = {action("eosio.token", "eosio.token", "transfer", transfer),
+                           action("eosio", "eosio", "setabi", bin(name{"eosio.token"}, eosio::input_stream{token_abi})),
+                           action("eosio.token", "eosio.token", "transfer", transfer),
+                           action("eosio.token", "eosio.token", "nope", transfer)};
+    std::vector<transaction_trace> traces{trace};
+
+    abieos::ship_abi_registry registry;
+    std::vector<std::string> actions, rows;
+    auto on_action = [&](const abieos::ship_abi_registry::decoded_action& a) {
+        actions.push_back(a.type ? a.type->name + " " + a.json : "?");
+    };
+    auto on_row = [&](const abieos::ship_abi_registry::decoded_row& r) {
+        rows.push_back(r.type ? r.type->name + " " + r.json : "?");
+    };
+    registry.process(5, traces, {account_delta(true, eosio::input_stream{token_abi}), row_delta("accounts"), row_delta("x")},
+                     on_action, on_row);
+    if (actions != std::vector<std::string>{"?", "?",
+                                            R"(transfer {"from":"alice","to":"bob","quantity":"1.0000 SYS","memo":"hi"})",
+                                            "?"} ||
+        rows != std::vector<std::string>{R"(account {"balance":"0.0005 SYS"})", "?"})
+        throw std::runtime_error("ship_abi_registry decode mismatch");
+
+    // the abi is removed in block 6, which is then forked out
+    actions.clear();
+    registry.process(6, {}, {account_delta(false, {}), row_delta("accounts")}, on_action, on_row);
+    if (rows.back() != "?" || registry.get(name{"eosio.token"}) != registry.get(name{"eosio.token"}, 6) ||
+        registry.get(name{"eosio.token"})->abi || !registry.get(name{"eosio.token"}, 5)->abi ||
+        registry.get(name{"eosio.token"}, 4))
+        throw std::runtime_error("ship_abi_registry version mismatch");
+    registry.process(6, {}, {row_delta("accounts")}, on_action, on_row);
+    if (rows.back() != R"(account {"balance":"0.0005 SYS"})")
+        throw std::runtime_error("ship_abi_registry fork mismatch");
+    registry.prune(6);
+    if (registry.get(name{"eosio.token"}, 4) || !registry.get(name{"eosio.token"}, 5))
+        throw std::runtime_error("ship_abi_registry prune mismatch");
+}
+
+eosio::checksum256 test_block_id(uint32_t block_num) {
+    return eosio::checksum256{std::array<uint8_t, 32>{uint8_t(block_num >> 24), uint8_t(block_num >> 16),
+                                                      uint8_t(block_num >> 8), uint8_t(block_num), 0xcd}};
+}
+
+// A new directory under the system's temporary directory, removed with its contents when this goes out of scope
+struct temp_dir {
+    std::filesystem::path path;
+
+    temp_dir() {
+        std::random_device random;
+        do {
+            path = std::filesystem::temp_directory_path() / ("abieos_test_" + std::to_string(random()));
+        } while (!std::filesystem::create_directory(path));
+    }
+    ~temp_dir() {
+        std::error_code ec;
+        std::filesystem::remove_all(path, ec);
+    }
+    temp_dir(const temp_dir&) = delete;
+    temp_dir& operator=(const temp_dir&) = delete;
+
+    std::string operator/(const std::string& name) const { return (path / name).string(); }
+};
+
+// Writes a blocks.log of the given version and its index the way nodeos does
+void write_block_log(const std::string& dir, uint32_t version, uint32_t first_block, uint32_t num_blocks) {
+    using namespace eosio::ship_protocol;
+    std::vector<char> log;
+    std::vector<uint64_t> index;
+    eosio::vector_stream stream{log};
+    to_bin(version, stream);
+    to_bin(first_block, stream);
+    to_bin(eosio::varuint32{1}, stream); // chain_id alternative of the chain context
+    to_bin(test_block_id(0), stream);
+    to_bin(~uint64_t(0), stream);
+    for (uint32_t block_num = first_block; block_num < first_block + num_blocks; ++block_num) {
+        signed_block block;
+        block.timestamp = eosio::block_timestamp{block_num};
+        block.producer = eosio::name{"producer" + std::string(1, 'a' + block_num % 26)};
+        block.previous = test_block_id(block_num - 1);
+        block.transactions.resize(block_num % 3);
+        for (auto& t : block.transactions)
+            t.trx = test_block_id(block_num);
+        block.transaction_mroot = compute_transaction_mroot(block);
+        auto bin = eosio::convert_to_bin(block);
+        uint64_t pos = log.size();
+        index.push_back(pos);
+        if (version >= 4) {
+            to_bin(uint32_t(5 + bin.size() + 8), stream); // through the trailing position
+            to_bin(uint8_t(0), stream);
+        }
+        stream.write(bin.data(), bin.size());
+        to_bin(pos, stream);
+    }
+    std::ofstream{dir + "/blocks.log", std::ios::binary}.write(log.data(), log.size());
+    std::ofstream{dir + "/blocks.index", std::ios::binary}.write((const char*)index.data(), index.size() * 8);
+}
+
+void check_block_log() {
+    using namespace eosio::ship_protocol;
+    for (uint32_t version : {3, 4}) {
+        temp_dir dir;
+        write_block_log(dir.path.string(), version, 20, 30);
+        {
+            block_log log{dir.path.string()};
+            auto b = log.get(31);
+            if (log.version() != version || log.begin_block() != 20 || log.end_block() != 50 || b.block_num != 31 ||
+                b.timestamp() != eosio::block_timestamp{31} || b.producer() != eosio::name{"producerf"} ||
+                b.previous() != test_block_id(30) || b.header().previous != test_block_id(30) ||
+                b.decode().transactions.size() != 1 || log.get(49).decode().transactions.size() != 1)
+                throw std::runtime_error("block_log mismatch");
+            log.for_each(20, 50, [](const block_view& b) {
+                if (b.transaction_mroot() != compute_transaction_mroot(b.decode()))
+                    throw std::runtime_error("block_log transaction_mroot mismatch");
+            });
+            check_except("block 19 is not in blocks.log", [&] { log.get(19); });
+
+            std::atomic<uint64_t> sum{0};
+            log.parallel_for_each(20, 50, 3, [&](const block_view& b) {
+                sum += b.timestamp().slot + b.decode().transactions.size();
+            });
+            if (sum != (20 + 49) * 30 / 2 + 30)
+                throw std::runtime_error("block_log parallel_for_each mismatch");
+        }
+    }
+}
+
+std::string sha256_hex(const std::string& s) {
+    auto json = eosio::convert_to_json(eosio::sha256::hash(s.data(), s.size()));
+    return json.substr(1, json.size() - 2);
+}
+
+void check_sha256() {
+    using namespace eosio::ship_protocol;
+    namespace detail = eosio::sha256_detail;
+    if (sha256_hex("") != "E3B0C44298FC1C149AFBF4C8996FB92427AE41E4649B934CA495991B7852B855" ||
+        sha256_hex("abc") != "BA7816BF8F01CFEA414140DE5DAE2223B00361A396177A9CB410FF61F20015AD" ||
+        sha256_hex("abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq") !=
+            "248D6A61D20638B8E5C026930C3E6039A33CE45964FF2167F6ECEDD419DB06C1")
+        throw std::runtime_error("sha256 mismatch");
+
+    // every implementation the cpu supports agrees with the portable one, whether fed at once or in pieces
+    std::vector<std::string> messages;
+    for (size_t size = 0; size < 300; ++size) {
+        messages.emplace_back(size, 0);
+        for (size_t i = 0; i < size; ++i)
+            messages.back()[i] = char(size * 31 + i * 7);
+    }
+    std::vector<eosio::input_stream> streams;
+    std::vector<eosio::checksum256> expected, hashes(messages.size());
+    for (auto& m : messages) {
+        streams.emplace_back(m.data(), m.size());
+        expected.push_back(eosio::sha256{detail::compress_portable}.update(m.data(), m.size()).finish());
+        eosio::sha256 pieces;
+        for (size_t i = 0; i < m.size(); i += 1 + i % 70)
+            pieces.update(m.data() + i, std::min(m.size() - i, 1 + i % 70));
+        if (pieces.finish() != expected.back())
+            throw std::runtime_error("sha256 incremental mismatch");
+    }
+    eosio::sha256_many(streams.data(), streams.size(), hashes.data());
+    if (hashes != expected)
+        throw std::runtime_error("sha256_many mismatch");
+#ifdef EOSIO_SHA256_X86
+    if (detail::cpu_has_sha()) {
+        for (size_t i = 0; i < messages.size(); ++i)
+            if (eosio::sha256{detail::compress_sha}.update(streams[i]).finish() != expected[i])
+                throw std::runtime_error("sha256 sha extensions mismatch");
+    }
+    if (detail::cpu_has_avx2()) {
+        std::fill(hashes.begin(), hashes.end(), eosio::checksum256{});
+        detail::sha256_many_x8(streams.data(), streams.size() - 5, hashes.data());
+        if (!std::equal(hashes.begin(), hashes.end() - 5, expected.begin()) || hashes.back() != eosio::checksum256{})
+            throw std::runtime_error("sha256 avx2 mismatch");
+    }
+#endif
+
+    // a block id is the hash of the header without its signature, starting with the block number
+    signed_block block;
+    block.producer = eosio::name{"producera"};
+    block.previous = test_block_id(41);
+    block.transactions.resize(3);
+    block.transactions[0].trx = test_block_id(42);
+    for (size_t i = 1; i < 3; ++i) {
+        packed_transaction trx;
+        trx.packed_trx = {messages[100 + i].data(), messages[100 + i].size()};
+        block.transactions[i].trx = trx;
+    }
+    auto header = eosio::convert_to_bin(static_cast<const block_header&>(block));
+    auto id = compute_block_id(block);
+    auto id_bytes = id.extract_as_byte_array();
+    auto hash_bytes = eosio::sha256::hash(header.data(), header.size()).extract_as_byte_array();
+    auto block_bin = eosio::convert_to_bin(block);
+    if (block_num_from_id(id) != 42 || !std::equal(id_bytes.begin() + 4, id_bytes.end(), hash_bytes.begin() + 4) ||
+        compute_signed_block_id(eosio::input_stream{block_bin}) != id)
+        throw std::runtime_error("block id mismatch");
+
+    std::vector<eosio::checksum256> ids;
+    compute_transaction_ids(block, ids);
+    if (ids.size() != 3 || ids[0] != test_block_id(42) || ids[1] != expected[101] || ids[2] != expected[102] ||
+        compute_transaction_id(std::get<packed_transaction>(block.transactions[2].trx)) != expected[102])
+        throw std::runtime_error("transaction id mismatch");
+    std::get<packed_transaction>(block.transactions[1].trx).compression = 1;
+    check_except("transaction ids of compressed packed transactions are not supported",
+                 [&] { compute_transaction_ids(block, ids); });
+}
+
+void check_lazy_vector() {
+    using namespace eosio::ship_protocol;
+    signed_block block;
+    block.producer = eosio::name{"producera"};
+    block.transactions.resize(5);
+    std::string trx_bytes = "packed transaction";
+    for (uint32_t i = 0; i < block.transactions.size(); ++i) {
+        block.transactions[i].cpu_usage_us = i;
+        if (i % 2) {
+            block.transactions[i].trx = test_block_id(i);
+        } else {
+            packed_transaction packed;
+            packed.signatures.resize(i);
+            packed.packed_trx = {trx_bytes.data(), trx_bytes.size() - i};
+            block.transactions[i].trx = packed;
+        }
+    }
+    block.block_extensions.push_back({1, {}});
+    auto bin = eosio::convert_to_bin(block);
+
+    signed_block_lazy lazy;
+    eosio::input_stream stream{bin};
+    from_bin(lazy, stream);
+    if (stream.remaining() || lazy.producer != block.producer || lazy.transactions.size() != 5 ||
+        lazy.block_extensions.size() != 1 || eosio::convert_to_bin(lazy) != bin ||
+        eosio::convert_to_json(lazy.transactions) != eosio::convert_to_json(block.transactions))
+        throw std::runtime_error("signed_block_lazy mismatch");
+    for (size_t i = 0; i < block.transactions.size(); ++i)
+        if (eosio::convert_to_bin(lazy.transactions[i]) != eosio::convert_to_bin(block.transactions[i]))
+            throw std::runtime_error("lazy_vector element mismatch");
+    auto all = lazy.transactions.materialize();
+    if (all.size() != 5 || all[4].cpu_usage_us != 4 || (lazy.transactions.end() - lazy.transactions.begin()) != 5)
+        throw std::runtime_error("lazy_vector materialize mismatch");
+    check_except("lazy_vector index out of range", [&] { lazy.transactions.at(5); });
+
+    // traces with nested failed deferred transactions and deltas
+    action_trace_v1 action;
+    action.act.name = eosio::name{"transfer"};
+    action.console = "console";
+    transaction_trace_v0 failed, trace;
+    failed.action_traces = {action};
+    failed.except = "failed";
+    trace.action_traces = {action, action_trace_v0{}, action};
+    trace.failed_dtrx_trace.push_back({transaction_trace{failed}});
+    trace.cpu_usage_us = 7;
+    auto traces_bin = eosio::convert_to_bin(std::vector<transaction_trace>{trace, failed});
+    eosio::lazy_vector<transaction_trace_lazy> traces;
+    stream = eosio::input_stream{traces_bin};
+    from_bin(traces, stream);
+    auto first = std::get<transaction_trace_v0_lazy>(traces[0]);
+    if (traces.size() != 2 || first.cpu_usage_us != 7 || first.action_traces.size() != 3 ||
+        std::get<action_trace_v1>(first.action_traces[2]).console != "console" ||
+        first.failed_dtrx_trace.size() != 1 || *std::get<transaction_trace_v0_lazy>(traces[1]).except != "failed")
+        throw std::runtime_error("transaction_trace_lazy mismatch");
+
+    std::vector<table_delta> deltas{table_delta_v0{"account", {{true, {}}, {false, {}}}}};
+    auto deltas_bin = eosio::convert_to_bin(deltas);
+    eosio::lazy_vector<table_delta_lazy> lazy_deltas;
+    stream = eosio::input_stream{deltas_bin};
+    from_bin(lazy_deltas, stream);
+    auto delta = std::get<table_delta_v0_lazy>(lazy_deltas.at(0));
+    if (delta.name != "account" || delta.rows.size() != 2 || !delta.rows[0].present || delta.rows[1].present)
+        throw std::runtime_error("table_delta_lazy mismatch");
+
+    stream = eosio::input_stream{traces_bin.data(), traces_bin.size() - 1};
+    check_except("stream overrun", [&] { from_bin(traces, stream); });
+}
+
+// The merkle root computed one pair at a time, as the protocol describes it
+eosio::checksum256 reference_merkle_root(std::vector<eosio::checksum256> nodes) {
+    if (nodes.empty())
+        return {};
+    while (nodes.size() > 1) {
+        if (nodes.size() % 2)
+            nodes.push_back(nodes.back());
+        for (size_t i = 0; i < nodes.size() / 2; ++i) {
+            auto pair = eosio::convert_to_bin(std::make_pair(nodes[2 * i], nodes[2 * i + 1]));
+            pair[0] &= 0x7f;
+            pair[32] |= 0x80;
+            nodes[i] = eosio::sha256::hash(pair.data(), pair.size());
+        }
+        nodes.resize(nodes.size() / 2);
+    }
+    return nodes.front();
+}
+
+void check_merkle() {
+    using namespace eosio::ship_protocol;
+    std::vector<eosio::checksum256> leaves;
+    for (uint32_t i = 0; i < 37; ++i)
+        leaves.push_back(eosio::sha256::hash(&i, sizeof(i)));
+    if (merkle_root({}) != eosio::checksum256{} || merkle_root({leaves[0]}) != leaves[0])
+        throw std::runtime_error("merkle_root mismatch");
+    for (size_t n = 2; n <= leaves.size(); ++n) {
+        std::vector<eosio::checksum256> prefix{leaves.begin(), leaves.begin() + n};
+        if (merkle_root(prefix) != reference_merkle_root(prefix))
+            throw std::runtime_error("merkle_root mismatch");
+    }
+
+    // transaction receipts commit to the id or to the packed transaction with its prunable parts hashed separately
+    signed_block block;
+    block.transactions.resize(2);
+    block.transactions[0].status = transaction_status::executed;
+    block.transactions[0].cpu_usage_us = 150;
+    block.transactions[0].net_usage_words = eosio::varuint32{300};
+    block.transactions[0].trx = test_block_id(7);
+    std::string trx_bytes = "transaction", cfd = "context free data";
+    packed_transaction packed;
+    packed.signatures.resize(1);
+    packed.packed_context_free_data = {cfd.data(), cfd.size()};
+    packed.packed_trx = {trx_bytes.data(), trx_bytes.size()};
+    block.transactions[1].status = transaction_status::soft_fail;
+    block.transactions[1].trx = packed;
+
+    auto id_receipt = eosio::convert_to_bin(block.transactions[0]);
+    auto prunable = eosio::convert_to_bin(std::make_tuple(packed.signatures, packed.packed_context_free_data));
+    auto packed_digest = eosio::convert_to_bin(std::make_tuple(
+        packed.compression, packed.packed_trx, eosio::sha256::hash(prunable.data(), prunable.size())));
+    auto packed_receipt = eosio::convert_to_bin(std::make_tuple(
+        static_cast<const transaction_receipt_header&>(block.transactions[1]),
+        eosio::sha256::hash(packed_digest.data(), packed_digest.size())));
+    // the receipt holding an id serializes as the header, the variant index and the id; the digest skips the index
+    id_receipt.erase(id_receipt.end() - 33);
+    auto expected = reference_merkle_root({eosio::sha256::hash(id_receipt.data(), id_receipt.size()),
+                                           eosio::sha256::hash(packed_receipt.data(), packed_receipt.size())});
+    if (compute_transaction_mroot(block) != expected)
+        throw std::runtime_error("transaction_mroot mismatch");
+
+    // action receipts are leaves in global sequence order; a failed deferred transaction's receipts are not
+    auto make_action = [](uint32_t ordinal, uint64_t global_sequence) {
+        action_trace_v1 a;
+        a.action_ordinal = eosio::varuint32{ordinal};
+        action_receipt_v0 receipt;
+        receipt.receiver = eosio::name{"eosio"};
+        receipt.global_sequence = global_sequence;
+        receipt.auth_sequence.push_back({eosio::name{"alice"}, global_sequence});
+        a.receipt = receipt;
+        return action_trace{a};
+    };
+    transaction_trace_v0 onblock, trx, failed;
+    onblock.action_traces = {make_action(1, 100)};
+    trx.action_traces = {make_action(1, 101), make_action(2, 103), make_action(3, 102), action_trace{action_trace_v0{}}};
+    failed.action_traces = {make_action(1, 104)};
+    trx.failed_dtrx_trace.push_back({transaction_trace{failed}});
+    std::vector<eosio::checksum256> action_leaves;
+    for (uint64_t seq = 100; seq < 104; ++seq) {
+        auto a = std::get<action_trace_v1>(make_action(1, seq));
+        action_leaves.push_back(action_receipt_digest(std::get<action_receipt_v0>(*a.receipt)));
+    }
+    if (compute_action_mroot({onblock, trx}) != reference_merkle_root(action_leaves))
+        throw std::runtime_error("action_mroot mismatch");
+}
+
+#ifdef ABIEOS_HAVE_ZLIB
+// Writes a state-history log and index the way nodeos does, with one transaction trace per block
+void write_ship_log(const std::string& name, uint32_t first_block, uint32_t num_blocks) {
+    using namespace eosio::ship_protocol;
+    std::ofstream log{name + ".log", std::ios::binary}, index{name + ".index", std::ios::binary};
+    uint64_t pos = 0;
+    for (uint32_t block_num = first_block; block_num < first_block + num_blocks; ++block_num) {
+        transaction_trace_v0 trace;
+        trace.cpu_usage_us = block_num;
+        auto traces = eosio::convert_to_bin(std::vector<transaction_trace>{trace});
+        std::vector<char> compressed(compressBound(traces.size()));
+        uLongf compressed_size = compressed.size();
+        if (compress((Bytef*)compressed.data(), &compressed_size, (const Bytef*)traces.data(), traces.size()) != Z_OK)
+            throw std::runtime_error("compress failed");
+        uint32_t size = compressed_size;
+
+        std::array<uint8_t, 32> id{uint8_t(block_num >> 24), uint8_t(block_num >> 16), uint8_t(block_num >> 8),
+                                   uint8_t(block_num), 0xab};
+        std::vector<char> entry;
+        eosio::vector_stream stream{entry};
+        to_bin(eosio::name{"ship"}.value | 1, stream);
+        to_bin(eosio::checksum256{id}, stream);
+        to_bin(uint64_t(sizeof(size) + size), stream);
+        to_bin(size, stream);
+        stream.write(compressed.data(), size);
+        to_bin(pos, stream);
+        log.write(entry.data(), entry.size());
+        index.write((const char*)&pos, sizeof(pos));
+        pos += entry.size();
+    }
+}
+
+void check_ship_log() {
+    using namespace eosio::ship_protocol;
+    temp_dir dir;
+    write_ship_log(dir / "trace_history", 100, 50);
+    {
+        state_history_log log{dir / "trace_history.log"};
+        eosio::zlib_inflater inflater;
+        auto cpu_usage = [&](const log_entry& entry) {
+            std::vector<transaction_trace> traces;
+            decode_log_entry(traces, entry, inflater);
+            return std::get<transaction_trace_v0>(traces.at(0)).cpu_usage_us;
+        };
+        if (log.begin_block() != 100 || log.end_block() != 150 || log.get(123).block_num != 123 ||
+            log.get(123).version != 1 || cpu_usage(log.get(123)) != 123 || cpu_usage(log.get(149)) != 149)
+            throw std::runtime_error("state_history_log mismatch");
+        check_except("block 150 is not in the state-history log", [&] { log.get(150); });
+
+        std::atomic<uint64_t> sum{0};
+        log.parallel_for_each(100, 150, 4, [&](const log_entry& entry) {
+            eosio::zlib_inflater inflater;
+            std::vector<transaction_trace> traces;
+            decode_log_entry(traces, entry, inflater);
+            sum += std::get<transaction_trace_v0>(traces.at(0)).cpu_usage_us + entry.block_num;
+        });
+        if (sum != 2 * (100 + 149) * 50 / 2)
+            throw std::runtime_error("state_history_log parallel_for_each mismatch");
+    }
+}
+
+std::vector<char> zlib_compress(const std::vector<char>& data) {
+    std::vector<char> compressed(compressBound(data.size()));
+    uLongf size = compressed.size();
+    if (compress((Bytef*)compressed.data(), &size, (const Bytef*)data.data(), data.size()) != Z_OK)
+        throw std::runtime_error("compress failed");
+    compressed.resize(size);
+    return compressed;
+}
+
+void check_unpack_transaction() {
+    using namespace eosio::ship_protocol;
+    transaction trx;
+    trx.ref_block_num = 1234;
+    trx.actions.resize(3);
+    std::string data(500, 'd');
+    for (auto& a : trx.actions) {
+        a.account = eosio::name{"eosio.token"};
+        a.name = eosio::name{"transfer"};
+        a.data = {data.data(), data.size()};
+    }
+    auto bin = eosio::convert_to_bin(trx);
+    auto compressed = zlib_compress(bin);
+    eosio::zlib_inflater inflater;
+
+    // uncompressed transactions decode in place
+    packed_transaction packed;
+    packed.packed_trx = {bin.data(), bin.size()};
+    transaction result;
+    unpack_transaction(packed, result, inflater);
+    if (result.ref_block_num != 1234 || result.actions.size() != 3 || result.actions[2].data.pos < bin.data() ||
+        result.actions[2].data.end > bin.data() + bin.size() ||
+        compute_transaction_id(packed, inflater) != compute_transaction_id(packed))
+        throw std::runtime_error("unpack_transaction mismatch");
+    auto id = compute_transaction_id(packed);
+
+    packed.compression = uint8_t(packed_transaction_compression::zlib);
+    packed.packed_trx = {compressed.data(), compressed.size()};
+    for (int i = 0; i < 2; ++i) {
+        unpack_transaction(packed, result, inflater);
+        if (result.ref_block_num != 1234 || result.actions.size() != 3 ||
+            result.actions[2].data.remaining() != data.size() ||
+            std::string(result.actions[2].data.pos, result.actions[2].data.end) != data ||
+            compute_transaction_id(packed, inflater) != id)
+            throw std::runtime_error("unpack_transaction zlib mismatch");
+    }
+
+    auto bomb = zlib_compress(std::vector<char>(max_unpacked_transaction_size + 1));
+    packed.packed_trx = {bomb.data(), bomb.size()};
+    check_except("decompressed zlib data is too large", [&] { unpack_transaction(packed, result, inflater); });
+    packed.packed_trx = {compressed.data(), compressed.size() - 4};
+    check_except("truncated zlib data", [&] { unpack_transaction(packed, result, inflater); });
+    packed.compression = 2;
+    check_except("unsupported packed transaction compression 2", [&] { unpack_transaction(packed, result, inflater); });
+}
+#endif
+
 int main() {
     try {
         check_types();
         printf("\ncheck_types ok\n\n");
+        check_columnar();
+        printf("check_columnar ok\n\n");
+        check_compiled_abi();
+        printf("check_compiled_abi ok\n\n");
+        check_lazy_abi();
+        printf("check_lazy_abi ok\n\n");
+        check_abi_def_view();
+        printf("check_abi_def_view ok\n\n");
+        check_view();
+        printf("check_view ok\n\n");
+        check_ship_pipeline();
+        printf("check_ship_pipeline ok\n\n");
+        check_delta_filter();
+        printf("check_delta_filter ok\n\n");
+        check_trace_filter();
+        printf("check_trace_filter ok\n\n");
+        check_ship_abi_registry();
+        printf("check_ship_abi_registry ok\n\n");
+        check_block_log();
+        printf("check_block_log ok\n\n");
+        check_sha256();
+        printf("check_sha256 ok\n\n");
+        check_merkle();
+        printf("check_merkle ok\n\n");
+        check_lazy_vector();
+        printf("check_lazy_vector ok\n\n");
+#ifdef ABIEOS_HAVE_ZLIB
+        check_ship_log();
+        printf("check_ship_log ok\n\n");
+        check_unpack_transaction();
+        printf("check_unpack_transaction ok\n\n");
+#endif
         return 0;
     } catch (std::exception& e) {
         printf("error: %s\n", e.what());
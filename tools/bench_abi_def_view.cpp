@@ -0,0 +1,74 @@
+//
+// Purpose: compare reading a binary abi into abi_def, which copies every string, against abi_def_view, which points
+//          into the binary and skips ricardian text, alone and followed by convert
+//
+// Usage: bench_abi_def_view [iterations]
+//
+
+#include "abieos.hpp"
+#include <chrono>
+#include <stdexcept>
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+// 200 structs with an action each. Every action has a ricardian contract of a few KB, as is common.
+eosio::abi_def large_abi() {
+    eosio::abi_def def{};
+    def.version = "eosio::abi/1.1";
+    for (int i = 0; i < 200; ++i) {
+        eosio::struct_def s{"struct_number_" + std::to_string(i), ""};
+        for (int f = 0; f < 8; ++f)
+            s.fields.push_back({"field_number_" + std::to_string(f), f == 7 && i ? s.name + "[]" : "asset"});
+        def.actions.push_back({eosio::name{uint64_t(i + 1)}, s.name, std::string(4000, 'r')});
+        def.structs.push_back(std::move(s));
+    }
+    for (int i = 0; i < 10; ++i)
+        def.ricardian_clauses.push_back({"clause" + std::to_string(i), std::string(2000, 'c')});
+    return def;
+}
+
+template <typename F>
+void run(const char* label, int iterations, F f) {
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i)
+        f();
+    std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+    printf("    %-26s %10.1f us/op\n", label, elapsed.count() / 1000 / iterations);
+}
+
+int main(int argc, char* argv[]) {
+    try {
+        int iterations = argc > 1 ? std::stoi(argv[1]) : 500;
+        auto bin = eosio::convert_to_bin(large_abi());
+        printf("abi of %zu bytes\n", bin.size());
+        run("from_bin(abi_def)", iterations, [&] {
+            eosio::abi_def def{};
+            eosio::input_stream stream{bin};
+            from_bin(def, stream);
+        });
+        run("from_bin(abi_def_view)", iterations, [&] {
+            eosio::abi_def_view def{};
+            eosio::input_stream stream{bin};
+            from_bin(def, stream);
+        });
+        run("abi_def + convert", iterations, [&] {
+            eosio::abi_def def{};
+            eosio::input_stream stream{bin};
+            from_bin(def, stream);
+            eosio::abi abi;
+            convert(def, abi);
+        });
+        run("abi_def_view + convert", iterations, [&] {
+            eosio::abi_def_view def{};
+            eosio::input_stream stream{bin};
+            from_bin(def, stream);
+            eosio::abi abi;
+            convert(def, abi);
+        });
+        return 0;
+    } catch (std::exception& e) {
+        fprintf(stderr, "error: %s\n", e.what());
+        return 1;
+    }
+}
@@ -0,0 +1,104 @@
+//
+// Purpose: measure blocks/sec of reading a blocks.log through eosio::ship_protocol::block_log, reading only header
+//          fields and decoding whole blocks, serially and in parallel
+//
+// Usage: bench_block_log [dir]
+//
+// Reads dir/blocks.log and dir/blocks.index. Without a directory, a log of 20000 blocks with 50 packed transactions
+// each is generated in the current directory and removed afterwards.
+//
+
+#include <eosio/block_log.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace eosio::ship_protocol;
+
+void generate(uint32_t num_blocks) {
+    std::vector<char> trx(200, 't');
+    signed_block block;
+    block.producer = eosio::name{"produceraaaa"};
+    block.transactions.resize(50);
+    for (auto& t : block.transactions) {
+        packed_transaction p;
+        p.signatures.resize(1);
+        p.packed_trx = {trx.data(), trx.size()};
+        t.trx = p;
+    }
+
+    std::ofstream log{"blocks.log", std::ios::binary}, index{"blocks.index", std::ios::binary};
+    std::vector<char> bin;
+    eosio::vector_stream stream{bin};
+    to_bin(uint32_t(3), stream);
+    to_bin(uint32_t(1), stream);
+    to_bin(eosio::varuint32{1}, stream);
+    to_bin(eosio::checksum256{}, stream);
+    to_bin(~uint64_t(0), stream);
+    uint64_t pos = bin.size();
+    log.write(bin.data(), bin.size());
+    for (uint32_t block_num = 1; block_num <= num_blocks; ++block_num) {
+        block.timestamp = eosio::block_timestamp{block_num};
+        bin.clear();
+        to_bin(block, stream);
+        to_bin(pos, stream);
+        log.write(bin.data(), bin.size());
+        index.write((const char*)&pos, sizeof(pos));
+        pos += bin.size();
+    }
+}
+
+template <typename F>
+void run(const char* label, const block_log& log, F f) {
+    auto start = std::chrono::steady_clock::now();
+    uint64_t check = f();
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    printf("    %-22s %12.0f blocks/sec (%llu)\n", label, (log.end_block() - log.begin_block()) / elapsed.count(),
+           (unsigned long long)check);
+}
+
+int main(int argc, char* argv[]) {
+    try {
+        std::string dir = argc > 1 ? argv[1] : ".";
+        if (argc <= 1)
+            generate(20000);
+        {
+            block_log log{dir};
+            printf("%u blocks\n", log.end_block() - log.begin_block());
+            uint32_t threads = std::max(std::thread::hardware_concurrency(), 1u);
+
+            run("headers", log, [&] {
+                uint64_t sum = 0;
+                log.for_each(log.begin_block(), log.end_block(), [&](const block_view& b) {
+                    sum += b.timestamp().slot + b.producer().value + b.previous().extract_as_byte_array()[0];
+                });
+                return sum;
+            });
+            run("decode", log, [&] {
+                uint64_t sum = 0;
+                log.for_each(log.begin_block(), log.end_block(),
+                             [&](const block_view& b) { sum += b.decode().transactions.size(); });
+                return sum;
+            });
+            run(("decode threads=" + std::to_string(threads)).c_str(), log, [&] {
+                std::atomic<uint64_t> sum{0};
+                log.parallel_for_each(log.begin_block(), log.end_block(), threads,
+                                      [&](const block_view& b) { sum += b.decode().transactions.size(); });
+                return sum.load();
+            });
+        }
+        if (argc <= 1) {
+            std::remove("blocks.log");
+            std::remove("blocks.index");
+        }
+        return 0;
+    } catch (std::exception& e) {
+        fprintf(stderr, "error: %s\n", e.what());
+        return 1;
+    }
+}
@@ -0,0 +1,100 @@
+//
+// Purpose: compare encode cost and output size of json, CBOR and MessagePack output from abi-driven decoding
+//
+
+#include "abieos.h"
+#include <chrono>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+static const char token_abi[] = R"({
+    "version": "eosio::abi/1.1",
+    "structs": [
+        {"name": "transfer", "base": "", "fields": [
+            {"name": "from", "type": "name"},
+            {"name": "to", "type": "name"},
+            {"name": "quantity", "type": "asset"},
+            {"name": "memo", "type": "string"}]},
+        {"name": "action", "base": "", "fields": [
+            {"name": "account", "type": "name"},
+            {"name": "name", "type": "name"},
+            {"name": "auth", "type": "name[]"},
+            {"name": "data", "type": "bytes"},
+            {"name": "digest", "type": "checksum256"},
+            {"name": "sequence", "type": "uint64"}]}
+    ]
+})";
+
+using unique_abieos = std::unique_ptr<abieos_context, decltype(&abieos_destroy)>;
+
+std::vector<char> to_bin(abieos_context* context, uint64_t contract, const char* type, const std::string& json) {
+    if (!abieos_json_to_bin(context, contract, type, json.c_str()))
+        throw std::runtime_error(abieos_get_error(context));
+    return {abieos_get_bin_data(context), abieos_get_bin_data(context) + abieos_get_bin_size(context)};
+}
+
+template <typename F>
+void run(const char* label, int iterations, F f) {
+    size_t size = f();
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i)
+        f();
+    std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+    printf("    %-8s %10.0f ns/op %8zu bytes\n", label, elapsed.count() / iterations, size);
+}
+
+void bench(abieos_context* context, uint64_t contract, const char* type, const std::string& json, int iterations) {
+    auto bin = to_bin(context, contract, type, json);
+    printf("%s (%zu bytes binary)\n", type, bin.size());
+    run("json", iterations, [&] {
+        auto s = abieos_bin_to_json(context, contract, type, bin.data(), bin.size());
+        if (!s)
+            throw std::runtime_error(abieos_get_error(context));
+        return strlen(s);
+    });
+    run("cbor", iterations, [&] {
+        if (!abieos_bin_to_cbor(context, contract, type, bin.data(), bin.size(), false))
+            throw std::runtime_error(abieos_get_error(context));
+        return (size_t)abieos_get_bin_size(context);
+    });
+    run("msgpack", iterations, [&] {
+        if (!abieos_bin_to_msgpack(context, contract, type, bin.data(), bin.size(), false))
+            throw std::runtime_error(abieos_get_error(context));
+        return (size_t)abieos_get_bin_size(context);
+    });
+}
+
+int main(int argc, char* argv[]) {
+    try {
+        int iterations = argc > 1 ? std::stoi(argv[1]) : 100000;
+        unique_abieos context(abieos_create(), &abieos_destroy);
+        if (!context)
+            throw std::runtime_error("unable to create context");
+        uint64_t contract = abieos_string_to_name(context.get(), "eosio.token");
+        if (!abieos_set_abi(context.get(), contract, token_abi))
+            throw std::runtime_error(abieos_get_error(context.get()));
+
+        std::string transfer =
+            R"({"from":"useraaaaaaaa","to":"useraaaaaaab","quantity":"1234.5678 SYS","memo":"benchmark memo"})";
+        std::string action =
+            R"({"account":"eosio.token","name":"transfer","auth":["useraaaaaaaa","useraaaaaaab"],)"
+            R"("data":"608C31C6187315D6708C31C6187315D60100000000000000045359530000000000",)"
+            R"("digest":"F2FDEEFF77EFC899EED23EE05F9469357A096DC3083D493571CF68A422C69EFE","sequence":"123456789"})";
+        std::string actions = "[";
+        for (int i = 0; i < 100; ++i)
+            actions += (i ? "," : "") + action;
+        actions += "]";
+
+        bench(context.get(), contract, "transfer", transfer, iterations);
+        bench(context.get(), contract, "action", action, iterations);
+        bench(context.get(), contract, "action[]", actions, iterations / 100);
+        return 0;
+    } catch (std::exception& e) {
+        fprintf(stderr, "error: %s\n", e.what());
+        return 1;
+    }
+}
@@ -0,0 +1,145 @@
+//
+// Purpose: compare bin_to_json walking abi_type, which is spread over the heap, against walking the contiguous
+//          compiled_abi, on a wide struct. Reports ns/op and, where perf events are available, cache misses per op.
+//
+// Usage: bench_compiled_abi [iterations]
+//
+
+#include "abieos.hpp"
+#include <chrono>
+#include <linux/perf_event.h>
+#include <stdexcept>
+#include <stdio.h>
+#include <string>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <vector>
+
+// Counts the cache misses of this thread, or nothing if the kernel doesn't allow it
+struct cache_miss_counter {
+    int fd = -1;
+
+    cache_miss_counter() {
+        perf_event_attr attr{};
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.size = sizeof(attr);
+        attr.config = PERF_COUNT_HW_CACHE_MISSES;
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        fd = syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+    }
+
+    ~cache_miss_counter() {
+        if (fd >= 0)
+            close(fd);
+    }
+
+    void start() {
+        if (fd < 0)
+            return;
+        ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+        ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+    }
+
+    // -1 if unavailable
+    long long stop() {
+        long long count = -1;
+        if (fd < 0)
+            return count;
+        ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+        if (read(fd, &count, sizeof(count)) != sizeof(count))
+            count = -1;
+        return count;
+    }
+};
+
+// 64 fields of the kinds contracts use, plus a row type which holds many of them
+std::string wide_abi() {
+    static const char* const types[] = {"uint64",  "name",   "string", "asset",      "uint32",
+                                        "bool",    "uint8?", "int64",  "checksum256", "name[]"};
+    std::string abi = R"({"version":"eosio::abi/1.1","structs":[{"name":"wide","base":"","fields":[)";
+    for (int i = 0; i < 64; ++i)
+        abi += std::string(i ? "," : "") + R"({"name":"field_)" + std::to_string(i) + R"(","type":")" +
+               types[i % 10] + R"("})";
+    abi += R"(]},{"name":"rows","base":"","fields":[{"name":"rows","type":"wide[]"}]}]})";
+    return abi;
+}
+
+std::string wide_json(int row) {
+    static const char* const values[] = {
+        R"("18446744073709551615")", R"("eosio.token")", R"("a memo of some length")", R"("1234.5678 SYS")",
+        "4000000000",                "true",             "7",                         R"("-5")",
+        R"("0000000000000000000000000000000000000000000000000000000000000000")",
+        R"(["alice","bob"])"};
+    std::string json = "{";
+    for (int i = 0; i < 64; ++i)
+        json += std::string(i ? "," : "") + R"("field_)" + std::to_string(i) + R"(":)" +
+                (i % 10 == 4 ? std::to_string(row) : values[i % 10]);
+    return json + "}";
+}
+
+template <typename F>
+void run(const char* label, int iterations, F f) {
+    cache_miss_counter misses;
+    misses.start();
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i)
+        f();
+    std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+    long long count = misses.stop();
+    if (count < 0)
+        printf("    %-10s %10.0f ns/op     n/a cache misses/op\n", label, elapsed.count() / iterations);
+    else
+        printf("    %-10s %10.0f ns/op %7.1f cache misses/op\n", label, elapsed.count() / iterations,
+               double(count) / iterations);
+}
+
+void bench(eosio::abi& abi, const char* type_name, const std::string& json, int iterations) {
+    auto type = abi.get_type(type_name);
+    auto bin = type->json_to_bin(json);
+    auto index = abi.compiled.index_of(type);
+    abieos::conversion_scratch scratch;
+    std::string result, compiled_result;
+    auto by_abi_type = [&] {
+        eosio::input_stream s{bin.data(), bin.size()};
+        abieos::bin_to_json(s, type, result, [] {}, scratch);
+    };
+    auto by_compiled = [&] {
+        eosio::input_stream s{bin.data(), bin.size()};
+        abieos::bin_to_json(s, abi.compiled, index, compiled_result, scratch);
+    };
+    by_abi_type();
+    by_compiled();
+    if (result != compiled_result)
+        throw std::runtime_error(std::string("compiled_abi produced different json for ") + type_name);
+
+    printf("%s (%zu bytes, %zu bytes of json)\n", type_name, bin.size(), result.size());
+    run("abi_type", iterations, by_abi_type);
+    run("compiled", iterations, by_compiled);
+}
+
+int main(int argc, char* argv[]) {
+    try {
+        int iterations = argc > 1 ? std::stoi(argv[1]) : 20000;
+        std::string abi_json = wide_abi();
+        abieos::abi_def def{};
+        eosio::json_token_stream stream(abi_json.data());
+        from_json(def, stream);
+        eosio::abi abi;
+        convert(def, abi);
+
+        bench(abi, "wide", wide_json(0), iterations);
+        std::string rows = R"({"rows":[)";
+        for (int i = 0; i < 32; ++i)
+            rows += (i ? "," : "") + wide_json(i);
+        bench(abi, "rows", rows + "]}", iterations / 32);
+        printf("compiled_abi: %zu types, %zu fields, %zu bytes of names\n", abi.compiled.types.size(),
+               abi.compiled.fields.size(), abi.compiled.names.size());
+        return 0;
+    } catch (std::exception& e) {
+        fprintf(stderr, "error: %s\n", e.what());
+        return 1;
+    }
+}
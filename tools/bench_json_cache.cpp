@@ -0,0 +1,85 @@
+//
+// Purpose: measure abieos_bin_to_json with and without the json cache (abieos_set_json_cache) on a stream of actions
+//          where bots repeat byte-identical payloads, and the cost of a hit and of a miss
+//
+// Usage: bench_json_cache [iterations]
+//
+
+#include "abieos.h"
+#include <chrono>
+#include <memory>
+#include <stdexcept>
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+static const char token_abi[] = R"({
+    "version": "eosio::abi/1.1",
+    "structs": [
+        {"name": "transfer", "base": "", "fields": [
+            {"name": "from", "type": "name"},
+            {"name": "to", "type": "name"},
+            {"name": "quantity", "type": "asset"},
+            {"name": "memo", "type": "string"}]}
+    ]
+})";
+
+using unique_abieos = std::unique_ptr<abieos_context, decltype(&abieos_destroy)>;
+
+template <typename F>
+void run(const char* label, int iterations, F f) {
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i)
+        f(i);
+    std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+    printf("    %-28s %8.0f ns/op\n", label, elapsed.count() / iterations);
+}
+
+int main(int argc, char* argv[]) {
+    try {
+        int iterations = argc > 1 ? std::stoi(argv[1]) : 200000;
+        unique_abieos context(abieos_create(), &abieos_destroy);
+        if (!context)
+            throw std::runtime_error("unable to create context");
+        auto c = context.get();
+        uint64_t contract = abieos_string_to_name(c, "eosio.token");
+        if (!abieos_set_abi(c, contract, token_abi))
+            throw std::runtime_error(abieos_get_error(c));
+
+        // 90% of the stream repeats one of 16 bot transfers; the rest are all different
+        std::vector<std::string> stream;
+        uint64_t x = 1;
+        for (int i = 0; i < iterations; ++i) {
+            x = x * 6364136223846793005 + 1442695040888963407;
+            bool bot = x % 10 != 0;
+            std::string json = R"({"from":"useraaaaaaaa","to":"useraaaaaaab","quantity":")" +
+                               std::to_string(bot ? x % 16 : x >> 20) + R"(.0000 SYS","memo":")" +
+                               (bot ? "mine" : "payment " + std::to_string(x >> 40)) + R"("})";
+            if (!abieos_json_to_bin(c, contract, "transfer", json.c_str()))
+                throw std::runtime_error(abieos_get_error(c));
+            stream.emplace_back(abieos_get_bin_data(c), abieos_get_bin_size(c));
+        }
+        auto convert = [&](const std::string& bin) {
+            if (!abieos_bin_to_json(c, contract, "transfer", bin.data(), bin.size()))
+                throw std::runtime_error(abieos_get_error(c));
+        };
+
+        printf("transfer stream, %d actions\n", iterations);
+        run("no cache", iterations, [&](int i) { convert(stream[i]); });
+        if (!abieos_set_json_cache(c, 64 << 20, 64 << 10))
+            throw std::runtime_error(abieos_get_error(c));
+        run("cache", iterations, [&](int i) { convert(stream[i]); });
+        uint64_t hits, misses, entries, bytes;
+        abieos_get_json_cache_stats(c, &hits, &misses, &entries, &bytes);
+        printf("    %llu hits, %llu misses, %llu entries, %llu bytes\n", (unsigned long long)hits,
+               (unsigned long long)misses, (unsigned long long)entries, (unsigned long long)bytes);
+
+        run("cache, always hits", iterations, [&](int) { convert(stream[0]); });
+        abieos_set_json_cache(c, 0, 0);
+        run("no cache, same action", iterations, [&](int) { convert(stream[0]); });
+        return 0;
+    } catch (std::exception& e) {
+        fprintf(stderr, "error: %s\n", e.what());
+        return 1;
+    }
+}
@@ -0,0 +1,96 @@
+//
+// Purpose: compare sorting decoded objects with std::sort against encoding their keys with convert_to_keys and
+//          sorting the keys with the radix sort of to_key_batch.hpp, for fixed-width and variable-width keys
+//
+// Usage: bench_key_sort [num_threads]
+//
+// The rows are snapshot-like: contract table rows keyed by (code, scope, table, primary key), and account names
+// keyed as strings.
+//
+
+#include <eosio/name.hpp>
+#include <eosio/operators.hpp>
+#include <eosio/to_key_batch.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+using eosio::name;
+
+struct row_key {
+    name code;
+    name scope;
+    name table;
+    uint64_t primary_key = 0;
+};
+EOSIO_REFLECT(row_key, code, scope, table, primary_key);
+EOSIO_COMPARE(row_key);
+
+template <typename F>
+void run(const char* label, size_t rows, F f) {
+    auto start = std::chrono::steady_clock::now();
+    auto check = f();
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    printf("    %-30s %12.0f rows/sec (%u)\n", label, rows / elapsed.count(), unsigned(check));
+}
+
+template <typename T>
+void compare(const char* title, const std::vector<T>& objects, uint32_t num_threads) {
+    printf("%s: %zu rows\n", title, objects.size());
+    run("std::sort objects", objects.size(), [&] {
+        auto sorted = objects;
+        std::sort(sorted.begin(), sorted.end());
+        return sorted.size();
+    });
+    run("std::sort indexes", objects.size(), [&] {
+        std::vector<uint32_t> order(objects.size());
+        for (uint32_t i = 0; i < order.size(); ++i)
+            order[i] = i;
+        std::sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) { return objects[a] < objects[b]; });
+        return order[0];
+    });
+    run("convert_to_key each", objects.size(), [&] {
+        size_t n = 0;
+        for (auto& obj : objects)
+            n += eosio::convert_to_key(obj).size();
+        return n;
+    });
+    eosio::key_batch batch;
+    run("convert_to_keys", objects.size(), [&] {
+        eosio::convert_to_keys(objects, batch);
+        return batch.data.size();
+    });
+    run("convert_to_keys + sort_keys", objects.size(), [&] {
+        eosio::convert_to_keys(objects, batch);
+        return eosio::sort_keys(batch)[0];
+    });
+    char label[64];
+    snprintf(label, sizeof(label), "convert_to_keys + sort_keys x%u", num_threads);
+    run(label, objects.size(), [&] {
+        eosio::convert_to_keys(objects, batch);
+        return eosio::sort_keys(batch, num_threads)[0];
+    });
+}
+
+int main(int argc, char** argv) {
+    uint32_t num_threads = argc > 1 ? atoi(argv[1]) : std::max(1u, std::thread::hardware_concurrency());
+    const size_t num_rows = 4'000'000;
+
+    std::vector<row_key> rows;
+    std::vector<std::string> accounts;
+    uint64_t x = 1;
+    for (size_t i = 0; i < num_rows; ++i) {
+        x = x * 6364136223846793005 + 1442695040888963407;
+        rows.push_back({name{"eosio.token"}, name{x % 500'000}, name{"accounts"}, x >> 40});
+        accounts.push_back(name{x >> 4}.to_string());
+    }
+
+    compare("table rows, fixed-width keys", rows, num_threads);
+    compare("account names, string keys", accounts, num_threads);
+    return 0;
+}
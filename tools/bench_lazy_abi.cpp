@@ -0,0 +1,99 @@
+//
+// Purpose: compare loading many large binary abis eagerly against loading them lazily (abieos_set_lazy_abis), and what
+//          the first conversion of a few of their types costs afterwards
+//
+// Usage: bench_lazy_abi [contracts] [structs per abi]
+//
+
+#include "abieos.h"
+#include <chrono>
+#include <memory>
+#include <stdexcept>
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+using unique_abieos = std::unique_ptr<abieos_context, decltype(&abieos_destroy)>;
+
+// A DeFi-sized abi: structs which refer to earlier structs, variants of them, aliases and an action for each struct
+std::string large_abi(int structs) {
+    static const char* const builtins[] = {"uint64", "name", "string", "asset", "bool", "checksum256", "int32"};
+    std::string abi = R"({"version":"eosio::abi/1.1","types":[)";
+    for (int i = 0; i < structs / 10; ++i)
+        abi += std::string(i ? "," : "") + R"({"new_type_name":"alias)" + std::to_string(i) + R"(","type":"s)" +
+               std::to_string(i * 10) + R"("})";
+    abi += R"(],"structs":[)";
+    for (int i = 0; i < structs; ++i) {
+        abi += std::string(i ? "," : "") + R"({"name":"s)" + std::to_string(i) + R"(","base":"","fields":[)";
+        for (int f = 0; f < 8; ++f) {
+            std::string type = builtins[(i + f) % 7];
+            if (f == 7 && i)
+                type = "s" + std::to_string(i / 2) + "[]";
+            abi += std::string(f ? "," : "") + R"({"name":"field)" + std::to_string(f) + R"(","type":")" + type +
+                   R"("})";
+        }
+        abi += "]}";
+    }
+    abi += R"(],"actions":[)";
+    for (int i = 0; i < structs; ++i)
+        abi += std::string(i ? "," : "") + R"({"name":"act)" + std::to_string(i % 1000) + R"(","type":"s)" +
+               std::to_string(i) + R"(","ricardian_contract":""})";
+    abi += R"(],"variants":[)";
+    for (int i = 0; i < structs / 10; ++i)
+        abi += std::string(i ? "," : "") + R"({"name":"v)" + std::to_string(i) + R"(","types":["s)" +
+               std::to_string(i) + R"(","alias)" + std::to_string(i) + R"("]})";
+    return abi + "]}";
+}
+
+template <typename F>
+double run(const char* label, int iterations, F f) {
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i)
+        f(i);
+    std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+    printf("    %-22s %10.0f us total %10.1f us/abi\n", label, elapsed.count() / 1000,
+           elapsed.count() / 1000 / iterations);
+    return elapsed.count();
+}
+
+void bench(bool lazy, const std::vector<char>& abi, int contracts) {
+    unique_abieos context(abieos_create(), &abieos_destroy);
+    if (!context)
+        throw std::runtime_error("unable to create context");
+    auto c = context.get();
+    if (!abieos_set_lazy_abis(c, lazy))
+        throw std::runtime_error(abieos_get_error(c));
+    printf("%s\n", lazy ? "lazy" : "eager");
+    run("load", contracts, [&](int i) {
+        if (!abieos_set_abi_bin(c, i + 1, abi.data(), abi.size()))
+            throw std::runtime_error(abieos_get_error(c));
+    });
+    // Consumers usually touch a few types of each contract
+    run("first use of 3 types", contracts, [&](int i) {
+        for (auto* type : {"s0", "s7", "v3"})
+            if (!abieos_get_type(c, i + 1, type))
+                throw std::runtime_error(abieos_get_error(c));
+    });
+}
+
+int main(int argc, char* argv[]) {
+    try {
+        int contracts = argc > 1 ? std::stoi(argv[1]) : 200;
+        int structs = argc > 2 ? std::stoi(argv[2]) : 1000;
+        unique_abieos context(abieos_create(), &abieos_destroy);
+        if (!context)
+            throw std::runtime_error("unable to create context");
+        if (!abieos_abi_json_to_bin(context.get(), large_abi(structs).c_str()))
+            throw std::runtime_error(abieos_get_error(context.get()));
+        std::vector<char> abi(abieos_get_bin_data(context.get()),
+                              abieos_get_bin_data(context.get()) + abieos_get_bin_size(context.get()));
+
+        printf("%d contracts, %d structs and %zu bytes each\n", contracts, structs, abi.size());
+        bench(false, abi, contracts);
+        bench(true, abi, contracts);
+        return 0;
+    } catch (std::exception& e) {
+        fprintf(stderr, "error: %s\n", e.what());
+        return 1;
+    }
+}
@@ -0,0 +1,102 @@
+//
+// Purpose: compare the cost of rejecting malformed binary with abieos_bin_to_json, which throws internally, against
+//          abieos_validate_bin, which returns an error code, and what validating first adds to good input
+//
+// Usage: bench_malformed_input [iterations]
+//
+
+#include "abieos.h"
+#include <chrono>
+#include <memory>
+#include <stdexcept>
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+static const char token_abi[] = R"({
+    "version": "eosio::abi/1.1",
+    "structs": [
+        {"name": "transfer", "base": "", "fields": [
+            {"name": "from", "type": "name"},
+            {"name": "to", "type": "name"},
+            {"name": "quantity", "type": "asset"},
+            {"name": "memo", "type": "string"}]},
+        {"name": "action", "base": "", "fields": [
+            {"name": "account", "type": "name"},
+            {"name": "name", "type": "name"},
+            {"name": "auth", "type": "name[]"},
+            {"name": "data", "type": "bytes"},
+            {"name": "payload", "type": "payload"}]}
+    ],
+    "variants": [
+        {"name": "payload", "types": ["transfer", "uint64"]}
+    ]
+})";
+
+using unique_abieos = std::unique_ptr<abieos_context, decltype(&abieos_destroy)>;
+
+std::vector<char> to_bin(abieos_context* context, uint64_t contract, const char* type, const std::string& json) {
+    if (!abieos_json_to_bin(context, contract, type, json.c_str()))
+        throw std::runtime_error(abieos_get_error(context));
+    return {abieos_get_bin_data(context), abieos_get_bin_data(context) + abieos_get_bin_size(context)};
+}
+
+template <typename F>
+void run(const char* label, int iterations, F f) {
+    auto start = std::chrono::steady_clock::now();
+    int accepted = 0;
+    for (int i = 0; i < iterations; ++i)
+        accepted += f();
+    std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+    printf("    %-26s %10.0f ns/op %10.0f ops/sec (%d accepted)\n", label, elapsed.count() / iterations,
+           iterations / elapsed.count() * 1e9, accepted);
+}
+
+void bench(abieos_context* context, uint64_t contract, const char* title, const char* type,
+           const std::vector<char>& bin, int iterations) {
+    printf("%s (%zu bytes)\n", title, bin.size());
+    run("bin_to_json", iterations,
+        [&] { return abieos_bin_to_json(context, contract, type, bin.data(), bin.size()) != nullptr; });
+    run("validate_bin", iterations,
+        [&] { return bool(abieos_validate_bin(context, contract, type, bin.data(), bin.size())); });
+    run("validate_bin + bin_to_json", iterations, [&] {
+        return abieos_validate_bin(context, contract, type, bin.data(), bin.size()) &&
+               abieos_bin_to_json(context, contract, type, bin.data(), bin.size()) != nullptr;
+    });
+}
+
+int main(int argc, char* argv[]) {
+    try {
+        int iterations = argc > 1 ? std::stoi(argv[1]) : 200000;
+        unique_abieos context(abieos_create(), &abieos_destroy);
+        if (!context)
+            throw std::runtime_error("unable to create context");
+        uint64_t contract = abieos_string_to_name(context.get(), "eosio.token");
+        if (!abieos_set_abi(context.get(), contract, token_abi))
+            throw std::runtime_error(abieos_get_error(context.get()));
+
+        std::string transfer =
+            R"({"from":"useraaaaaaaa","to":"useraaaaaaab","quantity":"1234.5678 SYS","memo":"benchmark memo"})";
+        auto action = to_bin(context.get(), contract, "action",
+                             R"({"account":"eosio.token","name":"transfer","auth":["useraaaaaaaa","useraaaaaaab"],)"
+                             R"("data":"608C31C6187315D6708C31C6187315D60100000000000000045359530000000000",)"
+                             R"("payload":["transfer",)" + transfer + "]}");
+
+        auto truncated = action;
+        truncated.resize(action.size() - 5);
+        // The variant index comes just before the transfer
+        auto bad_variant = action;
+        bad_variant[action.size() - to_bin(context.get(), contract, "transfer", transfer).size() - 1] = 9;
+        auto bad_varuint = action;
+        bad_varuint[16] = char(0xff);
+
+        bench(context.get(), contract, "valid action", "action", action, iterations);
+        bench(context.get(), contract, "truncated action", "action", truncated, iterations);
+        bench(context.get(), contract, "bad variant index", "action", bad_variant, iterations);
+        bench(context.get(), contract, "bad auth length", "action", bad_varuint, iterations);
+        return 0;
+    } catch (std::exception& e) {
+        fprintf(stderr, "error: %s\n", e.what());
+        return 1;
+    }
+}
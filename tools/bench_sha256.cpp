@@ -0,0 +1,68 @@
+//
+// Purpose: compare the SHA-256 implementations on long messages and on batches of transaction-sized messages, the
+//          way compute_transaction_ids hashes the transactions of a block
+//
+// Usage: bench_sha256
+//
+
+#include <eosio/sha256.hpp>
+
+#include <chrono>
+#include <stdio.h>
+#include <vector>
+
+namespace detail = eosio::sha256_detail;
+
+template <typename F>
+void run(const char* label, double units, const char* unit, F f) {
+    auto start = std::chrono::steady_clock::now();
+    f();
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    printf("    %-22s %12.0f %s\n", label, units / elapsed.count(), unit);
+}
+
+int main() {
+    std::vector<char> data(64 << 20);
+    for (size_t i = 0; i < data.size(); ++i)
+        data[i] = char(i * 7);
+    std::vector<eosio::input_stream> trxs;
+    for (size_t i = 0; i < 20000; ++i)
+        trxs.emplace_back(data.data() + i * 256, 150 + i % 100);
+    std::vector<eosio::checksum256> ids(trxs.size());
+    const int reps = 20;
+
+    auto single = [&](const char* label, detail::compress_fn compress) {
+        run(label, data.size() / 1e6, "MB/sec",
+            [&] { eosio::sha256{compress}.update(data.data(), data.size()).finish(); });
+    };
+    auto batch = [&](const char* label, auto f) {
+        run(label, double(reps) * trxs.size(), "trx/sec", [&] {
+            for (int r = 0; r < reps; ++r)
+                f();
+        });
+    };
+
+    printf("%zu MB message\n", data.size() >> 20);
+    single("portable", detail::compress_portable);
+#ifdef EOSIO_SHA256_X86
+    if (detail::cpu_has_sha())
+        single("sha extensions", detail::compress_sha);
+#endif
+
+    printf("%zu transactions of 150-250 bytes\n", trxs.size());
+    batch("portable", [&] {
+        for (size_t i = 0; i < trxs.size(); ++i)
+            ids[i] = eosio::sha256{detail::compress_portable}.update(trxs[i]).finish();
+    });
+#ifdef EOSIO_SHA256_X86
+    if (detail::cpu_has_sha())
+        batch("sha extensions", [&] {
+            for (size_t i = 0; i < trxs.size(); ++i)
+                ids[i] = eosio::sha256{detail::compress_sha}.update(trxs[i]).finish();
+        });
+    if (detail::cpu_has_avx2())
+        batch("avx2 x8", [&] { detail::sha256_many_x8(trxs.data(), trxs.size(), ids.data()); });
+#endif
+    batch("sha256_many", [&] { eosio::sha256_many(trxs.data(), trxs.size(), ids.data()); });
+    return 0;
+}
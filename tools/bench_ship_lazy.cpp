@@ -0,0 +1,119 @@
+//
+// Purpose: compare decoding state-history traces and blocks eagerly into std::vectors against decoding them into the
+//          lazy_vector variants of ship_lazy.hpp, when all elements are read and when only one is
+//
+// Usage: bench_ship_lazy
+//
+// Synthetic blocks of 100 transactions are used: token transfers with their notifications and a few larger contract
+// actions.
+//
+
+#include <eosio/ship_lazy.hpp>
+
+#include <chrono>
+#include <stdio.h>
+#include <vector>
+
+using namespace eosio::ship_protocol;
+using eosio::name;
+
+struct sample {
+    std::vector<char> traces;
+    std::vector<char> block;
+};
+
+std::vector<sample> synthesize(uint32_t num_blocks) {
+    std::vector<char> transfer_data(40, 't');
+    std::vector<char> contract_data(300, 'c');
+    std::vector<char> trx(200, 'x');
+    auto act = [&](const char* receiver, const char* action_name, uint32_t ordinal, const std::vector<char>& data) {
+        action_trace_v1 a;
+        a.action_ordinal = ordinal;
+        a.receipt = action_receipt_v0{name{receiver}, {}, 1000 + ordinal, 10, {{name{"useraaaaaaaa"}, 20}}, 1, 1};
+        a.receiver = name{receiver};
+        a.act = {name{"eosio.token"}, name{action_name}, {{name{"useraaaaaaaa"}, name{"active"}}},
+                 {data.data(), data.size()}};
+        return action_trace{a};
+    };
+
+    std::vector<sample> samples;
+    for (uint32_t b = 0; b < num_blocks; ++b) {
+        std::vector<transaction_trace> traces;
+        signed_block block;
+        for (uint32_t t = 0; t < 100; ++t) {
+            transaction_trace_v0 trace;
+            if (t % 10 == 9)
+                trace.action_traces = {act("dice", "roll", 1, contract_data)};
+            else
+                trace.action_traces = {act("eosio.token", "transfer", 1, transfer_data),
+                                       act("useraaaaaaaa", "transfer", 2, transfer_data),
+                                       act("useraaaaaaab", "transfer", 3, transfer_data)};
+            traces.push_back(trace);
+
+            packed_transaction packed;
+            packed.signatures.resize(1);
+            packed.packed_trx = {trx.data(), trx.size()};
+            block.transactions.emplace_back();
+            block.transactions.back().trx = packed;
+        }
+        samples.push_back({eosio::convert_to_bin(traces), eosio::convert_to_bin(block)});
+    }
+    return samples;
+}
+
+template <typename F>
+void run(const char* label, const std::vector<sample>& samples, F f) {
+    size_t check = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (auto& s : samples)
+        check += f(s);
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    printf("    %-22s %10.0f blocks/sec (%zu)\n", label, samples.size() / elapsed.count(), check);
+}
+
+template <typename T>
+T decode(const std::vector<char>& bin) {
+    T result;
+    eosio::input_stream stream{bin};
+    from_bin(result, stream);
+    return result;
+}
+
+int main() {
+    auto samples = synthesize(2000);
+
+    printf("traces\n");
+    run("eager, all", samples, [](const sample& s) {
+        size_t n = 0;
+        for (auto& trace : decode<std::vector<transaction_trace>>(s.traces))
+            n += std::get<transaction_trace_v0>(trace).action_traces.size();
+        return n;
+    });
+    run("lazy, all", samples, [](const sample& s) {
+        size_t n = 0;
+        auto traces = decode<eosio::lazy_vector<transaction_trace_lazy>>(s.traces);
+        transaction_trace_lazy trace;
+        for (size_t i = 0; i < traces.size(); ++i) {
+            traces.get(i, trace);
+            n += std::get<transaction_trace_v0_lazy>(trace).action_traces.size();
+        }
+        return n;
+    });
+    run("eager, one", samples, [](const sample& s) {
+        return std::get<transaction_trace_v0>(decode<std::vector<transaction_trace>>(s.traces)[9])
+              .action_traces.size();
+    });
+    run("lazy, one", samples, [](const sample& s) {
+        return std::get<transaction_trace_v0_lazy>(decode<eosio::lazy_vector<transaction_trace_lazy>>(s.traces)[9])
+              .action_traces.size();
+    });
+
+    printf("blocks\n");
+    run("eager, one", samples, [](const sample& s) {
+        return size_t(decode<signed_block>(s.block).transactions[50].cpu_usage_us);
+    });
+    run("lazy, one", samples, [](const sample& s) {
+        return size_t(decode<signed_block_lazy>(s.block).transactions[50].cpu_usage_us);
+    });
+    return 0;
+}
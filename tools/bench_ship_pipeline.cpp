@@ -0,0 +1,131 @@
+//
+// Purpose: measure blocks/sec of decoding state-history get_blocks_result messages, serially and with
+//          eosio::ship_protocol::block_decoder, with and without a delta_filter
+//
+// Usage: bench_ship_pipeline [fixture]
+//
+// A fixture is a recording of `result` messages, each preceded by its size as a little-endian uint32. Without one,
+// synthetic blocks with 100 transactions, their traces and table deltas are used.
+//
+
+#include <eosio/ship_pipeline.hpp>
+
+#include <chrono>
+#include <fstream>
+#include <stdexcept>
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+using namespace eosio::ship_protocol;
+
+std::vector<std::vector<char>> read_fixture(const char* path) {
+    std::ifstream f{path, std::ios::binary};
+    if (!f)
+        throw std::runtime_error(std::string{"unable to open "} + path);
+    std::vector<std::vector<char>> messages;
+    uint32_t size;
+    while (f.read((char*)&size, sizeof(size))) {
+        messages.emplace_back(size);
+        if (!f.read(messages.back().data(), size))
+            throw std::runtime_error("fixture is truncated");
+    }
+    return messages;
+}
+
+std::vector<std::vector<char>> synthesize(uint32_t num_blocks) {
+    std::vector<char> action_data(64, 'x');
+    std::vector<char> row_data(120, 'y');
+
+    signed_block block;
+    transaction_trace_v0 trace;
+    trace.action_traces.resize(2, action_trace_v1{});
+    for (auto& a : trace.action_traces)
+        std::get<action_trace_v1>(a).act = {eosio::name{"eosio.token"}, eosio::name{"transfer"},
+                                            {{eosio::name{"alice"}, eosio::name{"active"}}},
+                                            {action_data.data(), action_data.size()}};
+    std::vector<transaction_trace> traces(100, trace);
+    block.transactions.resize(100);
+    table_delta_v0 delta{"contract_row", std::vector<row_v0>(200, {true, {row_data.data(), row_data.size()}})};
+    std::vector<table_delta> deltas{delta, delta};
+
+    auto block_bin = eosio::convert_to_bin(block);
+    auto traces_bin = eosio::convert_to_bin(traces);
+    auto deltas_bin = eosio::convert_to_bin(deltas);
+    std::vector<std::vector<char>> messages;
+    for (uint32_t i = 0; i < num_blocks; ++i) {
+        get_blocks_result_v0 r;
+        r.this_block = block_position{i};
+        r.block = eosio::input_stream{block_bin};
+        r.traces = eosio::input_stream{traces_bin};
+        r.deltas = eosio::input_stream{deltas_bin};
+        messages.push_back(eosio::convert_to_bin(result{r}));
+    }
+    return messages;
+}
+
+template <typename F>
+void run(const char* label, size_t num_blocks, F f) {
+    auto start = std::chrono::steady_clock::now();
+    f();
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    printf("    %-12s %10.0f blocks/sec\n", label, num_blocks / elapsed.count());
+}
+
+int main(int argc, char* argv[]) {
+    try {
+        auto messages = argc > 1 ? read_fixture(argv[1]) : synthesize(2000);
+        size_t bytes = 0;
+        for (auto& m : messages)
+            bytes += m.size();
+        printf("%zu messages, %zu bytes\n", messages.size(), bytes);
+
+        run("serial", messages.size(), [&] {
+            for (auto& m : messages) {
+                decoded_result d;
+                eosio::input_stream bin{m};
+                from_bin(d.result, bin);
+                if (auto* r = std::get_if<get_blocks_result_v0>(&d.result)) {
+                    if (auto b = r->block)
+                        from_bin(d.block.emplace(), *b);
+                    if (auto t = r->traces)
+                        from_bin(d.traces, *t);
+                    if (auto t = r->deltas)
+                        from_bin(d.deltas, *t);
+                }
+            }
+        });
+
+        for (uint32_t threads = 1; threads <= std::max(std::thread::hardware_concurrency(), 4u); threads *= 2) {
+            block_decoder decoder{threads};
+            std::thread reader{[&] {
+                for (auto& m : messages)
+                    decoder.push(m);
+                decoder.close();
+            }};
+            run(("threads=" + std::to_string(threads)).c_str(), messages.size(), [&] {
+                while (decoder.pop()) {
+                }
+            });
+            reader.join();
+        }
+
+        // keeps only eosio.token's accounts rows; the synthetic rows never match
+        block_decoder decoder{std::thread::hardware_concurrency(), 64,
+                              delta_filter{{}, {{eosio::name{"eosio.token"}, eosio::name{"accounts"}}}}};
+        std::thread reader{[&] {
+            for (auto& m : messages)
+                decoder.push(m);
+            decoder.close();
+        }};
+        run("filtered", messages.size(), [&] {
+            while (decoder.pop()) {
+            }
+        });
+        reader.join();
+        return 0;
+    } catch (std::exception& e) {
+        fprintf(stderr, "error: %s\n", e.what());
+        return 1;
+    }
+}
@@ -0,0 +1,126 @@
+//
+// Purpose: compare selecting actions from state-history traces with scan_action_traces against decoding every
+//          transaction_trace with from_bin
+//
+// Usage: bench_ship_trace_filter [fixture]
+//
+// A fixture is a recording of `result` messages, each preceded by its size as a little-endian uint32 (the same
+// format bench_ship_pipeline reads). Without one, synthetic blocks shaped like busy mainnet blocks are used: token
+// transfers with their notifications, a few larger contract actions with console output, and the onblock action.
+//
+
+#include <eosio/ship_trace_filter.hpp>
+
+#include <chrono>
+#include <fstream>
+#include <stdexcept>
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+using namespace eosio::ship_protocol;
+using eosio::name;
+
+std::vector<std::vector<char>> read_traces(const char* path) {
+    std::ifstream f{path, std::ios::binary};
+    if (!f)
+        throw std::runtime_error(std::string{"unable to open "} + path);
+    std::vector<std::vector<char>> traces;
+    uint32_t size;
+    std::vector<char> message;
+    while (f.read((char*)&size, sizeof(size))) {
+        message.resize(size);
+        if (!f.read(message.data(), size))
+            throw std::runtime_error("fixture is truncated");
+        eosio::input_stream bin{message};
+        result r;
+        from_bin(r, bin);
+        if (auto* blocks = std::get_if<get_blocks_result_v0>(&r); blocks && blocks->traces)
+            traces.emplace_back(blocks->traces->pos, blocks->traces->end);
+        else if (auto* blocks = std::get_if<get_blocks_result_v1>(&r); blocks && blocks->traces)
+            traces.emplace_back(blocks->traces->pos, blocks->traces->end);
+    }
+    return traces;
+}
+
+std::vector<std::vector<char>> synthesize(uint32_t num_blocks) {
+    std::vector<char> transfer_data(40, 't');
+    std::vector<char> contract_data(300, 'c');
+    auto act = [&](const char* receiver, const char* account, const char* action_name, uint32_t ordinal,
+                   const std::vector<char>& data, const char* console) {
+        action_trace_v1 a;
+        a.action_ordinal = ordinal;
+        a.creator_action_ordinal = ordinal > 1;
+        a.receipt = action_receipt_v0{name{receiver}, {}, 1000 + ordinal, 10, {{name{"useraaaaaaaa"}, 20}}, 1, 1};
+        a.receiver = name{receiver};
+        a.act = {name{account}, name{action_name}, {{name{"useraaaaaaaa"}, name{"active"}}}, {data.data(), data.size()}};
+        a.elapsed = 50;
+        a.console = console;
+        return action_trace{a};
+    };
+
+    std::vector<std::vector<char>> blocks;
+    for (uint32_t b = 0; b < num_blocks; ++b) {
+        std::vector<transaction_trace> traces;
+        transaction_trace_v0 onblock;
+        onblock.action_traces = {act("eosio", "eosio", "onblock", 1, contract_data, "")};
+        traces.push_back(onblock);
+        for (uint32_t t = 0; t < 100; ++t) {
+            transaction_trace_v0 trace;
+            trace.cpu_usage_us = 200;
+            trace.net_usage_words = 16;
+            if (t % 10 == 9) {
+                trace.action_traces = {act("dice", "dice", "roll", 1, contract_data, "rolled 4, 2 and 6")};
+            } else {
+                trace.action_traces = {act("eosio.token", "eosio.token", "transfer", 1, transfer_data, ""),
+                                       act("useraaaaaaaa", "eosio.token", "transfer", 2, transfer_data, ""),
+                                       act("useraaaaaaab", "eosio.token", "transfer", 3, transfer_data, "")};
+            }
+            traces.push_back(trace);
+        }
+        blocks.push_back(eosio::convert_to_bin(traces));
+    }
+    return blocks;
+}
+
+template <typename F>
+void run(const char* label, const std::vector<std::vector<char>>& blocks, size_t bytes, F f) {
+    size_t matches = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (auto& b : blocks)
+        matches += f(b);
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    printf("    %-10s %10.0f blocks/sec %8.1f MB/s %8zu actions\n", label, blocks.size() / elapsed.count(),
+           bytes / elapsed.count() / 1e6, matches);
+}
+
+int main(int argc, char* argv[]) {
+    try {
+        auto blocks = argc > 1 ? read_traces(argv[1]) : synthesize(2000);
+        size_t bytes = 0;
+        for (auto& b : blocks)
+            bytes += b.size();
+        printf("%zu blocks, %zu bytes of traces\n", blocks.size(), bytes);
+
+        action_filter filter{{{name{"dice"}, name{"dice"}, name{}}}};
+        run("from_bin", blocks, bytes, [&](const std::vector<char>& b) {
+            std::vector<transaction_trace> traces;
+            eosio::input_stream bin{b};
+            from_bin(traces, bin);
+            size_t matches = 0;
+            for (auto& trace : traces)
+                for (auto& a : std::get<transaction_trace_v0>(trace).action_traces)
+                    std::visit([&](auto& a) { matches += filter.match(a.receiver, a.act.account, a.act.name); }, a);
+            return matches;
+        });
+        run("scan", blocks, bytes, [&](const std::vector<char>& b) {
+            size_t matches = 0;
+            scan_action_traces(b, filter, [&](const action_match&) { ++matches; });
+            return matches;
+        });
+        return 0;
+    } catch (std::exception& e) {
+        fprintf(stderr, "error: %s\n", e.what());
+        return 1;
+    }
+}
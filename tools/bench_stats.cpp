@@ -0,0 +1,81 @@
+//
+// Purpose: measure what collecting per-context performance counters (abieos_set_stats_enabled) adds to conversions
+//
+// Usage: bench_stats [iterations]
+//
+
+#include "abieos.h"
+#include <chrono>
+#include <memory>
+#include <stdexcept>
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+static const char token_abi[] = R"({
+    "version": "eosio::abi/1.1",
+    "structs": [
+        {"name": "transfer", "base": "", "fields": [
+            {"name": "from", "type": "name"},
+            {"name": "to", "type": "name"},
+            {"name": "quantity", "type": "asset"},
+            {"name": "memo", "type": "string"}]}
+    ]
+})";
+
+using unique_abieos = std::unique_ptr<abieos_context, decltype(&abieos_destroy)>;
+
+template <typename F>
+double time_ns(int iterations, F f) {
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i)
+        f();
+    std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count() / iterations;
+}
+
+// Alternates between stats off and on and keeps the best round of each, which filters out most noise
+template <typename F>
+void run(abieos_context* context, const char* label, int iterations, F f) {
+    double off = 1e100, on = 1e100;
+    for (int round = 0; round < 21; ++round) {
+        abieos_set_stats_enabled(context, false);
+        off = std::min(off, time_ns(iterations, f));
+        if (!abieos_set_stats_enabled(context, true))
+            throw std::runtime_error(abieos_get_error(context));
+        on = std::min(on, time_ns(iterations, f));
+    }
+    printf("    %-12s %8.0f ns/op off %8.0f ns/op on %+6.1f%%\n", label, off, on, (on - off) / off * 100);
+}
+
+int main(int argc, char* argv[]) {
+    try {
+        int iterations = argc > 1 ? std::stoi(argv[1]) : 20000;
+        unique_abieos context(abieos_create(), &abieos_destroy);
+        if (!context)
+            throw std::runtime_error("unable to create context");
+        auto c = context.get();
+        uint64_t contract = abieos_string_to_name(c, "eosio.token");
+        if (!abieos_set_abi(c, contract, token_abi))
+            throw std::runtime_error(abieos_get_error(c));
+
+        const char* json =
+            R"({"from":"useraaaaaaaa","to":"useraaaaaaab","quantity":"1234.5678 SYS","memo":"benchmark memo"})";
+        if (!abieos_json_to_bin(c, contract, "transfer", json))
+            throw std::runtime_error(abieos_get_error(c));
+        std::vector<char> bin(abieos_get_bin_data(c), abieos_get_bin_data(c) + abieos_get_bin_size(c));
+
+        printf("transfer\n");
+        run(c, "json_to_bin", iterations, [&] { abieos_json_to_bin(c, contract, "transfer", json); });
+        run(c, "bin_to_json", iterations,
+            [&] { abieos_bin_to_json(c, contract, "transfer", bin.data(), bin.size()); });
+        run(c, "bin_to_cbor", iterations,
+            [&] { abieos_bin_to_cbor(c, contract, "transfer", bin.data(), bin.size(), false); });
+        run(c, "validate_bin", iterations,
+            [&] { abieos_validate_bin(c, contract, "transfer", bin.data(), bin.size()); });
+        return 0;
+    } catch (std::exception& e) {
+        fprintf(stderr, "error: %s\n", e.what());
+        return 1;
+    }
+}